@@ -0,0 +1,31 @@
+#ifndef BENCH_UTILS_H
+#define BENCH_UTILS_H
+
+#include <vector>
+
+#include <QSqlDatabase>
+#include <QString>
+#include <QStringList>
+#include <QVariant>
+
+
+namespace bench{
+
+    QSqlDatabase openDatabase(const QString &target,
+                              const QString &connection_name,
+                              QString &error);
+
+    bool isMySQL(const QString &target);
+
+    bool execStatement(QSqlDatabase &db,
+                       const QString &sql,
+                       const QVariantMap &binds,
+                       QString &error);
+
+    double percentile(std::vector<qint64> samples, double fraction);
+
+    const QStringList &substrateWords();
+
+}//namespace bench
+
+#endif // BENCH_UTILS_H
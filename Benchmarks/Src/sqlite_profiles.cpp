@@ -0,0 +1,250 @@
+/**
+ * Benchmark of SQLite performance profiles (see ConfigSQLite)
+ *
+ * Every profile gets its own copy of given database file, so writes of one
+ * run do not affect the others. On each copy query mix of application is
+ * repeated (login, Menu load, plant switching in BiogasCalculator, Services,
+ * phone number edits) and latency of whole mix is reported.
+ *
+ * Usage: sqlite_profiles_benchmark <path to database file> [iterations]
+ */
+#include "Benchmarks/Inc/bench_utils.h"
+#include "Database/Inc/db_sqlite.h"
+
+#include <algorithm>
+#include <vector>
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QTemporaryDir>
+#include <QTextStream>
+#include <QVariant>
+
+/* ************************
+ * Local Functions Prototypes - Begin
+ *************************/
+
+static QVariant findBusiestUser(QSqlDatabase &db);
+
+static std::vector<QVariant> findPlants(QSqlDatabase &db, const QVariant &user_id);
+
+static bool execMix(QSqlDatabase &db,
+                    const QVariant &user_id,
+                    const std::vector<QVariant> &plants,
+                    QString &error);
+
+/* ************************
+ * Local Functions Prototypes - End
+ *************************/
+
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QTextStream out(stdout);
+
+    if(argc < 2)
+    {
+        out << "Usage: sqlite_profiles_benchmark <path to database file> [iterations]\n";
+        return 1;
+    }
+
+    const QString source_path(QString::fromLocal8Bit(argv[1]));
+    const int iterations(argc > 2 ? std::max(1, QString(argv[2]).toInt()) : 200);
+
+    QTemporaryDir work_dir;
+
+    if(!QFileInfo::exists(source_path) || !work_dir.isValid())
+    {
+        out << "Database file not found or temporary directory unavailable\n";
+        return 1;
+    }
+
+    out << "profile   open[ms]  mean[ms]   p50[ms]   p99[ms]   mixes/s\n";
+
+    for(auto profile: {SQLiteProfile::Kiosk, SQLiteProfile::Ingest, SQLiteProfile::Durable})
+    {
+        const QString profile_name(sqlite_profile::name(profile));
+        const QString copy_path(work_dir.filePath(profile_name + ".sqlite3"));
+
+        if(!QFile::copy(source_path, copy_path))
+        {
+            out << profile_name << ": unable to copy database\n";
+            continue;
+        }
+
+        QString error("");
+        std::vector<qint64> samples;
+        qint64 open_ns(0);
+
+        {
+            QElapsedTimer timer;
+            timer.start();
+
+            auto db = QSqlDatabase::addDatabase("QSQLITE", "benchmark_" + profile_name);
+            db.setDatabaseName(copy_path);
+
+            bool is_ready(db.open() && sqlite_profile::apply(db, sqlite_profile::pragmas(profile), error));
+            open_ns = timer.nsecsElapsed();
+
+            if(is_ready)
+            {
+                QVariant user_id(findBusiestUser(db));
+                std::vector<QVariant> plants(findPlants(db, user_id));
+
+                is_ready = execMix(db, user_id, plants, error);   // warm up
+
+                for(int i = 0; is_ready && i < iterations; i++)
+                {
+                    timer.restart();
+                    is_ready = execMix(db, user_id, plants, error);
+                    samples.push_back(timer.nsecsElapsed());
+                }
+            }
+            else if(error.isEmpty())
+            {
+                error = db.lastError().text();
+            }
+
+            db.close();
+        }
+        QSqlDatabase::removeDatabase("benchmark_" + profile_name);
+
+        if(!error.isEmpty() || samples.empty())
+        {
+            out << profile_name << ": " << error << '\n';
+            continue;
+        }
+
+        double total_ns(0);
+        for(auto sample: samples)
+        {
+            total_ns += sample;
+        }
+
+        const double mean_ns(total_ns / samples.size());
+
+        out << profile_name.leftJustified(8)
+            << QString::number(open_ns / 1e6, 'f', 3).rightJustified(10)
+            << QString::number(mean_ns / 1e6, 'f', 3).rightJustified(10)
+            << QString::number(bench::percentile(samples, 0.50) / 1e6, 'f', 3).rightJustified(10)
+            << QString::number(bench::percentile(samples, 0.99) / 1e6, 'f', 3).rightJustified(10)
+            << QString::number(1e9 / mean_ns, 'f', 1).rightJustified(10)
+            << '\n';
+    }
+
+    return 0;
+}
+
+
+/* ************************
+ * Local Functions - Begin
+ *************************/
+
+/**
+ * Finds user owning the most plants - data of that user gives the heaviest realistic mix
+ *
+ * @param db - open database
+ * @return id of user (invalid QVariant if there are no plants)
+ */
+static QVariant findBusiestUser(QSqlDatabase &db)
+{
+    QSqlQuery qry(db);
+
+    if(qry.exec("SELECT owner_id FROM biogas_server_plant "
+                "GROUP BY owner_id ORDER BY COUNT(*) DESC LIMIT 1") && qry.next())
+    {
+        return qry.value(0);
+    }
+
+    return QVariant();
+}
+
+/**
+ * @param db - open database
+ * @param user_id - owner of plants
+ * @return ids of plants owned by user
+ */
+static std::vector<QVariant> findPlants(QSqlDatabase &db, const QVariant &user_id)
+{
+    std::vector<QVariant> plants;
+    QSqlQuery qry(db);
+
+    qry.prepare("SELECT PlantID FROM biogas_server_plant WHERE owner_id = :user");
+    qry.bindValue(":user", user_id);
+
+    if(qry.exec())
+    {
+        while(qry.next())
+        {
+            plants.push_back(qry.value(0));
+        }
+    }
+
+    return plants;
+}
+
+/**
+ * Executes one query mix - statements issued by GUI during typical session
+ *
+ * @return false if any statement failed (error is set)
+ */
+static bool execMix(QSqlDatabase &db,
+                    const QVariant &user_id,
+                    const std::vector<QVariant> &plants,
+                    QString &error)
+{
+    const QVariantMap user{{":user", user_id}};
+
+    // Login and Menu
+    bool result = bench::execStatement(db, "SELECT userID FROM biogas_server_user "
+                                           "WHERE userID = :user AND (password = :password OR password = :hashed)",
+                                       {{":user", user_id}, {":password", "x"}, {":hashed", "y"}}, error)
+            && bench::execStatement(db, "SELECT name, surname, email FROM biogas_server_user "
+                                        "WHERE userID = :user", user, error)
+            && bench::execStatement(db, "SELECT city, street, number, postalCode AS post, country "
+                                        "FROM biogas_server_corespondanceaddres "
+                                        "WHERE userID_id = :user", user, error);
+
+    // BiogasCalculator and Services - plant list and switching between plants
+    result = result && bench::execStatement(db, "SELECT PlantID, location FROM biogas_server_plant "
+                                                "WHERE owner_id = :user", user, error)
+            && bench::execStatement(db, "SELECT * FROM biogas_server_substrate AS substrates "
+                                        "WHERE NOT EXISTS (SELECT * FROM biogas_server_substrate_owner AS owners "
+                                        "WHERE substrates.substrateID = owners.substrate_id)"
+                                        "UNION "
+                                        "SELECT * FROM biogas_server_substrate AS substrates WHERE substrateID IN"
+                                        " (SELECT substrate_id FROM biogas_server_substrate_owner AS owners"
+                                        " WHERE owners.user_id = :user)", user, error);
+
+    for(auto plant = plants.cbegin(); result && plant != plants.cend(); ++plant)
+    {
+        const QVariantMap binds{{":plant", *plant}};
+
+        result = bench::execStatement(db, "SELECT SUM(volume) FROM biogas_server_container "
+                                          "WHERE fromPlant_id = :plant", binds, error)
+                && bench::execStatement(db, "SELECT date, title, description, done, notice "
+                                            "FROM biogas_server_service "
+                                            "WHERE forPlant_id = :plant "
+                                            "GROUP BY date", binds, error);
+    }
+
+    // PhoneTable - load, add and remove number
+    result = result && bench::execStatement(db, "SELECT phoneID, phoneNumber, owner_id "
+                                                "FROM biogas_server_phonenumber "
+                                                "WHERE owner_id = :user", user, error)
+            && bench::execStatement(db, "INSERT INTO biogas_server_phonenumber (phoneNumber, owner_id) "
+                                        "VALUES ('+48000000000', :user)", user, error)
+            && bench::execStatement(db, "DELETE FROM biogas_server_phonenumber "
+                                        "WHERE owner_id = :user AND phoneNumber = '+48000000000'", user, error);
+
+    return result;
+}
+
+/* ************************
+ * Local Functions - End
+ *************************/
@@ -0,0 +1,153 @@
+/**
+ * Benchmark of vectorized yield kernel (see yield::mixTotalsBatch)
+ *
+ * Random batch of mixes is generated in structure-of-arrays layout and
+ * evaluated repeatedly with every instruction set supported by CPU.
+ * Throughput in mixes per second and largest relative deviation
+ * from scalar kernel are reported.
+ *
+ * Usage: yield_throughput_benchmark [mixes] [substrates per mix] [iterations]
+ */
+#include "Calculation/Inc/yield_kernel.h"
+#include "Benchmarks/Inc/bench_utils.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QTextStream>
+
+/* ************************
+ * Local Functions Prototypes - Begin
+ *************************/
+
+static double maxDeviation(const std::vector<yield::Result> &results,
+                           const std::vector<yield::Result> &reference);
+
+/* ************************
+ * Local Functions Prototypes - End
+ *************************/
+
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QTextStream out(stdout);
+
+    const int mixes(argc > 1 ? std::max(1, QString(argv[1]).toInt()) : 100000);
+    const int substrates(argc > 2 ? std::max(1, QString(argv[2]).toInt()) : 8);
+    const int iterations(argc > 3 ? std::max(1, QString(argv[3]).toInt()) : 50);
+
+    // Parameters in ranges of real substrates (from slurry to maize silage)
+    std::mt19937_64 generator(42);
+    std::uniform_real_distribution<double> ots(60, 95),
+                                           biogas(300, 750),
+                                           methane(150, 400),
+                                           amount(0, 50),
+                                           ts(5, 40);
+
+    const size_t size(size_t(mixes) * size_t(substrates));
+    std::vector<double> ots_values(size), biogas_values(size), methane_values(size), amount_values(size), ts_values(size);
+
+    for(size_t i = 0; i < size; i++)
+    {
+        ots_values[i] = ots(generator);
+        biogas_values[i] = biogas(generator);
+        methane_values[i] = methane(generator);
+        amount_values[i] = amount(generator);
+        ts_values[i] = ts(generator);
+    }
+
+    const yield::YieldBuffers buffers{ots_values.data(),
+                                      biogas_values.data(),
+                                      methane_values.data(),
+                                      amount_values.data(),
+                                      ts_values.data()};
+
+    std::vector<yield::Result> reference(mixes);
+    yield::mixTotalsBatch(buffers, substrates, mixes, reference.data(), yield::KernelIsa::Scalar);
+
+    out << "mixes: " << mixes << ", substrates per mix: " << substrates
+        << ", iterations: " << iterations
+        << ", selected kernel: " << yield::kernelName(yield::kernelIsa()) << '\n';
+    out << "kernel    mean[ms]   p50[ms]   Mmixes/s   max deviation\n";
+
+    for(auto isa: {yield::KernelIsa::Scalar, yield::KernelIsa::Avx2, yield::KernelIsa::Neon})
+    {
+        if(!yield::isKernelSupported(isa))
+        {
+            continue;
+        }
+
+        std::vector<yield::Result> results(mixes);
+        std::vector<qint64> samples;
+        QElapsedTimer timer;
+
+        yield::mixTotalsBatch(buffers, substrates, mixes, results.data(), isa);   // warm up
+
+        for(int i = 0; i < iterations; i++)
+        {
+            timer.start();
+            yield::mixTotalsBatch(buffers, substrates, mixes, results.data(), isa);
+            samples.push_back(timer.nsecsElapsed());
+        }
+
+        double total_ns(0);
+        for(auto sample: samples)
+        {
+            total_ns += sample;
+        }
+
+        const double mean_ns(total_ns / samples.size());
+
+        out << yield::kernelName(isa).leftJustified(8)
+            << QString::number(mean_ns / 1e6, 'f', 3).rightJustified(10)
+            << QString::number(bench::percentile(samples, 0.50) / 1e6, 'f', 3).rightJustified(10)
+            << QString::number(mixes / mean_ns * 1e3, 'f', 2).rightJustified(11)
+            << QString::number(maxDeviation(results, reference), 'e', 1).rightJustified(16)
+            << '\n';
+    }
+
+    return 0;
+}
+
+
+/* ************************
+ * Local Functions - Begin
+ *************************/
+
+/**
+ * @param results - totals given by benchmarked kernel
+ * @param reference - totals given by scalar kernel
+ * @return largest relative difference of methane and biogas
+ */
+static double maxDeviation(const std::vector<yield::Result> &results,
+                           const std::vector<yield::Result> &reference)
+{
+    double deviation(0);
+
+    for(size_t mix = 0; mix < results.size(); mix++)
+    {
+        const double methane(std::abs(reference[mix].methane));
+        const double biogas(std::abs(reference[mix].biogas));
+
+        if(methane > 0)
+        {
+            deviation = std::max(deviation, std::abs(results[mix].methane - reference[mix].methane) / methane);
+        }
+
+        if(biogas > 0)
+        {
+            deviation = std::max(deviation, std::abs(results[mix].biogas - reference[mix].biogas) / biogas);
+        }
+    }
+
+    return deviation;
+}
+
+/* ************************
+ * Local Functions - End
+ *************************/
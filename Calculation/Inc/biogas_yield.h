@@ -0,0 +1,92 @@
+#ifndef BIOGAS_YIELD_H
+#define BIOGAS_YIELD_H
+
+#include <vector>
+
+#include <QHash>
+#include <QString>
+
+
+namespace yield{
+
+    struct Substrate
+    {
+        qlonglong id;
+        double ots;             //organic dry matter [% of TS]
+        double biogas;          //biogas yield of oTS
+        double methane;         //methane yield of oTS
+    };
+
+    struct FeedItem
+    {
+        qlonglong substrate_id;
+        double amount;          //fresh mass fed to plant
+        double ts;              //total solids [% of fresh mass]
+    };
+
+    struct Result
+    {
+        double methane;
+        double biogas;
+        double amount;          //fresh mass of whole mix
+    };
+
+    typedef QHash<qlonglong, Substrate> Catalog;
+
+    Result feedYield(const Substrate &substrate, double amount, double ts);
+
+    bool mixYield(const Catalog &catalog,
+                  const std::vector<FeedItem> &feed,
+                  Result &result,
+                  QString &error);
+
+
+    /*
+     * Totals of feeding mix kept up to date while substrates are added and removed
+     *
+     * Totals are updated in O(1) per changed part - part is added to (or subtracted
+     * from) compensated sums instead of summing whole mix again. Subtracting leaves
+     * rounding error behind, so every resum_interval changes totals are summed again
+     * exactly from stored parts, which bounds the drift.
+     * Parts are indexed like rows of mix (index of removed part = removed row),
+     * so removing parts also erases them from storage - O(size), like removing rows
+     * of table; removeRange removes many of them with one erase.
+     */
+    class MixTotals
+    {
+    public:
+        explicit MixTotals(int resum_interval = 256);
+
+        void add(const Result &part);
+        void remove(int index);
+        void removeRange(int first, int count);
+        void clear();
+
+        Result totals() const;
+        int size() const;
+
+    private:
+        struct Sum
+        {
+            double value;
+            double compensation;    //lost low-order bits (Neumaier summation)
+
+            void add(double term);
+            double total() const;
+        };
+
+        std::vector<Result> m_parts;
+        Sum m_methane;
+        Sum m_biogas;
+        Sum m_amount;
+
+        int m_resum_interval;
+        int m_changes;          //changes since last exact summation
+
+        void mApply(const Result &part);
+        void mResum();
+    };
+
+}//namespace yield
+
+#endif // BIOGAS_YIELD_H
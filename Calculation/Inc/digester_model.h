@@ -0,0 +1,76 @@
+#ifndef DIGESTER_MODEL_H
+#define DIGESTER_MODEL_H
+
+#include <vector>
+
+#include <QString>
+
+#include "Calculation/Inc/biogas_yield.h"
+
+
+/*
+ * Time-resolved simulation of digesters (reduced anaerobic digestion model)
+ *
+ * Each container is a continuously stirred tank fed with share of daily feed
+ * of its plant (by volume). Feed brings methane potential (see feedYield) as
+ * particulate matter, which is hydrolysed with first-order rate to soluble
+ * substrate, which is taken up by methanogens with Monod kinetics:
+ *
+ *   dX/dt = F/V - D*X - kh*X                  X - particulate potential [m3 CH4 / m3]
+ *   dS/dt = kh*X - mu(S)*B/Y - D*S             S - soluble potential [m3 CH4 / m3]
+ *   dB/dt = (mu(S) - kd - D)*B                 B - methanogens [kg / m3]
+ *   mu(S) = mu_max*S/(Ks + S)                  D = daily feed volume / V
+ *
+ * Soluble potential taken up is released as methane, biogas follows ratio
+ * of biogas to methane of feed. Equations are integrated with adaptive
+ * Bogacki-Shampine 3(2) method - step restarts at every day, as feed changes.
+ * Plants are simulated in parallel (QtConcurrent), state of plant stays in
+ * registers for whole horizon and its curve is one contiguous row of output.
+ */
+namespace yield{
+
+    struct DigesterKinetics
+    {
+        double hydrolysis;          //kh [1/day]
+        double max_growth;          //mu_max [1/day]
+        double half_saturation;     //Ks [m3 CH4 / m3]
+        double biomass_yield;       //Y [kg / m3 CH4]
+        double decay;               //kd [1/day]
+        double inoculum;            //B at start of simulation [kg / m3]
+    };
+
+    struct DigesterOptions
+    {
+        DigesterKinetics kinetics;
+        int days;                   //horizon
+        double relative_tolerance;
+        double absolute_tolerance;
+    };
+
+    struct PlantFeeding
+    {
+        qlonglong plant_id;
+        std::vector<double> volumes;    //volume of each container of plant [m3]
+        std::vector<Result> schedule;   //feed of each day (see mixYield), repeated until horizon
+    };
+
+    /*
+     * Daily gas of all plants, value of day d of plant p is at [p * days + d]
+     */
+    struct GasCurves
+    {
+        int days;
+        std::vector<double> methane;    //[m3 / day]
+        std::vector<double> biogas;     //[m3 / day]
+    };
+
+    DigesterOptions defaultDigesterOptions();
+
+    bool simulateDigesters(const std::vector<PlantFeeding> &plants,
+                           const DigesterOptions &options,
+                           GasCurves &curves,
+                           QString &error);
+
+}//namespace yield
+
+#endif // DIGESTER_MODEL_H
@@ -0,0 +1,38 @@
+#ifndef FEED_OPTIMIZER_H
+#define FEED_OPTIMIZER_H
+
+#include <vector>
+
+#include <QString>
+
+#include "Calculation/Inc/biogas_yield.h"
+
+
+/*
+ * Feeding mix that gives the most methane from volume of plant
+ *
+ * Production of substrate grows linearly with its amount (see feedYield) and
+ * mix is limited by one constraint (volume) and stock of each substrate, so
+ * optimal mix of linear program is found greedily: substrates are taken by
+ * methane per unit of fresh mass, the best one first, each up to its stock,
+ * until volume is filled (only the last one is taken partially).
+ * Sorting dominates - O(n log n), milliseconds for catalogs of thousands.
+ */
+namespace yield{
+
+    struct Candidate
+    {
+        Substrate substrate;
+        double ts;              //total solids [% of fresh mass]
+        double stock;           //largest amount that can be fed (infinity if unlimited)
+    };
+
+    bool optimizeMix(const std::vector<Candidate> &candidates,
+                     double volume,
+                     std::vector<FeedItem> &feed,
+                     Result &result,
+                     QString &error);
+
+}//namespace yield
+
+#endif // FEED_OPTIMIZER_H
@@ -0,0 +1,48 @@
+#ifndef YIELD_KERNEL_H
+#define YIELD_KERNEL_H
+
+#include <QString>
+
+#include "Calculation/Inc/biogas_yield.h"
+
+
+/*
+ * Vectorized evaluation of expected production of feeding mixes
+ *
+ * Works on structure-of-arrays buffers (one contiguous array per parameter),
+ * so each instruction computes 4 (AVX2) or 2 (NEON) substrates or mixes.
+ * Instruction set is selected at runtime - AVX2 with FMA if CPU supports it,
+ * NEON on AArch64, plain C++ otherwise. Results equal sums of feedYield
+ * up to rounding (order of additions differs between instruction sets).
+ */
+namespace yield{
+
+    struct YieldBuffers
+    {
+        const double *ots;          //organic dry matter [% of TS]
+        const double *biogas;       //biogas yield of oTS
+        const double *methane;      //methane yield of oTS
+        const double *amount;       //fresh mass fed to plant
+        const double *ts;           //total solids [% of fresh mass]
+    };
+
+    enum class KernelIsa
+    {
+        Scalar,
+        Avx2,
+        Neon
+    };
+
+    KernelIsa kernelIsa();
+    bool isKernelSupported(KernelIsa isa);
+    QString kernelName(KernelIsa isa);
+
+    Result mixTotals(const YieldBuffers &buffers, int count);
+    Result mixTotals(const YieldBuffers &buffers, int count, KernelIsa isa);
+
+    void mixTotalsBatch(const YieldBuffers &buffers, int substrates, int mixes, Result *results);
+    void mixTotalsBatch(const YieldBuffers &buffers, int substrates, int mixes, Result *results, KernelIsa isa);
+
+}//namespace yield
+
+#endif // YIELD_KERNEL_H
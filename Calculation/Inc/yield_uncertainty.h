@@ -0,0 +1,66 @@
+#ifndef YIELD_UNCERTAINTY_H
+#define YIELD_UNCERTAINTY_H
+
+#include <QString>
+
+#include "Calculation/Inc/biogas_yield.h"
+#include "Calculation/Inc/yield_kernel.h"
+
+
+/*
+ * Monte Carlo bands of expected production of feeding mix
+ *
+ * Lab values of substrate (oTS, biogas and methane yield) are single numbers,
+ * in each draw they are replaced by samples spread around them; percentiles of
+ * production over all draws are reported. Draws are split into chunks evaluated
+ * in parallel (QtConcurrent), each chunk has its own random stream seeded by
+ * seed and index of chunk - result doesn't depend on number of threads.
+ */
+namespace yield{
+
+    enum class Distribution
+    {
+        Normal,
+        Uniform,
+        Triangular          //symmetric
+    };
+
+    struct Spread
+    {
+        Distribution distribution;
+        double relative;            //standard deviation relative to lab value (0.1 = 10 %)
+    };
+
+    struct Uncertainty
+    {
+        Spread ots;
+        Spread biogas;
+        Spread methane;
+        quint64 seed;
+    };
+
+    struct Percentiles
+    {
+        double p10;
+        double p50;
+        double p90;
+    };
+
+    struct YieldBands
+    {
+        Percentiles methane;
+        Percentiles biogas;
+    };
+
+    Uncertainty defaultUncertainty();
+
+    bool simulateMix(const YieldBuffers &mix,
+                     int count,
+                     const Uncertainty &uncertainty,
+                     int draws,
+                     YieldBands &bands,
+                     QString &error);
+
+}//namespace yield
+
+#endif // YIELD_UNCERTAINTY_H
@@ -0,0 +1,217 @@
+#include "Calculation/Inc/biogas_yield.h"
+
+#include <cmath>
+
+#include <QObject>
+
+namespace yield{
+
+    /**
+     * Calculates expected production of one substrate (Simplified for now)
+     * Only organic part of dry matter is digested:
+     * oTS/100 * TS/100 * amount gives mass of oTS, which is multiplied by yields
+     *
+     * @param substrate - parameters of substrate from catalog
+     * @param amount - fresh mass of substrate
+     * @param ts - total solids [% of fresh mass]
+     * @return expected methane and biogas (amount is set to given amount)
+     */
+    Result feedYield(const Substrate &substrate, double amount, double ts)
+    {
+        const double ots_mass(substrate.ots / 100. * ts / 100. * amount);
+
+        return Result{ots_mass * substrate.methane,
+                      ots_mass * substrate.biogas,
+                      amount};
+    }
+
+    /**
+     * Calculates expected production of feeding mix (sum of its substrates)
+     *
+     * @param catalog - substrates that mix can be made of
+     * @param feed - substrates of mix with their amounts and TS
+     * @param result - expected methane, biogas and whole fresh mass of mix
+     * @param error - set if mix refers to substrate missing in catalog
+     * @return true if all substrates of mix were found
+     */
+    bool mixYield(const Catalog &catalog,
+                  const std::vector<FeedItem> &feed,
+                  Result &result,
+                  QString &error)
+    {
+        result = Result{0, 0, 0};
+
+        for(const auto &item: feed)
+        {
+            auto substrate = catalog.constFind(item.substrate_id);
+
+            if(substrate == catalog.cend())
+            {
+                error = QObject::tr("Unknown substrate %1").arg(item.substrate_id);
+                return false;
+            }
+
+            const Result part(feedYield(*substrate, item.amount, item.ts));
+
+            result.methane += part.methane;
+            result.biogas += part.biogas;
+            result.amount += part.amount;
+        }
+
+        return true;
+    }
+
+
+    /**
+     * Creates totals of empty mix
+     *
+     * @param resum_interval - number of changes after which totals are summed again exactly
+     */
+    MixTotals::MixTotals(int resum_interval):
+        m_methane{0, 0},
+        m_biogas{0, 0},
+        m_amount{0, 0},
+        m_resum_interval(resum_interval > 0 ? resum_interval : 1),
+        m_changes(0)
+    {}
+
+    /**
+     * Adds substrate to mix (as its last part)
+     *
+     * @param part - expected production of substrate (see feedYield)
+     */
+    void MixTotals::add(const Result &part)
+    {
+        m_parts.push_back(part);
+        mApply(part);
+    }
+
+    /**
+     * Removes substrate from mix
+     *
+     * @param index - index of part (row of mix)
+     */
+    void MixTotals::remove(int index)
+    {
+        removeRange(index, 1);
+    }
+
+    /**
+     * Removes consecutive substrates from mix
+     * Totals change in O(count), stored parts are erased at once like rows
+     * of mix - O(count + size) in total
+     *
+     * @param first - index of first removed part (row of mix)
+     * @param count - number of removed parts
+     */
+    void MixTotals::removeRange(int first, int count)
+    {
+        if(first < 0 || count <= 0 || first + count > int(m_parts.size()))
+        {
+            return;
+        }
+
+        const auto begin(m_parts.begin() + first);
+        const auto end(begin + count);
+
+        for(auto part = begin; part != end; ++part)
+        {
+            m_methane.add(-part->methane);
+            m_biogas.add(-part->biogas);
+            m_amount.add(-part->amount);
+        }
+
+        m_parts.erase(begin, end);
+        m_changes += count;
+
+        if(m_changes >= m_resum_interval || m_parts.empty())
+        {
+            mResum();
+        }
+    }
+
+    /**
+     * Removes all substrates from mix
+     */
+    void MixTotals::clear()
+    {
+        m_parts.clear();
+        mResum();
+    }
+
+    /**
+     * @return expected methane, biogas and fresh mass of whole mix
+     */
+    Result MixTotals::totals() const
+    {
+        return Result{m_methane.total(), m_biogas.total(), m_amount.total()};
+    }
+
+    /**
+     * @return number of substrates in mix
+     */
+    int MixTotals::size() const
+    {
+        return int(m_parts.size());
+    }
+
+    /**
+     * Adds term keeping rounding error of addition in compensation
+     */
+    void MixTotals::Sum::add(double term)
+    {
+        const double sum(value + term);
+
+        if(std::fabs(value) >= std::fabs(term))
+        {
+            compensation += (value - sum) + term;
+        }
+        else
+        {
+            compensation += (term - sum) + value;
+        }
+
+        value = sum;
+    }
+
+    double MixTotals::Sum::total() const
+    {
+        return value + compensation;
+    }
+
+    /**
+     * Adds part to totals (or sums whole mix again when resum interval is reached)
+     */
+    void MixTotals::mApply(const Result &part)
+    {
+        if(++m_changes >= m_resum_interval)
+        {
+            mResum();
+            return;
+        }
+
+        m_methane.add(part.methane);
+        m_biogas.add(part.biogas);
+        m_amount.add(part.amount);
+    }
+
+    /**
+     * Sums all parts again (empty mix gives exact zeros)
+     */
+    void MixTotals::mResum()
+    {
+        m_methane = Sum{0, 0};
+        m_biogas = Sum{0, 0};
+        m_amount = Sum{0, 0};
+
+        for(const auto &part: m_parts)
+        {
+            m_methane.add(part.methane);
+            m_biogas.add(part.biogas);
+            m_amount.add(part.amount);
+        }
+
+        m_changes = 0;
+    }
+
+}//namespace yield
@@ -0,0 +1,336 @@
+#include "Calculation/Inc/digester_model.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include <QObject>
+#include <QtConcurrent/QtConcurrentMap>
+
+/*
+ * State of digester - 32 bytes, fits cache line with room to spare
+ */
+struct DigesterState
+{
+    double particulate;     //X
+    double soluble;         //S
+    double biomass;         //B
+    double methane;         //methane released since start of day [m3]
+
+    DigesterState operator+ (const DigesterState &other) const
+    {
+        return DigesterState{particulate + other.particulate,
+                             soluble + other.soluble,
+                             biomass + other.biomass,
+                             methane + other.methane};
+    }
+
+    DigesterState operator* (double factor) const
+    {
+        return DigesterState{particulate * factor,
+                             soluble * factor,
+                             biomass * factor,
+                             methane * factor};
+    }
+};
+
+/*
+ * Feed of container during one day
+ */
+struct DailyFeed
+{
+    double potential;       //methane potential fed per m3 of container [m3 CH4 / (m3 day)]
+    double dilution;        //D [1/day]
+};
+
+// Smallest step - reached only if tolerances can't be met, then the step is accepted anyway
+static const double min_step(1e-6);
+
+/* ************************
+ * Local Functions Prototypes - Begin
+ *************************/
+
+static bool isValid(const yield::DigesterOptions &options);
+
+static void simulatePlant(const yield::PlantFeeding &plant,
+                          const yield::DigesterOptions &options,
+                          double *methane,
+                          double *biogas);
+
+static double simulateDay(DigesterState &state,
+                          double &step,
+                          const DailyFeed &feed,
+                          double volume,
+                          const yield::DigesterOptions &options);
+
+static DigesterState derivative(const DigesterState &state,
+                                const DailyFeed &feed,
+                                double volume,
+                                const yield::DigesterKinetics &kinetics);
+
+/* ************************
+ * Local Functions Prototypes - End
+ *************************/
+
+
+namespace yield{
+
+    /**
+     * Gives kinetics of mesophilic digester fed with agricultural substrates
+     * (hydrolysis is the limiting step) and tolerances good enough for daily curves
+     */
+    DigesterOptions defaultDigesterOptions()
+    {
+        return DigesterOptions{DigesterKinetics{0.25, 0.4, 2.0, 0.02, 0.02, 1.0},
+                               365,
+                               1e-4,
+                               1e-3};
+    }
+
+    /**
+     * Simulates daily gas production of plants from empty (inoculated) containers
+     *
+     * @param plants - containers and feeding schedule of each plant
+     * @param options - kinetics, horizon and tolerances of integration
+     * @param curves - set to daily methane and biogas of each plant (plants in order of input)
+     * @param error - set if options or plant aren't valid
+     * @return true if plants were simulated
+     */
+    bool simulateDigesters(const std::vector<PlantFeeding> &plants,
+                           const DigesterOptions &options,
+                           GasCurves &curves,
+                           QString &error)
+    {
+        curves.days = 0;
+        curves.methane.clear();
+        curves.biogas.clear();
+
+        if(!isValid(options))
+        {
+            error = QObject::tr("Horizon, kinetics and tolerances of simulation have to be positive values");
+            return false;
+        }
+
+        for(const auto &plant: plants)
+        {
+            const bool has_volume(!plant.volumes.empty()
+                                  && std::all_of(plant.volumes.begin(), plant.volumes.end(),
+                                                 [](double volume) {return volume > 0; }));
+            const bool has_feed(!plant.schedule.empty()
+                                && std::all_of(plant.schedule.begin(), plant.schedule.end(),
+                                               [](const Result &day) {return day.amount >= 0 && day.methane >= 0 && day.biogas >= 0; }));
+
+            if(!has_volume || !has_feed)
+            {
+                error = QObject::tr("Plant %1 has no containers or invalid feeding schedule").arg(plant.plant_id);
+                return false;
+            }
+        }
+
+        const size_t size(plants.size() * size_t(options.days));
+
+        curves.days = options.days;
+        curves.methane.assign(size, 0);
+        curves.biogas.assign(size, 0);
+
+        std::vector<size_t> indexes(plants.size());
+        for(size_t plant = 0; plant < plants.size(); plant++)
+        {
+            indexes[plant] = plant;
+        }
+
+        double *methane(curves.methane.data());
+        double *biogas(curves.biogas.data());
+
+        // Each plant writes its own rows of curves only
+        QtConcurrent::blockingMap(indexes, [&plants, &options, methane, biogas](size_t plant)
+        {
+            const size_t offset(plant * size_t(options.days));
+
+            simulatePlant(plants[plant], options, methane + offset, biogas + offset);
+        });
+
+        return true;
+    }
+
+}//namespace yield
+
+
+/* ************************
+ * Local Functions - Begin
+ *************************/
+
+/**
+ * @return true if horizon, kinetics and tolerances are positive (decay may be zero)
+ */
+static bool isValid(const yield::DigesterOptions &options)
+{
+    const yield::DigesterKinetics &kinetics(options.kinetics);
+
+    return options.days > 0
+            && options.relative_tolerance > 0
+            && options.absolute_tolerance > 0
+            && kinetics.hydrolysis > 0
+            && kinetics.max_growth > 0
+            && kinetics.half_saturation > 0
+            && kinetics.biomass_yield > 0
+            && kinetics.decay >= 0
+            && kinetics.inoculum > 0;
+}
+
+/**
+ * Simulates containers of plant
+ *
+ * @param methane - row of plant in curves (days values)
+ * @param biogas - row of plant in curves (days values)
+ */
+static void simulatePlant(const yield::PlantFeeding &plant,
+                          const yield::DigesterOptions &options,
+                          double *methane,
+                          double *biogas)
+{
+    double total_volume(0);
+    for(auto volume: plant.volumes)
+    {
+        total_volume += volume;
+    }
+
+    std::vector<DailyFeed> feeds(plant.schedule.size());
+    std::vector<double> biogas_ratios(plant.schedule.size());
+    double ratio(0);
+
+    // Schedule repeats - day without feed keeps ratio of previous feed, first days the one of last feed
+    for(const auto &feed: plant.schedule)
+    {
+        if(feed.methane > 0)
+        {
+            ratio = feed.biogas / feed.methane;
+        }
+    }
+
+    for(size_t day = 0; day < plant.schedule.size(); day++)
+    {
+        const yield::Result &feed(plant.schedule[day]);
+
+        feeds[day] = DailyFeed{feed.methane / total_volume, feed.amount / total_volume};
+
+        if(feed.methane > 0)
+        {
+            ratio = feed.biogas / feed.methane;
+        }
+
+        biogas_ratios[day] = ratio;
+    }
+
+    // Concentrations of all containers are equal (same start, same load per m3) -
+    // one tank of total volume gives the same gas as sum of containers
+    DigesterState state{0, 0, options.kinetics.inoculum, 0};
+    double step(0.5);
+
+    for(int day = 0; day < options.days; day++)
+    {
+        methane[day] = simulateDay(state, step, feeds[size_t(day) % feeds.size()], total_volume, options);
+    }
+
+    for(int day = 0; day < options.days; day++)
+    {
+        biogas[day] = methane[day] * biogas_ratios[size_t(day) % biogas_ratios.size()];
+    }
+}
+
+/**
+ * Integrates state of container over one day with adaptive step
+ * (Bogacki-Shampine 3(2) - error of step is difference of 3rd and 2nd order solution)
+ *
+ * @param state - state at start of day, set to state at end of day
+ * @param step - initial step, set to step proposed for next day
+ * @param feed - feed of day
+ * @param volume - volume of container
+ * @return methane released during day [m3]
+ */
+static double simulateDay(DigesterState &state,
+                          double &step,
+                          const DailyFeed &feed,
+                          double volume,
+                          const yield::DigesterOptions &options)
+{
+    const yield::DigesterKinetics &kinetics(options.kinetics);
+
+    double time(0);
+    DigesterState k1(derivative(state, feed, volume, kinetics));
+
+    state.methane = 0;
+
+    while(time < 1)
+    {
+        const bool last(step >= 1 - time);
+        const double h(last ? 1 - time : step);
+
+        const DigesterState k2(derivative(state + k1 * (h / 2), feed, volume, kinetics));
+        const DigesterState k3(derivative(state + k2 * (h * 3 / 4), feed, volume, kinetics));
+        const DigesterState next(state + (k1 * (2. / 9) + k2 * (1. / 3) + k3 * (4. / 9)) * h);
+        const DigesterState k4(derivative(next, feed, volume, kinetics));
+        const DigesterState difference((k1 * (-5. / 72) + k2 * (1. / 12) + k3 * (1. / 9) + k4 * (-1. / 8)) * h);
+
+        auto scaled = [&options](double error, double before, double after)
+        {
+            return std::abs(error) / (options.absolute_tolerance
+                                      + options.relative_tolerance * std::max(std::abs(before), std::abs(after)));
+        };
+
+        // Methane is integral of uptake - its error follows from error of concentrations
+        const double norm(std::max({scaled(difference.particulate, state.particulate, next.particulate),
+                                    scaled(difference.soluble, state.soluble, next.soluble),
+                                    scaled(difference.biomass, state.biomass, next.biomass)}));
+
+        // Step grows at most 5 times, shrinks at most 5 times (0.9 is safety factor)
+        const double factor(norm > 0 ? std::min(5., std::max(0.2, 0.9 / std::cbrt(norm))) : 5.);
+
+        if(norm <= 1 || h <= min_step)
+        {
+            time = last ? 1 : time + h;
+
+            // Concentrations can't be negative - overshoot of nearly depleted substrate is cut off
+            state = DigesterState{std::max(0., next.particulate),
+                                  std::max(0., next.soluble),
+                                  std::max(0., next.biomass),
+                                  next.methane};
+
+            // First same as last - k4 is derivative at new state unless it was cut off
+            k1 = (next.particulate >= 0 && next.soluble >= 0 && next.biomass >= 0)
+                    ? k4 : derivative(state, feed, volume, kinetics);
+
+            // Step shortened to end of day doesn't shorten steps of next day
+            step = last ? std::max(step, h * factor) : h * factor;
+        }
+        else
+        {
+            step = std::max(min_step, h * factor);
+        }
+    }
+
+    return state.methane;
+}
+
+/**
+ * Right-hand side of model (see description in header)
+ *
+ * @return derivative of state [per day]
+ */
+static DigesterState derivative(const DigesterState &state,
+                                const DailyFeed &feed,
+                                double volume,
+                                const yield::DigesterKinetics &kinetics)
+{
+    const double hydrolysis(kinetics.hydrolysis * state.particulate);
+    const double growth(kinetics.max_growth * state.soluble / (kinetics.half_saturation + state.soluble));
+    const double uptake(growth * state.biomass / kinetics.biomass_yield);
+
+    return DigesterState{feed.potential - feed.dilution * state.particulate - hydrolysis,
+                         hydrolysis - uptake - feed.dilution * state.soluble,
+                         (growth - kinetics.decay - feed.dilution) * state.biomass,
+                         uptake * volume};
+}
+
+/* ************************
+ * Local Functions - End
+ *************************/
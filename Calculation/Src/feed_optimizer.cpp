@@ -0,0 +1,96 @@
+#include "Calculation/Inc/feed_optimizer.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include <QObject>
+
+namespace yield{
+
+    /**
+     * Finds feeding mix that maximizes methane (see description in header)
+     * Candidates that produce no methane or have no stock are left out,
+     * ties are broken by biogas, then by id, so the same input gives the same mix
+     *
+     * @param candidates - substrates that mix can be made of, with TS and stock
+     * @param volume - volume of plant available for mix
+     * @param feed - set to substrates of optimal mix with their amounts (best first)
+     * @param result - expected methane, biogas and whole fresh mass of optimal mix
+     * @param error - set if volume or parameter of candidate isn't valid
+     * @return true if mix was found (it is empty if no candidate produces methane)
+     */
+    bool optimizeMix(const std::vector<Candidate> &candidates,
+                     double volume,
+                     std::vector<FeedItem> &feed,
+                     Result &result,
+                     QString &error)
+    {
+        feed.clear();
+        result = Result{0, 0, 0};
+
+        if(!(volume > 0) || std::isinf(volume))
+        {
+            error = QObject::tr("Available volume has to be positive value");
+            return false;
+        }
+
+        struct Ranked
+        {
+            Result density;     //production of unit of fresh mass
+            size_t index;
+        };
+
+        std::vector<Ranked> ranked;
+        ranked.reserve(candidates.size());
+
+        for(size_t index = 0; index < candidates.size(); index++)
+        {
+            const Candidate &candidate(candidates[index]);
+
+            if(!(candidate.ts > 0 && candidate.ts <= 100) || std::isnan(candidate.stock))
+            {
+                error = QObject::tr("Invalid TS or stock of substrate %1").arg(candidate.substrate.id);
+                return false;
+            }
+
+            const Result density(feedYield(candidate.substrate, 1, candidate.ts));
+
+            if(density.methane > 0 && candidate.stock > 0)
+            {
+                ranked.push_back(Ranked{density, index});
+            }
+        }
+
+        std::sort(ranked.begin(), ranked.end(), [&candidates](const Ranked &a, const Ranked &b)
+        {
+            return a.density.methane != b.density.methane ? a.density.methane > b.density.methane
+                 : a.density.biogas != b.density.biogas ? a.density.biogas > b.density.biogas
+                 : candidates[a.index].substrate.id < candidates[b.index].substrate.id;
+        });
+
+        double left(volume);
+
+        for(const auto &it: ranked)
+        {
+            if(left <= 0)
+            {
+                break;
+            }
+
+            const Candidate &candidate(candidates[it.index]);
+            const double amount(std::min(candidate.stock, left));
+            const Result part(feedYield(candidate.substrate, amount, candidate.ts));
+
+            feed.push_back(FeedItem{candidate.substrate.id, amount, candidate.ts});
+
+            result.methane += part.methane;
+            result.biogas += part.biogas;
+            result.amount += part.amount;
+
+            left -= amount;
+        }
+
+        return true;
+    }
+
+}//namespace yield
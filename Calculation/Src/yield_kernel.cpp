@@ -0,0 +1,430 @@
+#include "Calculation/Inc/yield_kernel.h"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+    #define YIELD_KERNEL_X86
+    #include <immintrin.h>
+    #if defined(_MSC_VER) && !defined(__clang__)
+        #include <intrin.h>
+        #define YIELD_KERNEL_AVX2_TARGET
+    #else
+        #define YIELD_KERNEL_AVX2_TARGET __attribute__((target("avx2,fma")))
+    #endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+    #define YIELD_KERNEL_NEON
+    #include <arm_neon.h>
+#endif
+
+/*
+ * oTS and TS are percentages: ots/100 * ts/100 * amount = ots * ts * amount * 1e-4
+ *
+ * Batch layout: parameter of substrate s in mix m is at [s * mixes + m],
+ * so consecutive mixes are consecutive in memory and are computed together
+ */
+static const double percent_squared(1e-4);
+
+/* ************************
+ * Local Functions Prototypes - Begin
+ *************************/
+
+static yield::KernelIsa detectIsa();
+
+static yield::Result totalsScalar(const yield::YieldBuffers &buffers, int first, int last);
+
+static void batchScalar(const yield::YieldBuffers &buffers, int substrates, int mixes,
+                        int first_mix, yield::Result *results);
+
+#ifdef YIELD_KERNEL_X86
+static bool cpuSupportsAvx2();
+
+static yield::Result totalsAvx2(const yield::YieldBuffers &buffers, int count);
+
+static void batchAvx2(const yield::YieldBuffers &buffers, int substrates, int mixes, yield::Result *results);
+#endif
+
+#ifdef YIELD_KERNEL_NEON
+static yield::Result totalsNeon(const yield::YieldBuffers &buffers, int count);
+
+static void batchNeon(const yield::YieldBuffers &buffers, int substrates, int mixes, yield::Result *results);
+#endif
+
+/* ************************
+ * Local Functions Prototypes - End
+ *************************/
+
+
+namespace yield{
+
+    /**
+     * Gives instruction set used by kernel (detected once)
+     *
+     * @return best instruction set supported by CPU
+     */
+    KernelIsa kernelIsa()
+    {
+        static const KernelIsa isa(detectIsa());
+
+        return isa;
+    }
+
+    /**
+     * @param isa - instruction set
+     * @return true if kernel for instruction set is built in and CPU supports it
+     */
+    bool isKernelSupported(KernelIsa isa)
+    {
+        switch(isa)
+        {
+            case KernelIsa::Avx2:
+            case KernelIsa::Neon:
+                return kernelIsa() == isa;
+
+            case KernelIsa::Scalar:
+            default:
+                return true;
+        }
+    }
+
+    /**
+     * @return name of instruction set (for reports)
+     */
+    QString kernelName(KernelIsa isa)
+    {
+        switch(isa)
+        {
+            case KernelIsa::Avx2:
+                return "avx2";
+
+            case KernelIsa::Neon:
+                return "neon";
+
+            case KernelIsa::Scalar:
+            default:
+                return "scalar";
+        }
+    }
+
+    /**
+     * Calculates expected production of one mix
+     *
+     * @param buffers - parameters of substrates of mix (arrays of count values)
+     * @param count - number of substrates in mix
+     * @return expected methane, biogas and fresh mass of mix
+     */
+    Result mixTotals(const YieldBuffers &buffers, int count)
+    {
+        return mixTotals(buffers, count, kernelIsa());
+    }
+
+    /**
+     * Calculates expected production of one mix with given instruction set
+     * (unsupported instruction set falls back to scalar kernel)
+     */
+    Result mixTotals(const YieldBuffers &buffers, int count, KernelIsa isa)
+    {
+        if(!isKernelSupported(isa))
+        {
+            isa = KernelIsa::Scalar;
+        }
+
+        switch(isa)
+        {
+#ifdef YIELD_KERNEL_X86
+            case KernelIsa::Avx2:
+                return totalsAvx2(buffers, count);
+#endif
+#ifdef YIELD_KERNEL_NEON
+            case KernelIsa::Neon:
+                return totalsNeon(buffers, count);
+#endif
+            default:
+                return totalsScalar(buffers, 0, count);
+        }
+    }
+
+    /**
+     * Calculates expected production of many mixes made of the same number of substrates
+     * (e.g. candidates of optimizer or samples of simulation)
+     *
+     * @param buffers - parameters, value of substrate s in mix m is at [s * mixes + m]
+     * @param substrates - number of substrates in each mix
+     * @param mixes - number of mixes
+     * @param results - array of mixes values, set to totals of each mix
+     */
+    void mixTotalsBatch(const YieldBuffers &buffers, int substrates, int mixes, Result *results)
+    {
+        mixTotalsBatch(buffers, substrates, mixes, results, kernelIsa());
+    }
+
+    /**
+     * Calculates expected production of many mixes with given instruction set
+     * (unsupported instruction set falls back to scalar kernel)
+     */
+    void mixTotalsBatch(const YieldBuffers &buffers, int substrates, int mixes, Result *results, KernelIsa isa)
+    {
+        if(!isKernelSupported(isa))
+        {
+            isa = KernelIsa::Scalar;
+        }
+
+        switch(isa)
+        {
+#ifdef YIELD_KERNEL_X86
+            case KernelIsa::Avx2:
+                batchAvx2(buffers, substrates, mixes, results);
+                break;
+#endif
+#ifdef YIELD_KERNEL_NEON
+            case KernelIsa::Neon:
+                batchNeon(buffers, substrates, mixes, results);
+                break;
+#endif
+            default:
+                batchScalar(buffers, substrates, mixes, 0, results);
+                break;
+        }
+    }
+
+}//namespace yield
+
+
+/* ************************
+ * Local Functions - Begin
+ *************************/
+
+/**
+ * @return best instruction set that kernel is built with and CPU supports
+ */
+static yield::KernelIsa detectIsa()
+{
+#if defined(YIELD_KERNEL_X86)
+    return cpuSupportsAvx2() ? yield::KernelIsa::Avx2 : yield::KernelIsa::Scalar;
+#elif defined(YIELD_KERNEL_NEON)
+    return yield::KernelIsa::Neon;      //part of every AArch64 CPU
+#else
+    return yield::KernelIsa::Scalar;
+#endif
+}
+
+/**
+ * Sums substrates first..last-1 of one mix
+ */
+static yield::Result totalsScalar(const yield::YieldBuffers &buffers, int first, int last)
+{
+    yield::Result result{0, 0, 0};
+
+    for(int i = first; i < last; i++)
+    {
+        const double ots_mass(buffers.ots[i] * buffers.ts[i] * buffers.amount[i] * percent_squared);
+
+        result.methane += ots_mass * buffers.methane[i];
+        result.biogas += ots_mass * buffers.biogas[i];
+        result.amount += buffers.amount[i];
+    }
+
+    return result;
+}
+
+/**
+ * Calculates mixes first_mix..mixes-1 of batch, one by one
+ */
+static void batchScalar(const yield::YieldBuffers &buffers, int substrates, int mixes,
+                        int first_mix, yield::Result *results)
+{
+    for(int mix = first_mix; mix < mixes; mix++)
+    {
+        yield::Result result{0, 0, 0};
+
+        for(int substrate = 0; substrate < substrates; substrate++)
+        {
+            const int i(substrate * mixes + mix);
+            const double ots_mass(buffers.ots[i] * buffers.ts[i] * buffers.amount[i] * percent_squared);
+
+            result.methane += ots_mass * buffers.methane[i];
+            result.biogas += ots_mass * buffers.biogas[i];
+            result.amount += buffers.amount[i];
+        }
+
+        results[mix] = result;
+    }
+}
+
+#ifdef YIELD_KERNEL_X86
+
+/**
+ * @return true if CPU and operating system support AVX2 and FMA
+ */
+static bool cpuSupportsAvx2()
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+
+    __cpuid(info, 1);
+    const bool fma((info[2] & (1 << 12)) != 0);
+    const bool os_saves_ymm((info[2] & (1 << 27)) != 0 && (_xgetbv(0) & 0x6) == 0x6);
+
+    __cpuidex(info, 7, 0);
+    const bool avx2((info[1] & (1 << 5)) != 0);
+
+    return fma && os_saves_ymm && avx2;
+#else
+    __builtin_cpu_init();
+
+    return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#endif
+}
+
+/**
+ * Sums substrates of one mix, 4 at a time
+ */
+YIELD_KERNEL_AVX2_TARGET
+static yield::Result totalsAvx2(const yield::YieldBuffers &buffers, int count)
+{
+    const __m256d scale(_mm256_set1_pd(percent_squared));
+    __m256d methane(_mm256_setzero_pd()),
+            biogas(_mm256_setzero_pd()),
+            amount(_mm256_setzero_pd());
+
+    int i(0);
+
+    for(; i + 4 <= count; i += 4)
+    {
+        const __m256d fed(_mm256_loadu_pd(buffers.amount + i));
+        const __m256d ots_mass(_mm256_mul_pd(_mm256_mul_pd(_mm256_loadu_pd(buffers.ots + i),
+                                                           _mm256_loadu_pd(buffers.ts + i)),
+                                             _mm256_mul_pd(fed, scale)));
+
+        methane = _mm256_fmadd_pd(ots_mass, _mm256_loadu_pd(buffers.methane + i), methane);
+        biogas = _mm256_fmadd_pd(ots_mass, _mm256_loadu_pd(buffers.biogas + i), biogas);
+        amount = _mm256_add_pd(amount, fed);
+    }
+
+    alignas(32) double lanes[3][4];
+    _mm256_store_pd(lanes[0], methane);
+    _mm256_store_pd(lanes[1], biogas);
+    _mm256_store_pd(lanes[2], amount);
+
+    yield::Result result(totalsScalar(buffers, i, count));
+
+    result.methane += (lanes[0][0] + lanes[0][1]) + (lanes[0][2] + lanes[0][3]);
+    result.biogas += (lanes[1][0] + lanes[1][1]) + (lanes[1][2] + lanes[1][3]);
+    result.amount += (lanes[2][0] + lanes[2][1]) + (lanes[2][2] + lanes[2][3]);
+
+    return result;
+}
+
+/**
+ * Calculates 4 mixes at a time (each lane is one mix), rest of mixes one by one
+ */
+YIELD_KERNEL_AVX2_TARGET
+static void batchAvx2(const yield::YieldBuffers &buffers, int substrates, int mixes, yield::Result *results)
+{
+    const __m256d scale(_mm256_set1_pd(percent_squared));
+    int mix(0);
+
+    for(; mix + 4 <= mixes; mix += 4)
+    {
+        __m256d methane(_mm256_setzero_pd()),
+                biogas(_mm256_setzero_pd()),
+                amount(_mm256_setzero_pd());
+
+        for(int substrate = 0; substrate < substrates; substrate++)
+        {
+            const int i(substrate * mixes + mix);
+            const __m256d fed(_mm256_loadu_pd(buffers.amount + i));
+            const __m256d ots_mass(_mm256_mul_pd(_mm256_mul_pd(_mm256_loadu_pd(buffers.ots + i),
+                                                               _mm256_loadu_pd(buffers.ts + i)),
+                                                 _mm256_mul_pd(fed, scale)));
+
+            methane = _mm256_fmadd_pd(ots_mass, _mm256_loadu_pd(buffers.methane + i), methane);
+            biogas = _mm256_fmadd_pd(ots_mass, _mm256_loadu_pd(buffers.biogas + i), biogas);
+            amount = _mm256_add_pd(amount, fed);
+        }
+
+        alignas(32) double lanes[3][4];
+        _mm256_store_pd(lanes[0], methane);
+        _mm256_store_pd(lanes[1], biogas);
+        _mm256_store_pd(lanes[2], amount);
+
+        for(int lane = 0; lane < 4; lane++)
+        {
+            results[mix + lane] = yield::Result{lanes[0][lane], lanes[1][lane], lanes[2][lane]};
+        }
+    }
+
+    batchScalar(buffers, substrates, mixes, mix, results);
+}
+
+#endif // YIELD_KERNEL_X86
+
+#ifdef YIELD_KERNEL_NEON
+
+/**
+ * Sums substrates of one mix, 2 at a time
+ */
+static yield::Result totalsNeon(const yield::YieldBuffers &buffers, int count)
+{
+    const float64x2_t scale(vdupq_n_f64(percent_squared));
+    float64x2_t methane(vdupq_n_f64(0)),
+                biogas(vdupq_n_f64(0)),
+                amount(vdupq_n_f64(0));
+
+    int i(0);
+
+    for(; i + 2 <= count; i += 2)
+    {
+        const float64x2_t fed(vld1q_f64(buffers.amount + i));
+        const float64x2_t ots_mass(vmulq_f64(vmulq_f64(vld1q_f64(buffers.ots + i), vld1q_f64(buffers.ts + i)),
+                                             vmulq_f64(fed, scale)));
+
+        methane = vfmaq_f64(methane, ots_mass, vld1q_f64(buffers.methane + i));
+        biogas = vfmaq_f64(biogas, ots_mass, vld1q_f64(buffers.biogas + i));
+        amount = vaddq_f64(amount, fed);
+    }
+
+    yield::Result result(totalsScalar(buffers, i, count));
+
+    result.methane += vaddvq_f64(methane);
+    result.biogas += vaddvq_f64(biogas);
+    result.amount += vaddvq_f64(amount);
+
+    return result;
+}
+
+/**
+ * Calculates 2 mixes at a time (each lane is one mix), rest of mixes one by one
+ */
+static void batchNeon(const yield::YieldBuffers &buffers, int substrates, int mixes, yield::Result *results)
+{
+    const float64x2_t scale(vdupq_n_f64(percent_squared));
+    int mix(0);
+
+    for(; mix + 2 <= mixes; mix += 2)
+    {
+        float64x2_t methane(vdupq_n_f64(0)),
+                    biogas(vdupq_n_f64(0)),
+                    amount(vdupq_n_f64(0));
+
+        for(int substrate = 0; substrate < substrates; substrate++)
+        {
+            const int i(substrate * mixes + mix);
+            const float64x2_t fed(vld1q_f64(buffers.amount + i));
+            const float64x2_t ots_mass(vmulq_f64(vmulq_f64(vld1q_f64(buffers.ots + i), vld1q_f64(buffers.ts + i)),
+                                                 vmulq_f64(fed, scale)));
+
+            methane = vfmaq_f64(methane, ots_mass, vld1q_f64(buffers.methane + i));
+            biogas = vfmaq_f64(biogas, ots_mass, vld1q_f64(buffers.biogas + i));
+            amount = vaddq_f64(amount, fed);
+        }
+
+        results[mix] = yield::Result{vgetq_lane_f64(methane, 0), vgetq_lane_f64(biogas, 0), vgetq_lane_f64(amount, 0)};
+        results[mix + 1] = yield::Result{vgetq_lane_f64(methane, 1), vgetq_lane_f64(biogas, 1), vgetq_lane_f64(amount, 1)};
+    }
+
+    batchScalar(buffers, substrates, mixes, mix, results);
+}
+
+#endif // YIELD_KERNEL_NEON
+
+/* ************************
+ * Local Functions - End
+ *************************/
@@ -0,0 +1,380 @@
+#include "Calculation/Inc/yield_uncertainty.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include <QObject>
+#include <QtConcurrent/QtConcurrentMap>
+
+/*
+ * Chunk is big enough for vectorized kernel and to amortize scheduling,
+ * small enough to keep its buffers in cache and to balance load between threads
+ */
+static const int chunk_draws(1024);
+
+struct Chunk
+{
+    int first;          //index of first draw
+    int size;           //number of draws
+};
+
+/*
+ * Inverse distribution functions are tabulated with quantile_cells cells and
+ * interpolated linearly - sample costs table lookup instead of logarithm, square
+ * root and rejection. Normal distribution is clipped beyond ±3.5 standard deviations
+ * (1 draw in 2 000), which doesn't move percentiles of mix.
+ */
+static const int quantile_cells(4096);
+
+/*
+ * Random stream of one chunk (xoshiro256**), seeded by splitmix64
+ * of seed and index of chunk, so streams of chunks don't overlap in practice
+ * Sample is lab value * (1 + relative * z), z has zero mean and unit standard deviation
+ */
+struct Sampler
+{
+    quint64 state[4];
+
+    Sampler(quint64 seed, int chunk);
+
+    quint64 next();
+    double sample(const yield::Spread &spread, const std::vector<double> &quantiles, double value);
+};
+
+/* ************************
+ * Local Functions Prototypes - Begin
+ *************************/
+
+static bool isValid(const yield::Spread &spread);
+
+static const std::vector<double> &quantileTable(yield::Distribution distribution);
+
+static double quantile(yield::Distribution distribution, double p);
+
+static void simulateChunk(const yield::YieldBuffers &mix,
+                          int count,
+                          const yield::Uncertainty &uncertainty,
+                          const Chunk &chunk,
+                          yield::Result *results);
+
+static yield::Percentiles percentiles(std::vector<double> &values);
+
+/* ************************
+ * Local Functions Prototypes - End
+ *************************/
+
+
+namespace yield{
+
+    /**
+     * Gives spread typical for lab values of agricultural substrates
+     * (oTS ±5 %, biogas yield ±15 %, methane yield ±10 %, normal distribution)
+     */
+    Uncertainty defaultUncertainty()
+    {
+        return Uncertainty{Spread{Distribution::Normal, 0.05},
+                           Spread{Distribution::Normal, 0.15},
+                           Spread{Distribution::Normal, 0.10},
+                           20240601};
+    }
+
+    /**
+     * Calculates P10, P50 and P90 of expected production of mix
+     * Amount and TS are fed as given, lab values are sampled in every draw
+     *
+     * @param mix - parameters of substrates of mix (arrays of count values, see YieldBuffers)
+     * @param count - number of substrates in mix
+     * @param uncertainty - spread of lab values and seed of random streams
+     * @param draws - number of draws
+     * @param bands - set to percentiles of methane and biogas of mix
+     * @param error - set if number of draws or spread isn't valid
+     * @return true if simulation was run (bands are zero for empty mix)
+     */
+    bool simulateMix(const YieldBuffers &mix,
+                     int count,
+                     const Uncertainty &uncertainty,
+                     int draws,
+                     YieldBands &bands,
+                     QString &error)
+    {
+        bands = YieldBands{Percentiles{0, 0, 0}, Percentiles{0, 0, 0}};
+
+        if(draws <= 0 || count < 0)
+        {
+            error = QObject::tr("Number of draws has to be positive value");
+            return false;
+        }
+
+        if(!(isValid(uncertainty.ots) && isValid(uncertainty.biogas) && isValid(uncertainty.methane)))
+        {
+            error = QObject::tr("Spread of lab values has to be positive value");
+            return false;
+        }
+
+        if(count == 0)
+        {
+            return true;
+        }
+
+        std::vector<Chunk> chunks;
+        chunks.reserve(size_t(draws / chunk_draws + 1));
+
+        for(int first = 0; first < draws; first += chunk_draws)
+        {
+            chunks.push_back(Chunk{first, std::min(chunk_draws, draws - first)});
+        }
+
+        std::vector<Result> results(static_cast<size_t>(draws));
+        Result *results_ptr(results.data());
+
+        // Idle threads of pool take next chunk, so chunks of slow threads don't hold others up
+        QtConcurrent::blockingMap(chunks, [&mix, count, &uncertainty, results_ptr](const Chunk &chunk)
+                                  {simulateChunk(mix, count, uncertainty, chunk, results_ptr); });
+
+        std::vector<double> methane(results.size()), biogas(results.size());
+
+        for(size_t draw = 0; draw < results.size(); draw++)
+        {
+            methane[draw] = results[draw].methane;
+            biogas[draw] = results[draw].biogas;
+        }
+
+        bands.methane = percentiles(methane);
+        bands.biogas = percentiles(biogas);
+
+        return true;
+    }
+
+}//namespace yield
+
+
+/**
+ * @param seed - seed of simulation
+ * @param chunk - index of chunk
+ */
+Sampler::Sampler(quint64 seed, int chunk)
+{
+    quint64 mixed(seed ^ (quint64(chunk) * 0x9E3779B97F4A7C15ull));
+
+    for(auto &word: state)
+    {
+        mixed += 0x9E3779B97F4A7C15ull;
+
+        quint64 z(mixed);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        word = z ^ (z >> 31);
+    }
+}
+
+/**
+ * @return next random number of stream
+ */
+quint64 Sampler::next()
+{
+    const quint64 product(state[1] * 5);
+    const quint64 result(((product << 7) | (product >> 57)) * 9);
+    const quint64 shifted(state[1] << 17);
+
+    state[2] ^= state[0];
+    state[3] ^= state[1];
+    state[1] ^= state[2];
+    state[0] ^= state[3];
+    state[2] ^= shifted;
+    state[3] = (state[3] << 45) | (state[3] >> 19);
+
+    return result;
+}
+
+/**
+ * @param spread - shape and relative standard deviation
+ * @param quantiles - table of distribution of spread (see quantileTable)
+ * @param value - lab value
+ * @return sampled value (never negative)
+ */
+double Sampler::sample(const yield::Spread &spread, const std::vector<double> &quantiles, double value)
+{
+    const double position(double(next() >> 11) * (quantile_cells / 9007199254740992.));     // [0, cells)
+    const int cell(static_cast<int>(position));
+    const double z(quantiles[size_t(cell)] + (position - cell) * (quantiles[size_t(cell) + 1] - quantiles[size_t(cell)]));
+
+    return std::max(0., value * (1 + spread.relative * z));
+}
+
+
+/* ************************
+ * Local Functions - Begin
+ *************************/
+
+/**
+ * @return true if relative spread is finite and not negative
+ */
+static bool isValid(const yield::Spread &spread)
+{
+    return spread.relative >= 0 && std::isfinite(spread.relative);
+}
+
+/**
+ * Gives inverse distribution function of standardized distribution
+ * at quantile_cells + 1 evenly spaced probabilities (built once)
+ *
+ * @return table of quantiles
+ */
+static const std::vector<double> &quantileTable(yield::Distribution distribution)
+{
+    auto build = [](yield::Distribution shape)
+    {
+        std::vector<double> table(quantile_cells + 1);
+
+        for(int cell = 0; cell <= quantile_cells; cell++)
+        {
+            // Outermost points are moved half a cell inwards - quantile of 0 and 1 is infinite for normal distribution
+            const double p(std::min(std::max(double(cell), 0.5), quantile_cells - 0.5) / quantile_cells);
+
+            table[size_t(cell)] = quantile(shape, p);
+        }
+
+        return table;
+    };
+
+    static const std::vector<double> normal(build(yield::Distribution::Normal));
+    static const std::vector<double> uniform(build(yield::Distribution::Uniform));
+    static const std::vector<double> triangular(build(yield::Distribution::Triangular));
+
+    switch(distribution)
+    {
+        case yield::Distribution::Uniform:
+            return uniform;
+
+        case yield::Distribution::Triangular:
+            return triangular;
+
+        case yield::Distribution::Normal:
+        default:
+            return normal;
+    }
+}
+
+/**
+ * Inverse distribution function of distribution with zero mean and unit standard deviation
+ * (normal one by rational approximation of P. J. Acklam, relative error below 1.2e-9)
+ *
+ * @param p - probability (0, 1)
+ * @return quantile
+ */
+static double quantile(yield::Distribution distribution, double p)
+{
+    switch(distribution)
+    {
+        case yield::Distribution::Uniform:
+            return std::sqrt(3.) * (2 * p - 1);
+
+        case yield::Distribution::Triangular:
+            return p < 0.5 ? std::sqrt(6.) * (std::sqrt(2 * p) - 1)
+                           : std::sqrt(6.) * (1 - std::sqrt(2 * (1 - p)));
+
+        case yield::Distribution::Normal:
+        default:
+            break;
+    }
+
+    static const double a[] = {-3.969683028665376e+01, 2.209460984245205e+02, -2.759285104469687e+02,
+                               1.383577518672690e+02, -3.066479806614716e+01, 2.506628277459239e+00};
+    static const double b[] = {-5.447609879822406e+01, 1.615858368580409e+02, -1.556989798598866e+02,
+                               6.680131188771972e+01, -1.328068155288572e+01};
+    static const double c[] = {-7.784894002430293e-03, -3.223964580411365e-01, -2.400758277161838e+00,
+                               -2.549732539343734e+00, 4.374664141464968e+00, 2.938163982698783e+00};
+    static const double d[] = {7.784695709041462e-03, 3.224671290700398e-01, 2.445134137142996e+00,
+                               3.754408661907416e+00};
+    static const double p_low(0.02425);
+
+    if(p < p_low || p > 1 - p_low)
+    {
+        const double q(std::sqrt(-2 * std::log(p < p_low ? p : 1 - p)));
+        const double z((((((c[0] * q + c[1]) * q + c[2]) * q + c[3]) * q + c[4]) * q + c[5])
+                       / ((((d[0] * q + d[1]) * q + d[2]) * q + d[3]) * q + 1));
+
+        return p < p_low ? z : -z;
+    }
+
+    const double q(p - 0.5);
+    const double r(q * q);
+
+    return (((((a[0] * r + a[1]) * r + a[2]) * r + a[3]) * r + a[4]) * r + a[5]) * q
+            / (((((b[0] * r + b[1]) * r + b[2]) * r + b[3]) * r + b[4]) * r + 1);
+}
+
+/**
+ * Samples lab values of chunk of draws and evaluates them with vectorized kernel
+ * (draws of chunk are mixes of batch, see yield::mixTotalsBatch)
+ *
+ * @param results - array of all draws, draws of chunk are set
+ */
+static void simulateChunk(const yield::YieldBuffers &mix,
+                          int count,
+                          const yield::Uncertainty &uncertainty,
+                          const Chunk &chunk,
+                          yield::Result *results)
+{
+    const size_t size(size_t(count) * size_t(chunk.size));
+    std::vector<double> ots(size), biogas(size), methane(size), amount(size), ts(size);
+
+    const std::vector<double> &ots_quantiles(quantileTable(uncertainty.ots.distribution));
+    const std::vector<double> &biogas_quantiles(quantileTable(uncertainty.biogas.distribution));
+    const std::vector<double> &methane_quantiles(quantileTable(uncertainty.methane.distribution));
+
+    Sampler sampler(uncertainty.seed, chunk.first / chunk_draws);
+
+    for(int substrate = 0; substrate < count; substrate++)
+    {
+        const size_t offset(size_t(substrate) * size_t(chunk.size));
+
+        for(int draw = 0; draw < chunk.size; draw++)
+        {
+            const size_t i(offset + size_t(draw));
+
+            ots[i] = std::min(100., sampler.sample(uncertainty.ots, ots_quantiles, mix.ots[substrate]));
+            biogas[i] = sampler.sample(uncertainty.biogas, biogas_quantiles, mix.biogas[substrate]);
+            methane[i] = sampler.sample(uncertainty.methane, methane_quantiles, mix.methane[substrate]);
+        }
+
+        std::fill(amount.begin() + long(offset), amount.begin() + long(offset + size_t(chunk.size)), mix.amount[substrate]);
+        std::fill(ts.begin() + long(offset), ts.begin() + long(offset + size_t(chunk.size)), mix.ts[substrate]);
+    }
+
+    const yield::YieldBuffers buffers{ots.data(), biogas.data(), methane.data(), amount.data(), ts.data()};
+
+    yield::mixTotalsBatch(buffers, count, chunk.size, results + chunk.first);
+}
+
+/**
+ * @param values - production of all draws (reordered)
+ * @return P10, P50 and P90 of values (nearest rank)
+ */
+static yield::Percentiles percentiles(std::vector<double> &values)
+{
+    auto rank = [&values](double fraction)
+    {
+        return values.begin() + long(std::min(values.size() - 1, size_t(fraction * values.size())));
+    };
+
+    // Median splits values, lower and upper percentile are searched in their halves only
+    auto p50 = rank(0.5);
+    std::nth_element(values.begin(), p50, values.end());
+
+    auto p10 = rank(0.1);
+    std::nth_element(values.begin(), p10, p50);
+
+    auto p90 = rank(0.9);
+    if(p90 != p50)
+    {
+        std::nth_element(p50 + 1, p90, values.end());
+    }
+
+    return yield::Percentiles{*p10, *p50, *p90};
+}
+
+/* ************************
+ * Local Functions - End
+ *************************/
@@ -5,13 +5,18 @@
 #include <QSqlQuery>
 
 #include "Database/Inc/db_manager.h"
+#include "Database/Inc/db_sqlite.h"
+#include "Database/Inc/db_async.h"
+#include "Database/Inc/db_batch.h"
+#include "Database/Inc/db_reference_cache.h"
 
 typedef std::shared_ptr<DbManager> DbSQL;
 
 
 namespace database{
     DbSQL createSQLiteDatabase(const QString &path,
-                               const QString &filename);
+                               const QString &filename,
+                               SQLiteProfile profile = SQLiteProfile::Kiosk);
 
     DbSQL createMySQLDatabase(const QString &db_name,
                               const QString &hostname,
@@ -21,6 +26,41 @@ namespace database{
 
     bool isConnEstablished(DbSQL &db_ptr);
 
+    QueryHandle execAsync(DbSQL &db_ptr,
+                          const QString &sql,
+                          const QVariantMap &binds,
+                          QObject *context_ptr,
+                          QueryCallback on_finished);
+
+    QueryHandle execReadAsync(DbSQL &db_ptr,
+                              const QString &sql,
+                              const QVariantMap &binds,
+                              QObject *context_ptr,
+                              QueryCallback on_finished);
+
+    QueryHandle execStreamAsync(DbSQL &db_ptr,
+                                const QString &sql,
+                                const QVariantMap &binds,
+                                int chunk_rows,
+                                QObject *context_ptr,
+                                QueryCallback on_chunk,
+                                QueryCallback on_finished);
+
+    QueryHandle execBatchAsync(DbSQL &db_ptr,
+                               const qry_helper::BatchWriter &batch,
+                               QObject *context_ptr,
+                               QueryCallback on_finished);
+
+    QueryResult execLeased(DbManager *db_ptr,
+                           const QString &sql,
+                           const QVariantMap &binds);
+
+    void execParallel(DbManager *db_ptr,
+                      const QString &sql,
+                      const QVariantMap &binds,
+                      QObject *context_ptr,
+                      QueryCallback on_finished);
+
 }//namespace database
 
 
@@ -30,6 +70,10 @@ namespace qry_helper{
                          const QVariant &bind_value,
                          QSql::ParamType paramType = QSql::In);
 
+    QVariant valueOrNull(const QVariant &value);
+
+    bool exec(QSqlQuery &qry);
+
 }//namespace qry_helper
 
 #endif // DATABASE_H
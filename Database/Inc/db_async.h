@@ -0,0 +1,146 @@
+#ifndef DB_ASYNC_H
+#define DB_ASYNC_H
+
+#include <atomic>
+#include <functional>
+#include <memory>
+
+#include <QHash>
+#include <QMutex>
+#include <QObject>
+#include <QPointer>
+#include <QStringList>
+#include <QThread>
+#include <QVariant>
+#include <QVector>
+#include <QWaitCondition>
+
+#include "Database/Inc/db_batch.h"
+#include "Database/Inc/db_pool.h"
+
+class DbManager;
+
+
+namespace database{
+
+    struct QueryResult
+    {
+        bool ok;
+        bool cancelled;
+        QString error;
+
+        QStringList columns;
+        QVector<QVector<QVariant>> rows;
+
+        int rows_affected;
+        QVariant last_insert_id;
+
+        QueryResult();
+
+        bool isEmpty() const;
+
+        template<typename T>
+        T value(int row, int column) const
+        {
+            return rows.at(row).at(column).value<T>();
+        }
+    };
+
+    typedef std::function<void(const QueryResult &result)> QueryCallback;
+
+
+    class QueryHandle
+    {
+    public:
+        QueryHandle();
+
+        void cancel();
+        bool isCancelled() const;
+        bool isPending() const;
+
+    private:
+        friend class AsyncExecutor;
+
+        struct State
+        {
+            std::atomic<bool> cancelled;
+            std::atomic<bool> finished;
+            std::atomic<int> chunks_in_flight;  //streamed chunks not delivered to GUI yet
+
+            QMutex mutex;
+            QWaitCondition chunk_delivered;     //stream waits on it while too many chunks are in flight
+
+            void wakeStream();
+        };
+
+        std::shared_ptr<State> m_state_ptr;
+    };
+
+
+    class AsyncExecutor final: public QObject
+    {
+    public:
+        explicit AsyncExecutor(DbManager *db_ptr);
+        ~AsyncExecutor();
+
+        QueryHandle submit(const QString &sql,
+                           const QVariantMap &binds,
+                           QObject *context_ptr,
+                           QueryCallback on_finished);
+
+        QueryHandle submitStream(const QString &sql,
+                                 const QVariantMap &binds,
+                                 int chunk_rows,
+                                 QObject *context_ptr,
+                                 QueryCallback on_chunk,
+                                 QueryCallback on_finished);
+
+        QueryHandle submitBatch(const qry_helper::BatchWriter &batch,
+                                QObject *context_ptr,
+                                QueryCallback on_finished);
+
+        void keepAlive();
+
+        AsyncExecutor(const AsyncExecutor&) = delete;
+        AsyncExecutor &operator= (const AsyncExecutor&) = delete;
+
+    private:
+        struct PendingQuery
+        {
+            QPointer<QObject> context_ptr;
+            QueryCallback on_finished;
+            std::shared_ptr<QueryHandle::State> state_ptr;
+            QueryCallback on_chunk;
+        };
+
+        DbManager *m_db_ptr;
+
+        QThread m_thread;
+        std::unique_ptr<QObject> m_worker_ptr;
+        DbConnectionLease m_worker_lease;    //used only from worker thread
+
+        quint64 m_last_task_id;
+        QHash<quint64, PendingQuery> m_pending;
+
+        void mRun(quint64 task_id,
+                  const QString &sql,
+                  const QVariantMap &binds,
+                  std::shared_ptr<QueryHandle::State> state_ptr);
+        void mRunStream(quint64 task_id,
+                        const QString &sql,
+                        const QVariantMap &binds,
+                        int chunk_rows,
+                        std::shared_ptr<QueryHandle::State> state_ptr);
+        void mRunBatch(quint64 task_id,
+                       qry_helper::BatchWriter batch,
+                       std::shared_ptr<QueryHandle::State> state_ptr);
+        QueryHandle mRegister(QObject *context_ptr,
+                              QueryCallback on_finished,
+                              quint64 &task_id);
+        void mDeliver(quint64 task_id, const QueryResult &result);
+        void mDeliverChunk(quint64 task_id, const QueryResult &chunk);
+    };
+
+}//namespace database
+
+#endif // DB_ASYNC_H
@@ -0,0 +1,58 @@
+#ifndef DB_BATCH_H
+#define DB_BATCH_H
+
+#include <vector>
+
+#include <QSqlDatabase>
+#include <QString>
+#include <QVariant>
+#include <QVector>
+
+
+namespace qry_helper{
+
+    struct BatchStats
+    {
+        int statements;         //round trips to database
+        int rows;               //parameter sets written
+        int rows_affected;      //as reported by driver (see BatchWriter::exec)
+        qint64 elapsed_ns;      //whole transaction with commit
+
+        double rowsPerSecond() const;
+    };
+
+
+    class BatchWriter
+    {
+    public:
+        BatchWriter();
+
+        void add(const QString &sql, const QVariantMap &binds);
+
+        int size() const;
+        bool isEmpty() const;
+        void clear();
+
+        bool exec(QSqlDatabase db, QString &error);
+        BatchStats stats() const;
+
+    private:
+        struct Step
+        {
+            QString sql;
+            QVector<QVariantMap> rows;
+        };
+
+        std::vector<Step> m_steps;
+        BatchStats m_stats;
+
+        bool mExecStep(QSqlDatabase &db, const Step &step, QString &error);
+        bool mExecSingle(QSqlDatabase &db, const Step &step, QString &error);
+        bool mExecMultiRow(QSqlDatabase &db, const Step &step, QString &error);
+        bool mExecBatch(QSqlDatabase &db, const Step &step, QString &error);
+        void mRecord(const QString &sql, qint64 elapsed_ns, int rows, int rows_affected, const QStringList &bound_names);
+    };
+
+}//namespace qry_helper
+
+#endif // DB_BATCH_H
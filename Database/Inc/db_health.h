@@ -0,0 +1,90 @@
+#ifndef DB_HEALTH_H
+#define DB_HEALTH_H
+
+#include <memory>
+
+#include <QMetaType>
+#include <QObject>
+#include <QString>
+#include <QThread>
+#include <QTimer>
+
+#include "Database/Inc/db_pool.h"
+
+class DbManager;
+
+
+namespace database{
+
+    enum class ConnectionState
+    {
+        Connected,
+        Reconnecting,   //connection lost, next attempt is scheduled
+        Disconnected    //reconnecting failed several times (attempts continue with maximal delay)
+    };
+
+
+    struct HealthConfig
+    {
+        int ping_interval_ms;       //keepalive period while connected
+        int idle_threshold_ms;      //no queries for that long - connections of application are pre-warmed
+        int backoff_initial_ms;     //delay of first reconnect attempt
+        int backoff_max_ms;         //limit of exponentially growing delay
+        int max_attempts;           //failed attempts before state becomes Disconnected
+    };
+
+    HealthConfig defaultHealthConfig();
+
+
+    class HealthMonitor final: public QObject
+    {
+        Q_OBJECT
+
+    public:
+        HealthMonitor(DbManager *db_ptr, const HealthConfig &config);
+        ~HealthMonitor();
+
+        void start();
+        void stop();
+        void checkNow();
+
+        bool isRunning() const;
+        ConnectionState state() const;
+        QString lastError() const;
+
+        HealthMonitor(const HealthMonitor&) = delete;
+        HealthMonitor &operator= (const HealthMonitor&) = delete;
+
+    signals:
+        void stateChanged(database::ConnectionState state);
+        void connectionLost(const QString &error);
+        void connectionRestored();
+
+    private:
+        DbManager *m_db_ptr;
+        HealthConfig m_config;
+
+        ConnectionState m_state;
+        QString m_last_error;
+        int m_failed_attempts;
+        int m_backoff_ms;
+        bool m_is_probe_pending;
+
+        QTimer m_timer;
+        QThread m_thread;
+        std::unique_ptr<QObject> m_worker_ptr;
+        DbConnectionLease m_worker_lease;    //used only from worker thread
+
+        void mProbe();
+        bool mPing(QString &error);
+        void mOnProbeFinished(bool is_alive, bool is_idle, QString error);
+        bool mWarmUp(QString &error);
+        void mSetState(ConnectionState state, const QString &error);
+        int mNextBackoff();
+    };
+
+}//namespace database
+
+Q_DECLARE_METATYPE(database::ConnectionState)
+
+#endif // DB_HEALTH_H
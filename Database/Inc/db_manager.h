@@ -1,21 +1,65 @@
 #ifndef DBMANAGER_H
 #define DBMANAGER_H
 
+#include <functional>
+#include <memory>
+
 #include <QSqlDatabase>
+#include <QSqlQuery>
 #include <QString>
+#include <QThread>
+#include <QVariant>
+
+#include "Database/Inc/db_pool.h"
+
+namespace database{
+    class AsyncExecutor;
+    class HealthMonitor;
+    class ReferenceCache;
+}
+
+typedef std::function<void(const QString &error)> DbErrorHandler;
+typedef std::function<bool(const QString &var_name, QVariant &var)> DbConfigPrompt;
 
 
 class DbManager
 {
 public:
     DbManager();
-    ~DbManager();
+    virtual ~DbManager();
 
     virtual bool initDb() noexcept = 0;
     virtual bool validateDb() = 0;
 
     QSqlDatabase getDatabase() const;
     bool isDatabaseAvailable() const;
+    QString lastError() const;
+
+    void setErrorHandler(DbErrorHandler handler);
+    void setConfigPrompt(DbConfigPrompt prompt);
+    void reportError(const QString &error) const;
+
+    bool migrateSchema();
+
+    DbConnectionLease leaseConnection(int timeout_ms = -1);
+    bool ping(QString &error);
+    bool checkConnection(QString &error);
+    bool reopenStale(QString &error);
+    bool isStale() const;
+    bool reconnect(QString &error);
+    PoolMetrics poolMetrics() const;
+    void setMaxPoolConnections(int max_connections);
+
+    QSqlQuery preparedQuery(const QString &sql, bool *ok = nullptr);
+    QSqlQuery streamingQuery(const QString &sql, bool *ok = nullptr);
+    StatementCacheStats statementCacheStats() const;
+
+    database::AsyncExecutor *asyncExecutor();
+    database::HealthMonitor *healthMonitor();
+    database::ReferenceCache *referenceCache();
+
+    void setReadReplica(std::shared_ptr<DbManager> replica_ptr);
+    DbManager *readReplica();
 
     DbManager(const DbManager&) = delete;
     DbManager &operator= (const DbManager&) = delete;
@@ -25,8 +69,24 @@ protected:
     QString m_last_error;
 
     bool m_available;
+    bool m_main_stale;              //main connection failed check, waits for reopenStale()
+    QThread *m_owner_thread_ptr;
+
+    bool promptConfig(const QString &var_name, QVariant &var) const;
 
     virtual bool badConfigHandler() noexcept = 0;
+    virtual bool addConnection(const QString &connection_name, QString &error) noexcept = 0;
+
+private:
+    std::unique_ptr<DbConnectionPool> m_pool_ptr;
+    std::shared_ptr<StatementCache> m_statement_cache_ptr;   //cache of main connection
+    std::unique_ptr<database::AsyncExecutor> m_executor_ptr;
+    std::unique_ptr<database::HealthMonitor> m_monitor_ptr;
+    std::unique_ptr<database::ReferenceCache> m_reference_cache_ptr;
+    std::shared_ptr<DbManager> m_replica_ptr;
+
+    DbErrorHandler m_error_handler;
+    DbConfigPrompt m_config_prompt;
 };
 
 
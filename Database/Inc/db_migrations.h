@@ -0,0 +1,45 @@
+#ifndef DB_MIGRATIONS_H
+#define DB_MIGRATIONS_H
+
+#include <vector>
+
+#include <QSqlDatabase>
+#include <QString>
+#include <QStringList>
+
+
+struct IndexSpec
+{
+    QString name;
+    QString table;
+    QStringList columns;
+};
+
+
+struct Migration
+{
+    int version;
+    QString description;
+
+    std::vector<IndexSpec> indexes;
+    QStringList statements;     //SQL common for SQLite and MySQL, run after indexes
+    QStringList tracked_tables; //MySQL only - updated_at column for incremental sync of replicas
+    bool substrate_search;      //full-text index of substrate names (FTS5 on SQLite, FULLTEXT on MySQL)
+};
+
+
+namespace schema{
+    const std::vector<Migration> &migrations();
+    int latestVersion();
+
+    int currentVersion(QSqlDatabase &db, QString &error);
+    bool isUpToDate(QSqlDatabase &db, QString &error);
+    bool migrate(QSqlDatabase &db, QString &error);
+
+    extern const char *const change_tracking_column;
+    extern const char *const substrate_search_table;
+    extern const char *const substrate_search_index;
+
+}//namespace schema
+
+#endif // DB_MIGRATIONS_H
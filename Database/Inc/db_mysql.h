@@ -26,6 +26,7 @@ private:
     ConfigMySQL m_config;
 
     bool badConfigHandler() noexcept override;
+    bool addConnection(const QString &connection_name, QString &error) noexcept override;
 };
 
 #endif // DB_MYSQL_H
@@ -0,0 +1,61 @@
+#ifndef DB_PAGING_H
+#define DB_PAGING_H
+
+#include <QString>
+#include <QVariant>
+#include <QVector>
+
+#include "Database/Inc/db_async.h"
+
+
+namespace database{
+
+    struct KeysetColumn
+    {
+        QString expression;     //column used in WHERE and ORDER BY (e.g. "serviceID")
+        int position;           //position of column in rows of result
+    };
+
+
+    /*
+     * Cursor of keyset pagination
+     *
+     * Page is read with "WHERE (keys) > (keys of last row) ORDER BY keys LIMIT n",
+     * so with index on keys each page costs the same no matter how deep in
+     * table it is (OFFSET would read and skip all previous rows).
+     * Keys have to identify row uniquely (last key is usually primary key).
+     */
+    class KeysetPager
+    {
+    public:
+        KeysetPager();
+        KeysetPager(const QString &select,
+                    const QString &filter,
+                    const QVariantMap &binds,
+                    const QVector<KeysetColumn> &keys,
+                    int page_rows);
+
+        QString pageSql() const;
+        QVariantMap pageBinds() const;
+
+        void advance(const QueryResult &page);
+        void reset();
+
+        bool isValid() const;
+        bool atEnd() const;
+        int pageRows() const;
+
+    private:
+        QString m_select;
+        QString m_filter;
+        QVariantMap m_binds;
+        QVector<KeysetColumn> m_keys;
+        int m_page_rows;
+
+        QVector<QVariant> m_last_keys;  //keys of last row read (empty before first page)
+        bool m_at_end;
+    };
+
+}//namespace database
+
+#endif // DB_PAGING_H
@@ -0,0 +1,121 @@
+#ifndef DB_POOL_H
+#define DB_POOL_H
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include <QMetaObject>
+#include <QMutex>
+#include <QSqlDatabase>
+#include <QString>
+#include <QThread>
+#include <QWaitCondition>
+
+#include "Database/Inc/db_statement_cache.h"
+
+
+struct PoolMetrics
+{
+    int max_connections;
+    int open_connections;
+    int leased_connections;
+    int idle_connections;
+
+    unsigned long long leases_total;
+    unsigned long long waits_total;
+    unsigned long long lease_failures;
+    unsigned long long connections_created;
+    unsigned long long connections_evicted;
+};
+
+
+class DbConnectionPool;
+
+class DbConnectionLease
+{
+public:
+    DbConnectionLease();
+    DbConnectionLease(DbConnectionPool *pool_ptr, const QString &connection_name);
+    ~DbConnectionLease();
+
+    DbConnectionLease(DbConnectionLease &&other) noexcept;
+    DbConnectionLease &operator= (DbConnectionLease &&other) noexcept;
+
+    DbConnectionLease(const DbConnectionLease&) = delete;
+    DbConnectionLease &operator= (const DbConnectionLease&) = delete;
+
+    bool isValid() const;
+    QString connectionName() const;
+    QSqlDatabase database() const;
+
+    void release();
+
+private:
+    DbConnectionPool *m_pool_ptr;
+    QString m_connection_name;
+};
+
+
+class DbConnectionPool
+{
+public:
+    typedef std::function<bool(const QString &connection_name, QString &error)> ConnectionFactory;
+
+    DbConnectionPool(const QString &name_prefix,
+                     ConnectionFactory factory,
+                     int max_connections = 4);
+    ~DbConnectionPool();
+
+    DbConnectionLease lease(int timeout_ms = -1);
+    bool reconnectCurrentThread(QString &error);
+
+    QString connectionForCurrentThread() const;
+    std::shared_ptr<StatementCache> statementCacheForCurrentThread() const;
+    StatementCacheStats statementCacheStats() const;
+    QString lastError() const;
+    PoolMetrics metrics() const;
+
+    void setMaxConnections(int max_connections);
+    void clear();
+
+    DbConnectionPool(const DbConnectionPool&) = delete;
+    DbConnectionPool &operator= (const DbConnectionPool&) = delete;
+
+private:
+    friend class DbConnectionLease;
+
+    // Connection is closed only by thread that owns it - evicted entry is marked
+    // stale and closed by its owner (on next lease, release or when thread finishes)
+    struct Entry
+    {
+        unsigned long long thread_id;
+        QThread *thread_ptr;
+        QString connection_name;
+        int lease_count;
+        std::shared_ptr<StatementCache> statement_cache_ptr;
+        bool stale;                             //evicted, doesn't take slot of pool
+        QMetaObject::Connection finished_hook;  //closes connection when owner thread finishes
+    };
+
+    QString m_name_prefix;
+    ConnectionFactory m_factory;
+    int m_max_connections;
+
+    unsigned long long m_serial;
+    std::vector<Entry> m_entries;
+    QString m_last_error;
+    PoolMetrics m_metrics;
+
+    mutable QMutex m_mutex;
+    QWaitCondition m_slot_freed;
+
+    void mRelease(const QString &connection_name);
+    bool mEvictIdleEntry();
+    int mActiveCount() const;
+    void mCloseThreadEntry(unsigned long long thread_id);
+    void mRemoveConnection(Entry &entry);
+    std::vector<Entry>::iterator mFindEntry(unsigned long long thread_id);
+};
+
+#endif // DB_POOL_H
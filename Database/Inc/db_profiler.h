@@ -0,0 +1,76 @@
+#ifndef DB_PROFILER_H
+#define DB_PROFILER_H
+
+#include <array>
+#include <vector>
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QMutex>
+#include <QString>
+#include <QStringList>
+
+
+struct StatementStats
+{
+    static const int histogram_buckets = 24;
+
+    QString sql;
+    unsigned long long count;
+    unsigned long long rows;       //sum of rows returned/affected of executions where it's known
+    unsigned long long rows_unknown;    //executions with unknown count of rows (e.g. SELECT on SQLite before fetching)
+    qint64 total_ns;
+    qint64 max_ns;
+
+    //bucket i counts executions that took less than 2^i microseconds (last - the rest)
+    std::array<unsigned long long, histogram_buckets> histogram;
+
+    double percentileMs(double fraction) const;
+};
+
+
+struct SlowLogConfig
+{
+    QString file_path;
+    qint64 threshold_ms;
+    qint64 max_file_size;   //bytes, file is rotated when exceeded
+    int max_files;          //count of rotated files kept (file.1 ... file.N)
+};
+
+
+class QueryProfiler
+{
+public:
+    static QueryProfiler &instance();
+
+    void record(const QString &sql,
+                qint64 elapsed_ns,
+                int rows,
+                const QStringList &bound_names);
+
+    std::vector<StatementStats> topByTotalTime(int count) const;
+    void reset();
+
+    qint64 msecsSinceLastQuery() const;
+    static void markBackgroundThread();
+
+    SlowLogConfig slowLog() const;
+    void setSlowLog(const SlowLogConfig &config);
+
+    QueryProfiler(const QueryProfiler&) = delete;
+    QueryProfiler &operator= (const QueryProfiler&) = delete;
+
+private:
+    QueryProfiler();
+
+    mutable QMutex m_mutex;
+    QMutex m_log_mutex;                 //serializes writes of slow query log (taken without m_mutex)
+    QHash<QString, StatementStats> m_stats;
+    SlowLogConfig m_slow_log;
+    QElapsedTimer m_activity_timer;     //restarted on every recorded statement
+
+    void mAppendSlowLog(const SlowLogConfig &config, const QString &line);
+    void mRotateSlowLog(const SlowLogConfig &config);
+};
+
+#endif // DB_PROFILER_H
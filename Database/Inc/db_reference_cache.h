@@ -0,0 +1,86 @@
+#ifndef DB_REFERENCE_CACHE_H
+#define DB_REFERENCE_CACHE_H
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QObject>
+#include <QPair>
+
+#include "Database/Inc/db_async.h"
+#include "Database/Inc/db_paging.h"
+
+class DbManager;
+
+
+namespace database{
+
+    enum class ReferenceData
+    {
+        Plants,         //plants owned by user (rows of schema::Plant)
+        Substrates      //public substrates and substrates owned by user (rows of schema::Substrate)
+    };
+
+
+    QString referenceFilter(ReferenceData data);
+    KeysetPager referencePager(ReferenceData data, unsigned int user_id, int page_rows);
+
+
+    struct ReferenceCacheStats
+    {
+        unsigned long long hits;
+        unsigned long long misses;
+        unsigned long long expired;
+        int size;
+    };
+
+
+    class ReferenceCache
+    {
+    public:
+        explicit ReferenceCache(DbManager *db_ptr, int ttl_ms = 5 * 60 * 1000);
+
+        QueryResult fetchNow(ReferenceData data, unsigned int user_id);
+        QueryHandle fetch(ReferenceData data,
+                          unsigned int user_id,
+                          QObject *context_ptr,
+                          QueryCallback on_finished);
+        void fetchParallel(ReferenceData data,
+                           unsigned int user_id,
+                           QObject *context_ptr,
+                           QueryCallback on_finished);
+
+        void invalidate(ReferenceData data, unsigned int user_id);
+        void invalidateUser(unsigned int user_id);
+        void clear();
+
+        void setTtl(int ttl_ms);
+        ReferenceCacheStats stats() const;
+
+        ReferenceCache(const ReferenceCache&) = delete;
+        ReferenceCache &operator= (const ReferenceCache&) = delete;
+
+    private:
+        typedef QPair<int, unsigned int> Key;   //kind of data and user
+
+        struct Entry
+        {
+            QueryResult result;
+            QElapsedTimer age;
+            quint64 generation;     //invalidation while query runs makes result stale
+        };
+
+        DbManager *m_db_ptr;
+        int m_ttl_ms;
+
+        QHash<Key, Entry> m_entries;
+        QHash<Key, quint64> m_generations;
+        ReferenceCacheStats m_stats;
+
+        bool mLookup(const Key &key, QueryResult &result);
+        void mStore(const Key &key, const QueryResult &result, quint64 generation);
+        quint64 mGeneration(const Key &key) const;
+    };
+
+}//namespace database
+
+#endif // DB_REFERENCE_CACHE_H
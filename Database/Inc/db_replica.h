@@ -0,0 +1,100 @@
+#ifndef DB_REPLICA_H
+#define DB_REPLICA_H
+
+#include <memory>
+
+#include <QDateTime>
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QThread>
+#include <QTimer>
+
+#include "Database/Inc/database.h"
+
+
+namespace database{
+
+    struct ReplicaConfig
+    {
+        int sync_interval_ms;       //period of incremental pulls
+        int reconcile_every;        //every N-th sync compares primary keys to remove deleted rows
+        int cursor_overlap_ms;      //rows changed that long before last cursor are pulled again
+        int chunk_rows;             //rows written to mirror in one transaction
+    };
+
+    ReplicaConfig defaultReplicaConfig();
+    const QStringList &replicaTables();
+
+
+    struct ReplicaSyncStats
+    {
+        bool ok;
+        QString error;
+
+        int rows_upserted;
+        int rows_deleted;
+        QStringList changed_tables;
+
+        qint64 elapsed_ns;
+        QDateTime finished_at;
+    };
+
+
+    class ReplicaSync final: public QObject
+    {
+        Q_OBJECT
+
+    public:
+        ReplicaSync(DbSQL primary_ptr, DbSQL mirror_ptr, const ReplicaConfig &config);
+        ~ReplicaSync();
+
+        void start();
+        void stop();
+        void syncNow();
+
+        bool isReady() const;
+        ReplicaSyncStats lastSync() const;
+
+        ReplicaSync(const ReplicaSync&) = delete;
+        ReplicaSync &operator= (const ReplicaSync&) = delete;
+
+    signals:
+        void synced(int rows_upserted, int rows_deleted);
+        void syncFailed(const QString &error);
+
+    private:
+        DbSQL m_primary_ptr;
+        DbSQL m_mirror_ptr;
+        ReplicaConfig m_config;
+
+        bool m_is_ready;
+        bool m_is_sync_pending;
+        int m_sync_count;
+        ReplicaSyncStats m_last_sync;
+
+        QTimer m_timer;
+        QThread m_thread;
+        std::unique_ptr<QObject> m_worker_ptr;
+
+        //used only from worker thread
+        DbConnectionLease m_primary_lease;
+        DbConnectionLease m_mirror_lease;
+
+        void mSchedule();
+        ReplicaSyncStats mSync(bool reconcile);
+        bool mSyncTable(QSqlDatabase &primary,
+                        QSqlDatabase &mirror,
+                        const QString &table,
+                        bool reconcile,
+                        ReplicaSyncStats &stats);
+        void mOnSyncFinished(const ReplicaSyncStats &stats);
+    };
+
+    std::unique_ptr<ReplicaSync> createSQLiteReplica(DbSQL primary_ptr,
+                                                     const QString &path,
+                                                     const QString &filename);
+
+}//namespace database
+
+#endif // DB_REPLICA_H
@@ -0,0 +1,218 @@
+#ifndef DB_SCHEMA_H
+#define DB_SCHEMA_H
+
+#include <QDate>
+#include <QString>
+#include <QStringList>
+#include <QVariant>
+
+
+/*
+ * Descriptors of projections of biogas_server_* tables read by application
+ *
+ * Each descriptor gives table, its projected columns (position in SELECT is
+ * value of Column enum) and plain struct that row is decoded to. Queries are
+ * built from descriptors (see schema::selectFrom), so code reading rows by
+ * Column values can't drift from SQL - changed projection has to change enum,
+ * array of names and decode() together, otherwise build fails.
+ */
+namespace schema{
+
+    constexpr bool hasNames(const char *const *columns, int count)
+    {
+        return count == 0 || (columns[0] != nullptr && hasNames(columns + 1, count - 1));
+    }
+
+    struct Profile
+    {
+        static constexpr const char *table = "biogas_server_user";
+
+        enum Column {Name, Surname, Email, ColumnCount};
+        static constexpr const char *columns[ColumnCount] = {"name", "surname", "email"};
+
+        struct Row
+        {
+            QString name;
+            QString surname;
+            QString email;
+        };
+
+        template<typename Record>
+        static Row decode(const Record &record)
+        {
+            return Row{record.value(Name).toString(),
+                       record.value(Surname).toString(),
+                       record.value(Email).toString()};
+        }
+    };
+
+    struct Address
+    {
+        static constexpr const char *table = "biogas_server_corespondanceaddres";
+
+        enum Column {City, Street, Number, PostalCode, Country, ColumnCount};
+        static constexpr const char *columns[ColumnCount] = {"city", "street", "number", "postalCode", "country"};
+
+        struct Row
+        {
+            QString city;
+            QString street;
+            QString number;
+            QString postal_code;
+            QString country;
+        };
+
+        template<typename Record>
+        static Row decode(const Record &record)
+        {
+            return Row{record.value(City).toString(),
+                       record.value(Street).toString(),
+                       record.value(Number).toString(),
+                       record.value(PostalCode).toString(),
+                       record.value(Country).toString()};
+        }
+    };
+
+    struct Phone
+    {
+        static constexpr const char *table = "biogas_server_phonenumber";
+
+        enum Column {Id, Number, Owner, ColumnCount};
+        static constexpr const char *columns[ColumnCount] = {"phoneID", "phoneNumber", "owner_id"};
+
+        struct Row
+        {
+            qlonglong id;
+            QString number;
+            qlonglong owner_id;
+        };
+
+        template<typename Record>
+        static Row decode(const Record &record)
+        {
+            return Row{record.value(Id).toLongLong(),
+                       record.value(Number).toString(),
+                       record.value(Owner).toLongLong()};
+        }
+    };
+
+    struct Plant
+    {
+        static constexpr const char *table = "biogas_server_plant";
+
+        enum Column {Id, Location, ColumnCount};
+        static constexpr const char *columns[ColumnCount] = {"PlantID", "location"};
+
+        struct Row
+        {
+            qlonglong id;
+            QString location;
+        };
+
+        template<typename Record>
+        static Row decode(const Record &record)
+        {
+            return Row{record.value(Id).toLongLong(),
+                       record.value(Location).toString()};
+        }
+    };
+
+    struct Substrate
+    {
+        static constexpr const char *table = "biogas_server_substrate";
+
+        enum Column {Id, Name, Ots, Biogas, Methane, ColumnCount};
+        static constexpr const char *columns[ColumnCount] = {"substrateID", "name", "ots", "biogas", "methane"};
+
+        struct Row
+        {
+            qlonglong id;
+            QString name;
+            double ots;         //organic dry matter [% of TS]
+            double biogas;      //biogas yield of oTS
+            double methane;     //methane yield of oTS
+        };
+
+        template<typename Record>
+        static Row decode(const Record &record)
+        {
+            return Row{record.value(Id).toLongLong(),
+                       record.value(Name).toString(),
+                       record.value(Ots).toDouble(),
+                       record.value(Biogas).toDouble(),
+                       record.value(Methane).toDouble()};
+        }
+    };
+
+    struct Service
+    {
+        static constexpr const char *table = "biogas_server_service";
+
+        enum Column {Date, Title, Description, Done, Notice, Id, ColumnCount};
+        static constexpr const char *columns[ColumnCount] = {"date", "title", "description", "done", "notice", "serviceID"};
+
+        struct Row
+        {
+            QDate date;
+            QString title;
+            QString description;
+            bool done;
+            QString notice;
+            qlonglong id;
+        };
+
+        template<typename Record>
+        static Row decode(const Record &record)
+        {
+            return Row{record.value(Date).toDate(),
+                       record.value(Title).toString(),
+                       record.value(Description).toString(),
+                       record.value(Done).toBool(),
+                       record.value(Notice).toString(),
+                       record.value(Id).toLongLong()};
+        }
+    };
+
+    static_assert(hasNames(Profile::columns, Profile::ColumnCount), "Profile: every column needs name");
+    static_assert(hasNames(Address::columns, Address::ColumnCount), "Address: every column needs name");
+    static_assert(hasNames(Phone::columns, Phone::ColumnCount), "Phone: every column needs name");
+    static_assert(hasNames(Plant::columns, Plant::ColumnCount), "Plant: every column needs name");
+    static_assert(hasNames(Substrate::columns, Substrate::ColumnCount), "Substrate: every column needs name");
+    static_assert(hasNames(Service::columns, Service::ColumnCount), "Service: every column needs name");
+
+    /**
+     * Gives list of projected columns of descriptor, in order of its Column enum
+     *
+     * @param alias - alias of table used in query (empty if there's none)
+     * @return columns separated with comma (e.g. "s.substrateID, s.name")
+     */
+    template<typename Descriptor>
+    QString projection(const QString &alias = QString())
+    {
+        QStringList columns;
+
+        for(int column = 0; column < Descriptor::ColumnCount; column++)
+        {
+            columns.append(alias.isEmpty() ? QString(Descriptor::columns[column])
+                                           : alias + '.' + Descriptor::columns[column]);
+        }
+
+        return columns.join(", ");
+    }
+
+    /**
+     * Gives beginning of SELECT of descriptor (conditions are added by caller)
+     *
+     * @param alias - alias of table used in query (empty if there's none)
+     * @return e.g. "SELECT s.substrateID, ... FROM biogas_server_substrate AS s"
+     */
+    template<typename Descriptor>
+    QString selectFrom(const QString &alias = QString())
+    {
+        return "SELECT " + projection<Descriptor>(alias) + " FROM " + Descriptor::table
+                + (alias.isEmpty() ? QString() : " AS " + alias);
+    }
+
+}//namespace schema
+
+#endif // DB_SCHEMA_H
@@ -0,0 +1,69 @@
+#ifndef DB_SEARCH_H
+#define DB_SEARCH_H
+
+#include <QString>
+#include <QVariant>
+#include <QVector>
+
+#include "Database/Inc/database.h"
+
+
+namespace database{
+
+    enum class SearchBackend
+    {
+        FullText,       //FTS5 table (SQLite) or FULLTEXT index (MySQL), see schema::substrate_search_table
+        Memory          //catalog of user from ReferenceCache scanned in GUI thread
+    };
+
+
+    QString substrateSearchSql(const QSqlDatabase &db,
+                               const QString &text,
+                               unsigned int user_id,
+                               int limit,
+                               QVariantMap &binds);
+
+
+    /*
+     * As-you-type search of substrates available to user (rows of schema::Substrate)
+     *
+     * Matches are ranked - by bm25 (SQLite) or relevance (MySQL) of full-text
+     * index, in memory by position of match in name. Every word of text
+     * has to match beginning of word of name ("ma si" matches "Maize silage").
+     * Index is detected (in database worker thread) on first search of each searched
+     * database - replica attached later is detected again. Database without index
+     * is searched in memory.
+     */
+    class SubstrateSearch
+    {
+    public:
+        SubstrateSearch(DbSQL db_ptr, unsigned int user_id, int limit = 50);
+
+        QueryHandle search(const QString &text,
+                           QObject *context_ptr,
+                           QueryCallback on_finished);
+
+        SearchBackend backend() const;
+
+    private:
+        DbSQL m_db_ptr;
+        unsigned int m_user_id;
+        int m_limit;
+
+        DbManager *m_detected_ptr;  //database that backend was detected for (nullptr - none yet)
+        SearchBackend m_backend;
+
+        QueryResult m_catalog;      //memory backend only
+        QVector<QString> m_names;   //folded names of rows of catalog
+
+        QueryHandle mDetectBackend(DbManager *searched_ptr,
+                                   const QString &text,
+                                   QObject *context_ptr,
+                                   QueryCallback on_finished);
+        bool mLoadCatalog(QString &error);
+        QueryResult mSearchMemory(const QStringList &words);
+    };
+
+}//namespace database
+
+#endif // DB_SEARCH_H
@@ -0,0 +1,35 @@
+#ifndef DB_SESSION_H
+#define DB_SESSION_H
+
+#include <functional>
+
+#include "Database/Inc/database.h"
+
+
+namespace database{
+
+    struct SessionData
+    {
+        unsigned int user_id;
+
+        QueryResult profile;        //rows of schema::Profile
+        QueryResult address;        //rows of schema::Address
+        QueryResult phones;         //rows of schema::Phone
+        QueryResult plants;         //as ReferenceData::Plants
+        QueryResult substrates;     //as ReferenceData::Substrates
+
+        SessionData();
+
+        bool isComplete() const;
+    };
+
+    typedef std::function<void(const SessionData &session)> SessionCallback;
+
+    void bootstrapSession(DbSQL &db_ptr,
+                          unsigned int user_id,
+                          QObject *context_ptr,
+                          SessionCallback on_ready);
+
+}//namespace database
+
+#endif // DB_SESSION_H
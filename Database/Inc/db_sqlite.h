@@ -4,13 +4,44 @@
 #include "Database/Inc/db_manager.h"
 
 
+enum class SQLiteProfile
+{
+    Kiosk,      //read-heavy (default)
+    Ingest,     //write-heavy, durability traded for speed
+    Durable     //every commit synced to disk
+};
+
+
+struct SQLitePragmas
+{
+    QString journal_mode;
+    QString synchronous;
+    qint64 mmap_size;       //bytes
+    int cache_size;         //negative value is size in KiB, positive - in pages
+    QString temp_store;
+    int busy_timeout;       //ms
+};
+
+
 struct ConfigSQLite
 {
     QString db_name;
     QString db_path;
+    SQLiteProfile profile;
 };
 
 
+namespace sqlite_profile{
+    SQLitePragmas pragmas(SQLiteProfile profile);
+    QString name(SQLiteProfile profile);
+
+    bool apply(QSqlDatabase &db,
+               const SQLitePragmas &pragmas,
+               QString &error);
+
+}//namespace sqlite_profile
+
+
 class DbSQLite final: public DbManager
 {
 public:
@@ -23,6 +54,7 @@ private:
     ConfigSQLite m_config;
 
     bool badConfigHandler() noexcept override;
+    bool addConnection(const QString &connection_name, QString &error) noexcept override;
 };
 
 #endif // DBSQLITE_H
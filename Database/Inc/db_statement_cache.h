@@ -0,0 +1,59 @@
+#ifndef DB_STATEMENT_CACHE_H
+#define DB_STATEMENT_CACHE_H
+
+#include <atomic>
+#include <list>
+
+#include <QHash>
+#include <QSqlQuery>
+#include <QString>
+
+
+struct StatementCacheStats
+{
+    unsigned long long hits;
+    unsigned long long misses;
+    unsigned long long evictions;
+
+    int size;
+    int capacity;
+};
+
+
+class StatementCache
+{
+public:
+    explicit StatementCache(const QString &connection_name, int capacity = 32);
+    ~StatementCache();
+
+    QSqlQuery prepared(const QString &sql, bool *ok = nullptr);
+
+    StatementCacheStats stats() const;
+    void setCapacity(int capacity);
+    void clear();
+
+    StatementCache(const StatementCache&) = delete;
+    StatementCache &operator= (const StatementCache&) = delete;
+
+private:
+    struct Entry
+    {
+        QString sql;
+        QSqlQuery qry;
+    };
+
+    QString m_connection_name;
+    std::atomic<int> m_capacity;
+
+    std::list<Entry> m_lru;     //most recently used first
+    QHash<QString, std::list<Entry>::iterator> m_index;
+
+    std::atomic<unsigned long long> m_hits;
+    std::atomic<unsigned long long> m_misses;
+    std::atomic<unsigned long long> m_evictions;
+    std::atomic<int> m_size;
+
+    void mEvictOverCapacity();
+};
+
+#endif // DB_STATEMENT_CACHE_H
@@ -2,9 +2,15 @@
 
 #include "Database/Inc/db_sqlite.h"
 #include "Database/Inc/db_mysql.h"
+#include "Database/Inc/db_profiler.h"
+#include "Database/Inc/db_health.h"
 
 #include "Misc/Inc/validators.h"
-#include <QMessageBox>
+#include <QElapsedTimer>
+#include <QFutureWatcher>
+#include <QSqlError>
+#include <QSqlRecord>
+#include <QtConcurrent/QtConcurrentRun>
 
 using namespace validator;
 
@@ -14,12 +20,14 @@ namespace database {
      *
      * @param path - absolute path to db file
      * @param filename - name of db file
+     * @param profile - performance profile (pragmas applied on opening connections)
      * @return new instance of SQLite Database as smart pointer (unique)
      */
     DbSQL createSQLiteDatabase(const QString &path,
-                               const QString &filename)
+                               const QString &filename,
+                               SQLiteProfile profile)
     {
-        ConfigSQLite config{filename, path};
+        ConfigSQLite config{filename, path, profile};
 
         return DbSQL(new DbSQLite(config));
     }
@@ -46,23 +54,40 @@ namespace database {
 
     /**
      * Checks if connection is still open
-     * if it's not - tries to reconnect
+     *
+     * If health monitor is running - its state is used and nothing blocks GUI
+     * (lost connection is being reopened in background).
+     * Otherwise - tries to reconnect synchronously
      *
      * @param db_ptr - pointer to database
      * @return true if connection is open or reopened
-     * if unavailable - false and throws window with critical message
+     * if unavailable - false and error is passed to error handler of database
      */
     bool isConnEstablished(DbSQL &db_ptr)
     {
         if (db_ptr && db_ptr->isDatabaseAvailable())
         {
+            auto monitor_ptr = db_ptr->healthMonitor();
+
+            if (monitor_ptr->isRunning())
+            {
+                if (monitor_ptr->state() != ConnectionState::Connected)
+                {
+                    monitor_ptr->checkNow();
+
+                    db_ptr->reportError(QObject::tr("Connection with database has been lost - reconnecting in background.\n"
+                                                    "Please try again in a moment"));
+                    return false;
+                }
+
+                return true;
+            }
+
             if(!db_ptr->getDatabase().isOpen()) //sometimes connection might be lost
             {
                 if (!db_ptr->getDatabase().open() )
                 {
-                    QMessageBox::critical(nullptr,
-                                          "Connection Error",
-                                          "Failed to connect with database - please try again later");
+                    db_ptr->reportError(QObject::tr("Failed to connect with database - please try again later"));
                 }
             }
 
@@ -71,6 +96,273 @@ namespace database {
         return false;
     }
 
+    /**
+     * Executes query in database worker thread, so GUI is not blocked
+     *
+     * @param db_ptr - pointer to database
+     * @param sql - SQL statement with named placeholders
+     * @param binds - values for placeholders (key is placeholder e.g. ":user")
+     * @param context_ptr - object that callback belongs to (usually window calling it),
+     * if it's destroyed before query ends - callback is not called
+     * @param on_finished - callback called in GUI thread with result of query
+     * @return handle that allows to cancel query
+     * (empty handle if database is unavailable - callback gets failed result then)
+     */
+    QueryHandle execAsync(DbSQL &db_ptr,
+                          const QString &sql,
+                          const QVariantMap &binds,
+                          QObject *context_ptr,
+                          QueryCallback on_finished)
+    {
+        if (!(db_ptr && db_ptr->isDatabaseAvailable()))
+        {
+            QueryResult result;
+            result.error = QObject::tr("Database not initialized or could't be opened");
+
+            if (on_finished)
+            {
+                on_finished(result);
+            }
+
+            return QueryHandle();
+        }
+
+        return db_ptr->asyncExecutor()->submit(sql, binds, context_ptr, on_finished);
+    }
+
+    /**
+     * Executes read-only query of mirrored tables in database worker thread
+     * If local replica is attached (see ReplicaSync) - it's served from replica,
+     * otherwise from database itself
+     *
+     * Note: Only for SELECT of plants, containers, substrates, substrate owners and services
+     *
+     * @param db_ptr - pointer to database
+     * @param sql - SQL statement with named placeholders
+     * @param binds - values for placeholders (key is placeholder e.g. ":user")
+     * @param context_ptr - object that callback belongs to (usually window calling it)
+     * @param on_finished - callback called in GUI thread with result of query
+     * @return handle that allows to cancel query
+     */
+    QueryHandle execReadAsync(DbSQL &db_ptr,
+                              const QString &sql,
+                              const QVariantMap &binds,
+                              QObject *context_ptr,
+                              QueryCallback on_finished)
+    {
+        if (!(db_ptr && db_ptr->isDatabaseAvailable()))
+        {
+            return execAsync(db_ptr, sql, binds, context_ptr, on_finished);
+        }
+
+        return db_ptr->readReplica()->asyncExecutor()->submit(sql, binds, context_ptr, on_finished);
+    }
+
+    /**
+     * Executes SELECT in database worker thread and delivers its rows in chunks
+     * - for results too large to be converted and displayed at once.
+     * Like execReadAsync - it's served from local replica if one is attached
+     *
+     * @param db_ptr - pointer to database
+     * @param sql - SQL statement with named placeholders
+     * @param binds - values for placeholders (key is placeholder e.g. ":user")
+     * @param chunk_rows - maximal number of rows in one chunk
+     * @param context_ptr - object that callbacks belong to (usually window calling it)
+     * @param on_chunk - callback called in GUI thread with each chunk of rows
+     * @param on_finished - callback called in GUI thread when query ends
+     * (without rows - rows_affected is number of streamed rows)
+     * @return handle that allows to cancel query (also between chunks)
+     */
+    QueryHandle execStreamAsync(DbSQL &db_ptr,
+                                const QString &sql,
+                                const QVariantMap &binds,
+                                int chunk_rows,
+                                QObject *context_ptr,
+                                QueryCallback on_chunk,
+                                QueryCallback on_finished)
+    {
+        if (!(db_ptr && db_ptr->isDatabaseAvailable()))
+        {
+            QueryResult result;
+            result.error = QObject::tr("Database not initialized or could't be opened");
+
+            if (on_finished)
+            {
+                on_finished(result);
+            }
+
+            return QueryHandle();
+        }
+
+        return db_ptr->readReplica()->asyncExecutor()->submitStream(sql,
+                                                                    binds,
+                                                                    chunk_rows,
+                                                                    context_ptr,
+                                                                    on_chunk,
+                                                                    on_finished);
+    }
+
+    /**
+     * Executes batch of writes in database worker thread as one transaction
+     *
+     * @param db_ptr - pointer to database
+     * @param batch - statements with parameter sets (see qry_helper::BatchWriter)
+     * @param context_ptr - object that callback belongs to (usually window calling it),
+     * if it's destroyed before batch ends - callback is not called
+     * @param on_finished - callback called in GUI thread (rows_affected is set)
+     * @return handle that allows to cancel batch before it starts
+     */
+    QueryHandle execBatchAsync(DbSQL &db_ptr,
+                               const qry_helper::BatchWriter &batch,
+                               QObject *context_ptr,
+                               QueryCallback on_finished)
+    {
+        if (!(db_ptr && db_ptr->isDatabaseAvailable()))
+        {
+            QueryResult result;
+            result.error = QObject::tr("Database not initialized or could't be opened");
+
+            if (on_finished)
+            {
+                on_finished(result);
+            }
+
+            return QueryHandle();
+        }
+
+        return db_ptr->asyncExecutor()->submitBatch(batch, context_ptr, on_finished);
+    }
+
+    /**
+     * Executes query with connection leased from pool for calling thread
+     * and reads all its rows (blocks until query ends)
+     *
+     * Note: For threads other than GUI thread (see execParallel) - each of them
+     * gets its own pooled connection, so queries run side by side
+     *
+     * @param db_ptr - database that leases connection
+     * @param sql - SQL statement with named placeholders
+     * @param binds - values for placeholders (key is placeholder e.g. ":user")
+     * @return result of query (result.ok is false if it failed)
+     */
+    QueryResult execLeased(DbManager *db_ptr,
+                           const QString &sql,
+                           const QVariantMap &binds)
+    {
+        QueryResult result;
+        DbConnectionLease lease(db_ptr->leaseConnection());
+
+        if (!lease.isValid())
+        {
+            result.error = QObject::tr("No database connection available for background query");
+            return result;
+        }
+
+        bool is_prepared(false);
+        QSqlQuery qry(db_ptr->preparedQuery(sql, &is_prepared));
+
+        if (!is_prepared)
+        {
+            result.error = qry.lastError().text();
+            return result;
+        }
+
+        for (auto bind = binds.cbegin(); bind != binds.cend(); ++bind)
+        {
+            qry.bindValue(bind.key(), bind.value());
+        }
+
+        QElapsedTimer timer;
+        timer.start();
+
+        if (!qry.exec())
+        {
+            result.error = qry.lastError().text();
+            return result;
+        }
+
+        QSqlRecord record(qry.record());
+
+        for (int column = 0; column < record.count(); column++)
+        {
+            result.columns.append(record.fieldName(column));
+        }
+
+        while (qry.next())
+        {
+            QVector<QVariant> row(record.count());
+
+            for (int column = 0; column < record.count(); column++)
+            {
+                row[column] = qry.value(column);
+            }
+
+            result.rows.append(row);
+        }
+
+        result.rows_affected = qry.numRowsAffected();
+        result.last_insert_id = qry.lastInsertId();
+        result.ok = true;
+
+        // execution with fetching of all rows
+        QueryProfiler::instance().record(sql,
+                                         timer.nsecsElapsed(),
+                                         qry.isSelect() ? result.rows.size() : result.rows_affected,
+                                         binds.keys());
+        qry.finish();
+
+        return result;
+    }
+
+    /**
+     * Executes query in thread of global thread pool (QtConcurrent) with its own
+     * pooled connection - unlike execAsync, queries issued together run at the same
+     * time (as many as free connections of pool allow), not one after another
+     *
+     * @param db_ptr - database that leases connections
+     * @param sql - SQL statement with named placeholders
+     * @param binds - values for placeholders (key is placeholder e.g. ":user")
+     * @param context_ptr - object that callback belongs to,
+     * if it's destroyed before query ends - callback is not called
+     * @param on_finished - callback called in GUI thread with result of query
+     */
+    void execParallel(DbManager *db_ptr,
+                      const QString &sql,
+                      const QVariantMap &binds,
+                      QObject *context_ptr,
+                      QueryCallback on_finished)
+    {
+        if (!(db_ptr && db_ptr->isDatabaseAvailable()))
+        {
+            QueryResult result;
+            result.error = QObject::tr("Database not initialized or could't be opened");
+
+            if (on_finished)
+            {
+                on_finished(result);
+            }
+
+            return;
+        }
+
+        // Watcher is owned by context - it's destroyed (callback dropped) together with it
+        auto watcher_ptr = new QFutureWatcher<QueryResult>(context_ptr);
+
+        QObject::connect(watcher_ptr, &QFutureWatcher<QueryResult>::finished, watcher_ptr,
+                         [watcher_ptr, on_finished]()
+        {
+            if (on_finished)
+            {
+                on_finished(watcher_ptr->result());
+            }
+
+            watcher_ptr->deleteLater();
+        });
+
+        watcher_ptr->setFuture(QtConcurrent::run([db_ptr, sql, binds]()
+                                                 {return execLeased(db_ptr, sql, binds); }));
+    }
+
 } //namespace database
 
 
@@ -94,13 +386,51 @@ namespace qry_helper {
                         const QVariant &bind_value,
                         QSql::ParamType paramType)
     {
-        if (bind_value.isNull() || isEmptyOrWhitespace(bind_value))
-        {
-            qry.bindValue(placeholder, QVariant(), paramType);
-        }
-        else
+        qry.bindValue(placeholder, valueOrNull(bind_value), paramType);
+    }
+
+    /**
+     * Gives value that should be written to database
+     * (same rules as bindValueOrNull - used for parameter sets of BatchWriter)
+     *
+     * @param value - value from form
+     * @return NULL QVariant if value is null, empty or whitespace, otherwise value
+     */
+    QVariant valueOrNull(const QVariant &value)
+    {
+        if (value.isNull() || isEmptyOrWhitespace(value))
         {
-            qry.bindValue(placeholder, bind_value, paramType);
+            return QVariant();
         }
+
+        return value;
+    }
+
+    /**
+     * Executes prepared query and records its latency in QueryProfiler
+     * (statements over threshold are written to slow query log)
+     *
+     * Note: Use it instead of QSqlQuery::exec() so statement shows up in diagnostics.
+     * Rows aren't fetched here - SELECT whose size driver doesn't report
+     * (SQLite, forward-only queries) is recorded with unknown count of rows
+     *
+     * @param qry - prepared query with bound values
+     * @return true if query was executed succesfully
+     */
+    bool exec(QSqlQuery &qry)
+    {
+        QElapsedTimer timer;
+        timer.start();
+
+        bool result(qry.exec());
+
+        qint64 elapsed_ns(timer.nsecsElapsed());
+        int rows(qry.isSelect() ? qry.size() : qry.numRowsAffected());
+
+        QueryProfiler::instance().record(qry.lastQuery(),
+                                         elapsed_ns,
+                                         rows,
+                                         qry.boundValues().keys());
+        return result;
     }
 }//namespace qry_helper
@@ -0,0 +1,576 @@
+#include "Database/Inc/db_async.h"
+#include "Database/Inc/db_manager.h"
+#include "Database/Inc/db_profiler.h"
+
+#include <algorithm>
+
+#include <QElapsedTimer>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QSqlRecord>
+#include <QThread>
+
+
+namespace database {
+
+    QueryResult::QueryResult():
+        ok(false),
+        cancelled(false),
+        error(""),
+        rows_affected(-1)
+    {}
+
+    /**
+     * @return true if query returned no rows
+     */
+    bool QueryResult::isEmpty() const
+    {
+        return rows.isEmpty();
+    }
+
+
+    QueryHandle::QueryHandle():
+        m_state_ptr(nullptr)
+    {}
+
+    /**
+     * Cancels query
+     * If query has not started yet - it will be skipped,
+     * if it's running - fetching rows is stopped.
+     * In both cases callback will not be called
+     */
+    void QueryHandle::cancel()
+    {
+        if(m_state_ptr)
+        {
+            m_state_ptr->cancelled = true;
+            m_state_ptr->wakeStream();
+        }
+    }
+
+    /**
+     * @return true if query has been cancelled
+     */
+    bool QueryHandle::isCancelled() const
+    {
+        return m_state_ptr && m_state_ptr->cancelled;
+    }
+
+    /**
+     * @return true if query is queued or running (not finished nor cancelled)
+     */
+    bool QueryHandle::isPending() const
+    {
+        return m_state_ptr && !m_state_ptr->finished && !m_state_ptr->cancelled;
+    }
+
+
+    /**
+     * Wakes stream waiting for delivery of chunks (see AsyncExecutor::mRunStream),
+     * so it checks number of chunks in flight and cancellation again
+     */
+    void QueryHandle::State::wakeStream()
+    {
+        QMutexLocker locker(&mutex);
+        chunk_delivered.wakeAll();
+    }
+
+
+    /**
+     * Creates executor with dedicated database worker thread
+     *
+     * Note: Executor has to be created in GUI thread - callbacks are delivered there
+     *
+     * @param db_ptr - database that leases connection for worker thread
+     */
+    AsyncExecutor::AsyncExecutor(DbManager *db_ptr):
+        QObject(nullptr),
+        m_db_ptr(db_ptr),
+        m_worker_ptr(new QObject),
+        m_last_task_id(0)
+    {
+        m_thread.setObjectName("DbWorker");
+        m_worker_ptr->moveToThread(&m_thread);
+
+        // finished is emitted from worker thread - lease is returned there
+        QObject::connect(&m_thread,
+                         &QThread::finished,
+                         m_worker_ptr.get(),
+                         [this](){m_worker_lease.release(); },
+                         Qt::DirectConnection);
+
+        m_thread.start();
+    }
+
+    /**
+     * Stops worker thread
+     * Queries waiting in queue are dropped without calling their callbacks
+     */
+    AsyncExecutor::~AsyncExecutor()
+    {
+        for(auto &pending: m_pending)
+        {
+            pending.state_ptr->cancelled = true;
+            pending.state_ptr->wakeStream();
+        }
+
+        m_thread.quit();
+        m_thread.wait();
+    }
+
+    /**
+     * Queues query to be executed in database worker thread
+     *
+     * @param sql - SQL statement with named placeholders
+     * @param binds - values for placeholders (key is placeholder e.g. ":user")
+     * @param context_ptr - object that callback belongs to - if it's destroyed
+     * before query ends, callback is not called
+     * @param on_finished - callback called in GUI thread with result of query
+     * @return handle that allows to cancel query
+     */
+    QueryHandle AsyncExecutor::submit(const QString &sql,
+                                      const QVariantMap &binds,
+                                      QObject *context_ptr,
+                                      QueryCallback on_finished)
+    {
+        quint64 task_id(0);
+        QueryHandle handle(mRegister(context_ptr, on_finished, task_id));
+        auto state_ptr(handle.m_state_ptr);
+
+        QMetaObject::invokeMethod(m_worker_ptr.get(),
+                                  [this, task_id, sql, binds, state_ptr]()
+                                  {mRun(task_id, sql, binds, state_ptr); },
+                                  Qt::QueuedConnection);
+
+        return handle;
+    }
+
+    /**
+     * Queues query which rows are delivered in chunks as they are fetched
+     * Neither worker nor GUI holds whole result - memory depends on chunk size only
+     *
+     * @param sql - SQL statement with named placeholders
+     * @param binds - values for placeholders (key is placeholder e.g. ":user")
+     * @param chunk_rows - maximal count of rows in one chunk
+     * @param context_ptr - object that callbacks belong to - if it's destroyed
+     * before query ends, callbacks are not called
+     * @param on_chunk - callback called in GUI thread with columns and next rows of result
+     * @param on_finished - callback called in GUI thread after last chunk
+     * (result has no rows, rows_affected is count of streamed rows)
+     * @return handle that allows to cancel query
+     */
+    QueryHandle AsyncExecutor::submitStream(const QString &sql,
+                                            const QVariantMap &binds,
+                                            int chunk_rows,
+                                            QObject *context_ptr,
+                                            QueryCallback on_chunk,
+                                            QueryCallback on_finished)
+    {
+        quint64 task_id(0);
+        QueryHandle handle(mRegister(context_ptr, on_finished, task_id));
+        auto state_ptr(handle.m_state_ptr);
+
+        m_pending[task_id].on_chunk = on_chunk;
+
+        QMetaObject::invokeMethod(m_worker_ptr.get(),
+                                  [this, task_id, sql, binds, chunk_rows, state_ptr]()
+                                  {mRunStream(task_id, sql, binds, std::max(1, chunk_rows), state_ptr); },
+                                  Qt::QueuedConnection);
+
+        return handle;
+    }
+
+    /**
+     * Queues batch of writes to be executed in database worker thread as one transaction
+     *
+     * @param batch - statements with parameter sets (copied)
+     * @param context_ptr - object that callback belongs to - if it's destroyed
+     * before batch ends, callback is not called
+     * @param on_finished - callback called in GUI thread, result has no rows,
+     * rows_affected is taken from BatchStats
+     * @return handle that allows to cancel batch before it starts
+     */
+    QueryHandle AsyncExecutor::submitBatch(const qry_helper::BatchWriter &batch,
+                                           QObject *context_ptr,
+                                           QueryCallback on_finished)
+    {
+        quint64 task_id(0);
+        QueryHandle handle(mRegister(context_ptr, on_finished, task_id));
+        auto state_ptr(handle.m_state_ptr);
+
+        QMetaObject::invokeMethod(m_worker_ptr.get(),
+                                  [this, task_id, batch, state_ptr]()
+                                  {mRunBatch(task_id, batch, state_ptr); },
+                                  Qt::QueuedConnection);
+
+        return handle;
+    }
+
+    /**
+     * Queues ping of worker connection (reopened if it was dropped)
+     * Keeps connection warm during idle periods, so next query doesn't pay for handshake
+     */
+    void AsyncExecutor::keepAlive()
+    {
+        QMetaObject::invokeMethod(m_worker_ptr.get(),
+                                  [this]()
+                                  {
+                                      if(!m_worker_lease.isValid())
+                                      {
+                                          m_worker_lease = m_db_ptr->leaseConnection();
+                                      }
+
+                                      QString error("");
+
+                                      if(m_worker_lease.isValid())
+                                      {
+                                          m_db_ptr->ping(error);
+                                      }
+                                  },
+                                  Qt::QueuedConnection);
+    }
+
+    /**
+     * Executes query (called in worker thread)
+     * Statement is taken from prepared statements cache of worker connection.
+     * Rows are fetched forward-only and copied, so result can be safely
+     * passed to GUI thread
+     */
+    void AsyncExecutor::mRun(quint64 task_id,
+                             const QString &sql,
+                             const QVariantMap &binds,
+                             std::shared_ptr<QueryHandle::State> state_ptr)
+    {
+        QueryResult result;
+
+        if(state_ptr->cancelled)
+        {
+            result.cancelled = true;
+        }
+        else
+        {
+            if(!m_worker_lease.isValid())
+            {
+                m_worker_lease = m_db_ptr->leaseConnection();
+            }
+
+            if(!m_worker_lease.isValid())
+            {
+                result.error = QObject::tr("No database connection available for background query");
+            }
+            else
+            {
+                bool is_prepared(false);
+                QSqlQuery qry(m_db_ptr->preparedQuery(sql, &is_prepared));
+
+                if(!is_prepared)
+                {
+                    result.error = qry.lastError().text();
+                }
+                else
+                {
+                    for(auto bind = binds.cbegin(); bind != binds.cend(); ++bind)
+                    {
+                        qry.bindValue(bind.key(), bind.value());
+                    }
+
+                    QElapsedTimer timer;
+                    timer.start();
+
+                    if(!qry.exec())
+                    {
+                        result.error = qry.lastError().text();
+                    }
+                    else
+                    {
+                        QSqlRecord record(qry.record());
+
+                        for(int column = 0; column < record.count(); column++)
+                        {
+                            result.columns.append(record.fieldName(column));
+                        }
+
+                        while(qry.next())
+                        {
+                            if(state_ptr->cancelled)
+                            {
+                                result.cancelled = true;
+                                break;
+                            }
+
+                            QVector<QVariant> row(record.count());
+
+                            for(int column = 0; column < record.count(); column++)
+                            {
+                                row[column] = qry.value(column);
+                            }
+
+                            result.rows.append(row);
+                        }
+
+                        result.rows_affected = qry.numRowsAffected();
+                        result.last_insert_id = qry.lastInsertId();
+                        result.ok = !result.cancelled;
+
+                        // execution with fetching of all rows
+                        QueryProfiler::instance().record(sql,
+                                                         timer.nsecsElapsed(),
+                                                         qry.isSelect() ? result.rows.size()
+                                                                        : result.rows_affected,
+                                                         binds.keys());
+
+                        qry.finish();
+                    }
+                }
+            }
+        }
+
+        state_ptr->finished = true;
+
+        QMetaObject::invokeMethod(this,
+                                  [this, task_id, result]()
+                                  {mDeliver(task_id, result); },
+                                  Qt::QueuedConnection);
+    }
+
+    /**
+     * Executes query and streams its rows (called in worker thread)
+     *
+     * Statement is not taken from statements cache - cursor stays open until
+     * last row is read, so it can't be shared. Rows are fetched forward-only:
+     * SQLite steps through result on demand, MySQL driver keeps only its
+     * client-side result buffer. If GUI has not handled previous chunks yet,
+     * fetching waits (without polling) until chunk is delivered or query is cancelled,
+     * so undelivered chunks never pile up in event queue
+     */
+    void AsyncExecutor::mRunStream(quint64 task_id,
+                                   const QString &sql,
+                                   const QVariantMap &binds,
+                                   int chunk_rows,
+                                   std::shared_ptr<QueryHandle::State> state_ptr)
+    {
+        static const int max_chunks_in_flight(4);
+
+        QueryResult result;
+
+        if(state_ptr->cancelled)
+        {
+            result.cancelled = true;
+        }
+        else
+        {
+            if(!m_worker_lease.isValid())
+            {
+                m_worker_lease = m_db_ptr->leaseConnection();
+            }
+
+            bool is_prepared(false);
+            QSqlQuery qry;
+
+            if(m_worker_lease.isValid())
+            {
+                qry = m_db_ptr->streamingQuery(sql, &is_prepared);
+            }
+
+            if(!m_worker_lease.isValid())
+            {
+                result.error = QObject::tr("No database connection available for background query");
+            }
+            else if(!is_prepared)
+            {
+                result.error = qry.lastError().text();
+            }
+            else
+            {
+                for(auto bind = binds.cbegin(); bind != binds.cend(); ++bind)
+                {
+                    qry.bindValue(bind.key(), bind.value());
+                }
+
+                QElapsedTimer timer;
+                timer.start();
+
+                if(!qry.exec())
+                {
+                    result.error = qry.lastError().text();
+                }
+                else
+                {
+                    QSqlRecord record(qry.record());
+                    QueryResult chunk;
+                    int streamed_rows(0);
+
+                    for(int column = 0; column < record.count(); column++)
+                    {
+                        chunk.columns.append(record.fieldName(column));
+                    }
+
+                    chunk.ok = true;
+                    chunk.rows.reserve(chunk_rows);
+
+                    while(!state_ptr->cancelled && qry.next())
+                    {
+                        QVector<QVariant> row(record.count());
+
+                        for(int column = 0; column < record.count(); column++)
+                        {
+                            row[column] = qry.value(column);
+                        }
+
+                        chunk.rows.append(row);
+                        ++streamed_rows;
+
+                        if(chunk.rows.size() >= chunk_rows)
+                        {
+                            {
+                                QMutexLocker locker(&state_ptr->mutex);
+
+                                while(state_ptr->chunks_in_flight >= max_chunks_in_flight && !state_ptr->cancelled)
+                                {
+                                    state_ptr->chunk_delivered.wait(&state_ptr->mutex);
+                                }
+                            }
+
+                            ++state_ptr->chunks_in_flight;
+                            QMetaObject::invokeMethod(this,
+                                                      [this, task_id, chunk]()
+                                                      {mDeliverChunk(task_id, chunk); },
+                                                      Qt::QueuedConnection);
+                            chunk.rows.clear();
+                        }
+                    }
+
+                    if(!chunk.rows.isEmpty() && !state_ptr->cancelled)
+                    {
+                        ++state_ptr->chunks_in_flight;
+                        QMetaObject::invokeMethod(this,
+                                                  [this, task_id, chunk]()
+                                                  {mDeliverChunk(task_id, chunk); },
+                                                  Qt::QueuedConnection);
+                    }
+
+                    result.cancelled = state_ptr->cancelled;
+                    result.columns = chunk.columns;
+                    result.rows_affected = streamed_rows;
+                    result.ok = !result.cancelled;
+
+                    QueryProfiler::instance().record(sql, timer.nsecsElapsed(), streamed_rows, binds.keys());
+
+                    qry.finish();
+                }
+            }
+        }
+
+        state_ptr->finished = true;
+
+        QMetaObject::invokeMethod(this,
+                                  [this, task_id, result]()
+                                  {mDeliver(task_id, result); },
+                                  Qt::QueuedConnection);
+    }
+
+    /**
+     * Executes batch as one transaction (called in worker thread)
+     * Once started - batch is not interrupted, so it's either commited or rolled back
+     */
+    void AsyncExecutor::mRunBatch(quint64 task_id,
+                                  qry_helper::BatchWriter batch,
+                                  std::shared_ptr<QueryHandle::State> state_ptr)
+    {
+        QueryResult result;
+
+        if(state_ptr->cancelled)
+        {
+            result.cancelled = true;
+        }
+        else
+        {
+            if(!m_worker_lease.isValid())
+            {
+                m_worker_lease = m_db_ptr->leaseConnection();
+            }
+
+            if(!m_worker_lease.isValid())
+            {
+                result.error = QObject::tr("No database connection available for background query");
+            }
+            else
+            {
+                result.ok = batch.exec(m_worker_lease.database(), result.error);
+                result.rows_affected = batch.stats().rows_affected;
+            }
+        }
+
+        state_ptr->finished = true;
+
+        QMetaObject::invokeMethod(this,
+                                  [this, task_id, result]()
+                                  {mDeliver(task_id, result); },
+                                  Qt::QueuedConnection);
+    }
+
+    /**
+     * Creates handle of task and stores its callback until result is delivered
+     *
+     * @param task_id - set to id of registered task
+     * @return handle of task
+     */
+    QueryHandle AsyncExecutor::mRegister(QObject *context_ptr,
+                                         QueryCallback on_finished,
+                                         quint64 &task_id)
+    {
+        QueryHandle handle;
+        handle.m_state_ptr = std::make_shared<QueryHandle::State>();
+        handle.m_state_ptr->cancelled = false;
+        handle.m_state_ptr->finished = false;
+        handle.m_state_ptr->chunks_in_flight = 0;
+
+        task_id = ++m_last_task_id;
+        m_pending.insert(task_id, PendingQuery{context_ptr, on_finished, handle.m_state_ptr, nullptr});
+
+        return handle;
+    }
+
+    /**
+     * Passes chunk of streamed rows to callback (called in GUI thread)
+     */
+    void AsyncExecutor::mDeliverChunk(quint64 task_id, const QueryResult &chunk)
+    {
+        auto pending = m_pending.find(task_id);
+
+        if(pending == m_pending.end())
+        {
+            return;
+        }
+
+        --pending->state_ptr->chunks_in_flight;
+        pending->state_ptr->wakeStream();
+
+        if(pending->state_ptr->cancelled || !pending->context_ptr || !pending->on_chunk)
+        {
+            return;
+        }
+
+        pending->on_chunk(chunk);
+    }
+
+    /**
+     * Passes result to callback (called in GUI thread)
+     * Callback is skipped if query was cancelled or its context no longer exists
+     */
+    void AsyncExecutor::mDeliver(quint64 task_id, const QueryResult &result)
+    {
+        PendingQuery pending(m_pending.take(task_id));
+
+        if(!pending.state_ptr || pending.state_ptr->cancelled || result.cancelled)
+        {
+            return;
+        }
+
+        if(pending.context_ptr && pending.on_finished)
+        {
+            pending.on_finished(result);
+        }
+    }
+
+}//namespace database
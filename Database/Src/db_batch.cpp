@@ -0,0 +1,559 @@
+#include "Database/Inc/db_batch.h"
+#include "Database/Inc/db_profiler.h"
+
+#include <algorithm>
+
+#include <QElapsedTimer>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QStringList>
+
+/* ************************
+ * Local Functions Prototypes - Begin
+ *************************/
+
+static bool supportsMultiRowValues(const QSqlDatabase &db);
+
+static bool findValuesTuple(const QString &sql, int &begin, int &end);
+
+static QStringList placeholderNames(const QString &sql);
+
+static QString suffixPlaceholders(const QString &sql, const QString &suffix);
+
+static int skipQuoted(const QString &sql, int pos);
+
+static int placeholderLength(const QString &sql, int pos);
+
+static bool isWordChar(QChar c);
+
+/* ************************
+ * Local Functions Prototypes - End
+ *************************/
+
+
+namespace qry_helper {
+
+    /**
+     * @return parameter sets written per second (0 if nothing was measured)
+     */
+    double BatchStats::rowsPerSecond() const
+    {
+        return elapsed_ns > 0 ? rows * 1e9 / elapsed_ns : 0;
+    }
+
+
+    BatchWriter::BatchWriter():
+        m_stats{0, 0, 0, 0}
+    {}
+
+    /**
+     * Adds parameter set of statement to batch
+     * Consecutive sets of the same statement are sent together
+     * (multi-row VALUES for INSERT where backend supports it, execBatch otherwise)
+     *
+     * @param sql - SQL statement with named placeholders
+     * @param binds - values for placeholders (key is placeholder e.g. ":user")
+     */
+    void BatchWriter::add(const QString &sql, const QVariantMap &binds)
+    {
+        if(m_steps.empty() || m_steps.back().sql != sql)
+        {
+            m_steps.push_back(Step{sql, {}});
+        }
+
+        m_steps.back().rows.append(binds);
+    }
+
+    /**
+     * @return count of parameter sets in batch
+     */
+    int BatchWriter::size() const
+    {
+        int result(0);
+
+        for(const auto &step: m_steps)
+        {
+            result += step.rows.size();
+        }
+
+        return result;
+    }
+
+    /**
+     * @return true if there's nothing to write
+     */
+    bool BatchWriter::isEmpty() const
+    {
+        return m_steps.empty();
+    }
+
+    /**
+     * Removes all parameter sets (statistics of last execution are kept)
+     */
+    void BatchWriter::clear()
+    {
+        m_steps.clear();
+    }
+
+    /**
+     * Executes whole batch as one transaction
+     * Either all statements are commited or none of them (rollback on first error)
+     *
+     * Note: Connection has to belong to calling thread.
+     * For execBatch some drivers report affected rows of last parameter set only
+     *
+     * @param db - open connection
+     * @param error - set to error message if batch failed
+     * @return true if batch was commited
+     */
+    bool BatchWriter::exec(QSqlDatabase db, QString &error)
+    {
+        m_stats = BatchStats{0, size(), 0, 0};
+
+        if(isEmpty())
+        {
+            return true;
+        }
+
+        QElapsedTimer timer;
+        timer.start();
+
+        if(!db.transaction())
+        {
+            error = db.lastError().text();
+            return false;
+        }
+
+        for(const auto &step: m_steps)
+        {
+            if(!mExecStep(db, step, error))
+            {
+                db.rollback();
+                m_stats.elapsed_ns = timer.nsecsElapsed();
+
+                return false;
+            }
+        }
+
+        if(!db.commit())
+        {
+            error = db.lastError().text();
+            db.rollback();
+            m_stats.elapsed_ns = timer.nsecsElapsed();
+
+            return false;
+        }
+
+        m_stats.elapsed_ns = timer.nsecsElapsed();
+
+        return true;
+    }
+
+    /**
+     * Batch Statistics Getter
+     *
+     * @return round trips, rows and time of last exec()
+     */
+    BatchStats BatchWriter::stats() const
+    {
+        return m_stats;
+    }
+
+    /**
+     * Chooses the cheapest way to send all parameter sets of statement
+     */
+    bool BatchWriter::mExecStep(QSqlDatabase &db, const Step &step, QString &error)
+    {
+        if(step.rows.size() == 1)
+        {
+            return mExecSingle(db, step, error);
+        }
+
+        if(supportsMultiRowValues(db) && step.sql.trimmed().startsWith("INSERT", Qt::CaseInsensitive))
+        {
+            return mExecMultiRow(db, step, error);
+        }
+
+        return mExecBatch(db, step, error);
+    }
+
+    /**
+     * Executes statement with single parameter set
+     */
+    bool BatchWriter::mExecSingle(QSqlDatabase &db, const Step &step, QString &error)
+    {
+        const QVariantMap &binds(step.rows.first());
+        QSqlQuery qry(db);
+
+        if(!qry.prepare(step.sql))
+        {
+            error = qry.lastError().text();
+            return false;
+        }
+
+        for(auto bind = binds.cbegin(); bind != binds.cend(); ++bind)
+        {
+            qry.bindValue(bind.key(), bind.value());
+        }
+
+        QElapsedTimer timer;
+        timer.start();
+
+        if(!qry.exec())
+        {
+            error = qry.lastError().text();
+            return false;
+        }
+
+        mRecord(step.sql, timer.nsecsElapsed(), 1, qry.numRowsAffected(), binds.keys());
+
+        return true;
+    }
+
+    /**
+     * Rewrites INSERT ... VALUES (...) into INSERT ... VALUES (...), (...), ...
+     * Placeholders of every tuple get suffix with its index (:user -> :user_3).
+     * Rows are sent in chunks that fit SQLite limit of 999 bound variables.
+     * Statement with anything but ';' after its tuple is sent with execBatch
+     */
+    bool BatchWriter::mExecMultiRow(QSqlDatabase &db, const Step &step, QString &error)
+    {
+        int begin(0), end(0);
+        const bool has_tuple(findValuesTuple(step.sql, begin, end));
+        const QString rest(has_tuple ? step.sql.mid(end).trimmed() : QString());
+
+        if(!has_tuple || (!rest.isEmpty() && rest != ";"))
+        {
+            return mExecBatch(db, step, error);     // e.g. INSERT ... SELECT, ON DUPLICATE KEY UPDATE
+        }
+
+        const QString prefix(step.sql.left(begin));
+        const QString tuple(step.sql.mid(begin, end - begin));
+        const QStringList names(placeholderNames(tuple));
+        const int chunk_rows(std::max(1, std::min(500, names.isEmpty() ? 500 : 999 / names.size())));
+
+        for(int first = 0; first < step.rows.size(); first += chunk_rows)
+        {
+            const int count(std::min(chunk_rows, step.rows.size() - first));
+            QStringList tuples;
+
+            for(int i = 0; i < count; i++)
+            {
+                tuples.append(suffixPlaceholders(tuple, '_' + QString::number(i)));
+            }
+
+            const QString sql(prefix + tuples.join(", "));
+            QSqlQuery qry(db);
+
+            if(!qry.prepare(sql))
+            {
+                error = qry.lastError().text();
+                return false;
+            }
+
+            for(int i = 0; i < count; i++)
+            {
+                const QVariantMap &binds(step.rows.at(first + i));
+
+                for(const auto &name: names)
+                {
+                    qry.bindValue(':' + name + '_' + QString::number(i), binds.value(':' + name));
+                }
+            }
+
+            QElapsedTimer timer;
+            timer.start();
+
+            if(!qry.exec())
+            {
+                error = qry.lastError().text();
+                return false;
+            }
+
+            mRecord(step.sql, timer.nsecsElapsed(), count, qry.numRowsAffected(), step.rows.first().keys());
+        }
+
+        return true;
+    }
+
+    /**
+     * Executes statement once for all parameter sets with QSqlQuery::execBatch
+     * (drivers without native batch support emulate it with single prepared statement)
+     */
+    bool BatchWriter::mExecBatch(QSqlDatabase &db, const Step &step, QString &error)
+    {
+        QSqlQuery qry(db);
+
+        if(!qry.prepare(step.sql))
+        {
+            error = qry.lastError().text();
+            return false;
+        }
+
+        const QStringList keys(step.rows.first().keys());
+
+        for(const auto &key: keys)
+        {
+            QVariantList values;
+            values.reserve(step.rows.size());
+
+            for(const auto &binds: step.rows)
+            {
+                values.append(binds.value(key));
+            }
+
+            qry.bindValue(key, values);
+        }
+
+        QElapsedTimer timer;
+        timer.start();
+
+        if(!qry.execBatch())
+        {
+            error = qry.lastError().text();
+            return false;
+        }
+
+        mRecord(step.sql, timer.nsecsElapsed(), step.rows.size(), qry.numRowsAffected(), keys);
+
+        return true;
+    }
+
+    /**
+     * Adds executed statement to statistics of batch and QueryProfiler
+     */
+    void BatchWriter::mRecord(const QString &sql,
+                              qint64 elapsed_ns,
+                              int rows,
+                              int rows_affected,
+                              const QStringList &bound_names)
+    {
+        ++m_stats.statements;
+        m_stats.rows_affected += std::max(0, rows_affected);
+
+        QueryProfiler::instance().record(sql, elapsed_ns, rows, bound_names);
+    }
+
+}//namespace qry_helper
+
+
+/* ************************
+ * Local Functions - Begin
+ *************************/
+
+/**
+ * @param db - open connection
+ * @return true if backend accepts INSERT with many tuples after VALUES
+ */
+static bool supportsMultiRowValues(const QSqlDatabase &db)
+{
+    return db.driverName() == "QSQLITE" || db.driverName() == "QMYSQL";
+}
+
+/**
+ * Finds first tuple after first VALUES keyword (keyword and parentheses
+ * inside quoted literals and identifiers are skipped)
+ *
+ * @param sql - INSERT statement
+ * @param begin - set to index of opening parenthesis of tuple
+ * @param end - set to index just after matching closing parenthesis
+ * @return false if there is no VALUES followed by balanced tuple
+ */
+static bool findValuesTuple(const QString &sql, int &begin, int &end)
+{
+    static const QString keyword("VALUES");
+
+    bool has_keyword(false);
+    int depth(0);
+
+    for(int i = 0; i < sql.size();)
+    {
+        const int next(skipQuoted(sql, i));
+
+        if(next != i)
+        {
+            if(has_keyword && depth == 0)
+            {
+                return false;       // literal between VALUES and its tuple
+            }
+
+            i = next;
+            continue;
+        }
+
+        const QChar c(sql.at(i));
+
+        if(!has_keyword)
+        {
+            if(sql.midRef(i, keyword.size()).compare(keyword, Qt::CaseInsensitive) == 0
+                    && (i == 0 || !isWordChar(sql.at(i - 1)))
+                    && (i + keyword.size() == sql.size() || !isWordChar(sql.at(i + keyword.size()))))
+            {
+                has_keyword = true;
+                i += keyword.size();
+                continue;
+            }
+        }
+        else if(depth == 0)
+        {
+            if(c == '(')
+            {
+                begin = i;
+                depth = 1;
+            }
+            else if(!c.isSpace())
+            {
+                return false;
+            }
+        }
+        else if(c == '(')
+        {
+            ++depth;
+        }
+        else if(c == ')' && --depth == 0)
+        {
+            end = i + 1;
+            return true;
+        }
+
+        ++i;
+    }
+
+    return false;
+}
+
+/**
+ * @param sql - part of SQL statement
+ * @return unique names of named placeholders (without colon) in order of appearance,
+ * placeholders inside quoted literals are skipped
+ */
+static QStringList placeholderNames(const QString &sql)
+{
+    QStringList names;
+
+    for(int i = 0; i < sql.size();)
+    {
+        const int next(skipQuoted(sql, i));
+
+        if(next != i)
+        {
+            i = next;
+            continue;
+        }
+
+        const int length(placeholderLength(sql, i));
+        const QString name(sql.mid(i + 1, length));
+
+        if(length > 0 && !names.contains(name))
+        {
+            names.append(name);
+        }
+
+        i += 1 + length;
+    }
+
+    return names;
+}
+
+/**
+ * @param sql - part of SQL statement
+ * @param suffix - appended to name of every placeholder outside quoted literals
+ * @return sql with renamed placeholders
+ */
+static QString suffixPlaceholders(const QString &sql, const QString &suffix)
+{
+    QString result;
+    result.reserve(sql.size() + 8 * suffix.size());
+
+    for(int i = 0; i < sql.size();)
+    {
+        const int next(skipQuoted(sql, i));
+
+        if(next != i)
+        {
+            result += sql.midRef(i, next - i);
+            i = next;
+            continue;
+        }
+
+        const int length(placeholderLength(sql, i));
+
+        result += sql.midRef(i, 1 + length);
+
+        if(length > 0)
+        {
+            result += suffix;
+        }
+
+        i += 1 + length;
+    }
+
+    return result;
+}
+
+/**
+ * @param pos - index of character in sql
+ * @return index just after quoted literal or identifier ('...', "...", `...`, quote is
+ * escaped by doubling it) starting at pos, pos if there is no quote at pos
+ */
+static int skipQuoted(const QString &sql, int pos)
+{
+    const QChar quote(sql.at(pos));
+
+    if(quote != '\'' && quote != '"' && quote != '`')
+    {
+        return pos;
+    }
+
+    for(int i = pos + 1; i < sql.size(); i++)
+    {
+        if(sql.at(i) != quote)
+        {
+            continue;
+        }
+
+        if(i + 1 < sql.size() && sql.at(i + 1) == quote)
+        {
+            ++i;
+            continue;
+        }
+
+        return i + 1;
+    }
+
+    return sql.size();      // unterminated - rest of statement is literal
+}
+
+/**
+ * @param pos - index of character in sql
+ * @return length of name of placeholder starting at pos (0 if there is none,
+ * e.g. cast ::TEXT isn't placeholder)
+ */
+static int placeholderLength(const QString &sql, int pos)
+{
+    if(sql.at(pos) != ':' || (pos > 0 && sql.at(pos - 1) == ':'))
+    {
+        return 0;
+    }
+
+    int end(pos + 1);
+
+    while(end < sql.size() && isWordChar(sql.at(end)))
+    {
+        ++end;
+    }
+
+    return end - pos - 1;
+}
+
+/**
+ * @return true if c can be part of identifier
+ */
+static bool isWordChar(QChar c)
+{
+    return c.isLetterOrNumber() || c == '_';
+}
+
+/* ************************
+ * Local Functions - End
+ *************************/
@@ -0,0 +1,296 @@
+#include "Database/Inc/db_health.h"
+#include "Database/Inc/db_async.h"
+#include "Database/Inc/db_manager.h"
+#include "Database/Inc/db_profiler.h"
+
+#include <algorithm>
+
+#include <QRandomGenerator>
+
+
+namespace database {
+
+    /**
+     * Gives default configuration of health monitor
+     *
+     * Pings every 30 s keep connections below idle timeouts of servers,
+     * NAT and firewalls. Reconnecting starts after 1 s and doubles up to 1 min
+     *
+     * @return configuration used by DbManager::healthMonitor()
+     */
+    HealthConfig defaultHealthConfig()
+    {
+        return HealthConfig{30000, 60000, 1000, 60000, 5};
+    }
+
+
+    /**
+     * Creates monitor with dedicated thread for pings
+     *
+     * Note: Monitor has to be created in GUI thread - signals are emitted there
+     *
+     * @param db_ptr - database that leases connection for monitor thread
+     * @param config - intervals of pings and reconnecting
+     */
+    HealthMonitor::HealthMonitor(DbManager *db_ptr, const HealthConfig &config):
+        QObject(nullptr),
+        m_db_ptr(db_ptr),
+        m_config(config),
+        m_state(db_ptr->isDatabaseAvailable() ? ConnectionState::Connected
+                                              : ConnectionState::Disconnected),
+        m_last_error(""),
+        m_failed_attempts(0),
+        m_backoff_ms(config.backoff_initial_ms),
+        m_is_probe_pending(false),
+        m_worker_ptr(new QObject)
+    {
+        qRegisterMetaType<database::ConnectionState>();
+
+        m_thread.setObjectName("DbHealth");
+        m_worker_ptr->moveToThread(&m_thread);
+
+        // finished is emitted from worker thread - lease is returned there
+        QObject::connect(&m_thread,
+                         &QThread::finished,
+                         m_worker_ptr.get(),
+                         [this](){m_worker_lease.release(); },
+                         Qt::DirectConnection);
+
+        m_timer.setSingleShot(true);
+        QObject::connect(&m_timer, &QTimer::timeout, this, [this](){mProbe(); });
+    }
+
+    HealthMonitor::~HealthMonitor()
+    {
+        stop();
+    }
+
+    /**
+     * Starts monitoring - first ping is sent immediately
+     */
+    void HealthMonitor::start()
+    {
+        if(m_thread.isRunning())
+        {
+            return;
+        }
+
+        m_thread.start();
+        m_timer.start(0);
+    }
+
+    /**
+     * Stops monitoring and returns connection of monitor thread
+     * Note: Waits for ping in progress
+     */
+    void HealthMonitor::stop()
+    {
+        m_timer.stop();
+
+        m_thread.quit();
+        m_thread.wait();
+
+        m_is_probe_pending = false;
+    }
+
+    /**
+     * Pings database without waiting for next scheduled ping
+     * (e.g. when user requests data while connection is reported as lost)
+     */
+    void HealthMonitor::checkNow()
+    {
+        if(m_thread.isRunning() && !m_is_probe_pending)
+        {
+            m_timer.stop();
+            mProbe();
+        }
+    }
+
+    /**
+     * @return true if monitor has been started
+     */
+    bool HealthMonitor::isRunning() const
+    {
+        return m_thread.isRunning();
+    }
+
+    /**
+     * @return state of connection reported by last ping
+     */
+    ConnectionState HealthMonitor::state() const
+    {
+        return m_state;
+    }
+
+    /**
+     * @return message of last failed ping or reconnect attempt
+     */
+    QString HealthMonitor::lastError() const
+    {
+        return m_last_error;
+    }
+
+    /**
+     * Sends ping to monitor thread (called in GUI thread)
+     * Idle state is taken here, so pings don't affect it
+     */
+    void HealthMonitor::mProbe()
+    {
+        if(m_is_probe_pending)
+        {
+            return;
+        }
+
+        m_is_probe_pending = true;
+
+        const bool is_idle(QueryProfiler::instance().msecsSinceLastQuery() >= m_config.idle_threshold_ms);
+
+        QMetaObject::invokeMethod(m_worker_ptr.get(),
+                                  [this, is_idle]()
+                                  {
+                                      QString error("");
+                                      const bool is_alive(mPing(error));
+
+                                      QMetaObject::invokeMethod(this,
+                                                                [this, is_alive, is_idle, error]()
+                                                                {mOnProbeFinished(is_alive, is_idle, error); },
+                                                                Qt::QueuedConnection);
+                                  },
+                                  Qt::QueuedConnection);
+    }
+
+    /**
+     * Pings database with connection of monitor thread (called in worker thread)
+     * Dropped connection is opened again here - handshake never blocks GUI
+     *
+     * @param error - set to error message if database doesn't respond
+     * @return true if database responded
+     */
+    bool HealthMonitor::mPing(QString &error)
+    {
+        if(!m_worker_lease.isValid())
+        {
+            m_worker_lease = m_db_ptr->leaseConnection(m_config.ping_interval_ms);
+
+            if(!m_worker_lease.isValid())
+            {
+                error = QObject::tr("Could not open database connection");
+                return false;
+            }
+        }
+
+        return m_db_ptr->ping(error);
+    }
+
+    /**
+     * Updates state and schedules next ping (called in GUI thread)
+     *
+     * While connected - next ping after ping interval,
+     * after failure - next attempt after exponentially growing delay
+     */
+    void HealthMonitor::mOnProbeFinished(bool is_alive, bool is_idle, QString error)
+    {
+        m_is_probe_pending = false;
+
+        if(!m_thread.isRunning())
+        {
+            return;
+        }
+
+        // Server responds - connections of application can be checked (and dropped main
+        // connection opened again) without risk of long timeouts
+        if(is_alive && (is_idle || m_state != ConnectionState::Connected || m_db_ptr->isStale()))
+        {
+            is_alive = mWarmUp(error);
+        }
+
+        if(is_alive)
+        {
+            m_failed_attempts = 0;
+            m_backoff_ms = m_config.backoff_initial_ms;
+
+            mSetState(ConnectionState::Connected, "");
+            m_timer.start(m_config.ping_interval_ms);
+        }
+        else
+        {
+            ++m_failed_attempts;
+
+            mSetState(m_failed_attempts >= m_config.max_attempts ? ConnectionState::Disconnected
+                                                                 : ConnectionState::Reconnecting,
+                      error);
+            m_timer.start(mNextBackoff());
+        }
+    }
+
+    /**
+     * Pre-warms connections used by windows: main connection (GUI thread)
+     * and connection of async executor (pinged in its worker thread)
+     *
+     * Note: QSqlDatabase can be used only in thread that opened it,
+     * so main connection has to be checked here. It's done only when server
+     * has just responded to monitor and application is idle or recovering.
+     * Main connection that was dropped is opened again right away - server
+     * responds, so handshake is short and user's next click doesn't wait for it
+     *
+     * @param error - set to error message if main connection doesn't work
+     * @return true if main connection works
+     */
+    bool HealthMonitor::mWarmUp(QString &error)
+    {
+        m_db_ptr->asyncExecutor()->keepAlive();
+
+        if(!m_db_ptr->isStale() && m_db_ptr->checkConnection(error))
+        {
+            return true;
+        }
+
+        return m_db_ptr->reopenStale(error);
+    }
+
+    /**
+     * Changes state and emits signals of connection (called in GUI thread)
+     */
+    void HealthMonitor::mSetState(ConnectionState state, const QString &error)
+    {
+        if(!error.isEmpty())
+        {
+            m_last_error = error;
+        }
+
+        if(state == m_state)
+        {
+            return;
+        }
+
+        const ConnectionState previous(m_state);
+        m_state = state;
+
+        emit stateChanged(state);
+
+        if(previous == ConnectionState::Connected)
+        {
+            emit connectionLost(m_last_error);
+        }
+        else if(state == ConnectionState::Connected)
+        {
+            emit connectionRestored();
+        }
+    }
+
+    /**
+     * Gives delay of next reconnect attempt and doubles it for following one
+     * Random jitter (up to 1/4 of delay) keeps many clients from reconnecting at once
+     *
+     * @return delay in ms
+     */
+    int HealthMonitor::mNextBackoff()
+    {
+        const int delay(m_backoff_ms + int(QRandomGenerator::global()->bounded(m_backoff_ms / 4 + 1)));
+
+        m_backoff_ms = std::min(m_config.backoff_max_ms, m_backoff_ms * 2);
+
+        return delay;
+    }
+
+}//namespace database
@@ -1,12 +1,31 @@
 #include "Database/Inc/db_manager.h"
+#include "Database/Inc/db_async.h"
+#include "Database/Inc/db_health.h"
+#include "Database/Inc/db_migrations.h"
+#include "Database/Inc/db_reference_cache.h"
+
+#include <stdexcept>
+
+#include <QSqlError>
 
 DbManager::DbManager():
     m_last_error(""),
-    m_available(false)
+    m_available(false),
+    m_main_stale(false),
+    m_owner_thread_ptr(nullptr),
+    m_pool_ptr(new DbConnectionPool(QString("pool_%1").arg(reinterpret_cast<quintptr>(this), 0, 16),
+                                    [this](const QString &connection_name, QString &error)
+                                    {return this->addConnection(connection_name, error);}))
 {}
 
 DbManager::~DbManager()
 {
+    m_monitor_ptr.reset();      // worker threads have to return their leases first
+    m_executor_ptr.reset();
+    m_reference_cache_ptr.reset();
+    m_pool_ptr->clear();
+    m_statement_cache_ptr.reset();
+
     if(m_available)
     {
         QSqlDatabase::removeDatabase(m_db_name);
@@ -16,6 +35,9 @@ DbManager::~DbManager()
 /**
  * Database Getter
  *
+ * Note: Thread that initialized database gets its main connection,
+ * other threads get connection they have leased with leaseConnection()
+ *
  * @return QSQLDatabase Object with open database to use in queries
  */
 QSqlDatabase DbManager::getDatabase() const
@@ -25,7 +47,19 @@ QSqlDatabase DbManager::getDatabase() const
         throw std::runtime_error("Database not initialized or could't be opened");
     }
 
-    return QSqlDatabase::database(m_db_name);
+    if (QThread::currentThread() == m_owner_thread_ptr)
+    {
+        return QSqlDatabase::database(m_db_name);
+    }
+
+    QString connection_name(m_pool_ptr->connectionForCurrentThread());
+
+    if (connection_name.isEmpty())
+    {
+        throw std::runtime_error("No database connection leased for calling thread");
+    }
+
+    return QSqlDatabase::database(connection_name);
 }
 
 /**
@@ -41,3 +75,432 @@ bool DbManager::isDatabaseAvailable() const
     return m_available;
 }
 
+/**
+ * Last Error Getter
+ *
+ * @return message of last error that occured on opening or migrating database
+ */
+QString DbManager::lastError() const
+{
+    return m_last_error;
+}
+
+/**
+ * Sets handler of errors that user should be told about
+ * (e.g. database file not found, connection lost)
+ *
+ * Note: Database itself never shows dialogs - GUI installs handler showing them
+ * (see db_msg::installDialogs), without handler errors are only kept in lastError()
+ *
+ * @param handler - called in thread that hit the error, nullptr removes handler
+ */
+void DbManager::setErrorHandler(DbErrorHandler handler)
+{
+    m_error_handler = handler;
+}
+
+/**
+ * Sets prompt asking user for corrected configuration (see badConfigHandler)
+ * Without prompt invalid configuration can't be fixed and initDb() fails
+ *
+ * @param prompt - gets name and current value of variable,
+ * returns true if value was changed, nullptr removes prompt
+ */
+void DbManager::setConfigPrompt(DbConfigPrompt prompt)
+{
+    m_config_prompt = prompt;
+}
+
+/**
+ * Passes error to installed error handler (if there's any)
+ *
+ * @param error - message of error
+ */
+void DbManager::reportError(const QString &error) const
+{
+    if (m_error_handler)
+    {
+        m_error_handler(error);
+    }
+}
+
+/**
+ * Asks for new value of configuration variable with installed prompt
+ *
+ * @param var_name - name of variable shown to user
+ * @param var - current value, overwritten with new one
+ * @return true if value was changed (false if there's no prompt)
+ */
+bool DbManager::promptConfig(const QString &var_name, QVariant &var) const
+{
+    return m_config_prompt && m_config_prompt(var_name, var);
+}
+
+/**
+ * Brings schema of database to version required by application
+ * (version table, indexes used by queries of GUI - see schema::migrations)
+ *
+ * Note: Has to be called after initDb() and before any window is opened
+ *
+ * @return true if schema is up to date, on failure message is set in lastError()
+ */
+bool DbManager::migrateSchema()
+{
+    if (!m_available)
+    {
+        m_last_error = QObject::tr("Database not initialized or could't be opened");
+        return false;
+    }
+
+    auto db = getDatabase();
+
+    return schema::migrate(db, m_last_error);
+}
+
+/**
+ * Leases connection for calling thread
+ *
+ * Thread that initialized database gets its main connection (not counted in pool),
+ * worker threads get their own pooled connection.
+ * Connection is returned to pool when lease is destroyed or released
+ *
+ * @param timeout_ms - maximal time of waiting for free connection (-1 waits forever)
+ * @return lease of connection, invalid if database is unavailable or pool timed out
+ */
+DbConnectionLease DbManager::leaseConnection(int timeout_ms)
+{
+    if (!m_available)
+    {
+        return DbConnectionLease();
+    }
+
+    if (QThread::currentThread() == m_owner_thread_ptr)
+    {
+        return DbConnectionLease(nullptr, m_db_name);
+    }
+
+    return m_pool_ptr->lease(timeout_ms);
+}
+
+/**
+ * Checks connection of calling thread with lightweight query
+ * If it fails (connection dropped by server or network) - connection is opened again
+ *
+ * Note: Ping is executed directly, so it's not counted by QueryProfiler
+ * and doesn't break idle periods. Worker threads need leased connection
+ *
+ * @param error - set to error message if connection doesn't work
+ * @return true if connection works
+ */
+bool DbManager::ping(QString &error)
+{
+    {
+        QSqlQuery qry(getDatabase());
+
+        if (qry.exec("SELECT 1"))
+        {
+            return true;
+        }
+
+        error = qry.lastError().text();
+    }
+
+    return reconnect(error);
+}
+
+/**
+ * Checks connection of calling thread with lightweight query, without reconnecting it
+ * Main connection that fails is marked stale - it's opened again by reopenStale()
+ * (see HealthMonitor), so timers of GUI thread never wait for handshake of dead server
+ *
+ * @param error - set to error message if connection doesn't work
+ * @return true if connection works
+ */
+bool DbManager::checkConnection(QString &error)
+{
+    const bool is_main(QThread::currentThread() == m_owner_thread_ptr);
+
+    if (is_main && m_main_stale)
+    {
+        error = QObject::tr("Connection was dropped and has not been opened again yet");
+        return false;
+    }
+
+    QSqlQuery qry(is_main ? QSqlDatabase::database(m_db_name, false) : getDatabase());
+
+    if (qry.exec("SELECT 1"))
+    {
+        return true;
+    }
+
+    error = qry.lastError().text();
+
+    if (is_main)
+    {
+        m_main_stale = true;
+    }
+
+    return false;
+}
+
+/**
+ * Opens main connection again if it was marked stale by checkConnection()
+ * Statements prepared on dropped connection are released first
+ *
+ * Note: Called only in thread that initialized database, after server
+ * has responded to other connection. If it can't be opened, it stays stale
+ *
+ * @param error - set to error message if connection could not be opened
+ * @return true if main connection is open (or wasn't stale)
+ */
+bool DbManager::reopenStale(QString &error)
+{
+    if (!m_main_stale)
+    {
+        return true;
+    }
+
+    if (m_statement_cache_ptr)
+    {
+        m_statement_cache_ptr->clear();
+    }
+
+    auto db = QSqlDatabase::database(m_db_name, false);
+    db.close();
+
+    m_main_stale = !db.open();
+
+    if (m_main_stale)
+    {
+        error = db.lastError().text();
+    }
+
+    return !m_main_stale;
+}
+
+/**
+ * @return true if main connection failed check and waits for reopenStale()
+ */
+bool DbManager::isStale() const
+{
+    return m_main_stale;
+}
+
+/**
+ * Opens connection of calling thread again
+ * Prepared statements of dropped connection are released
+ *
+ * Note: Thread that initialized database reconnects its main connection,
+ * worker threads - their leased connection
+ *
+ * @param error - set to error message if connection could not be opened
+ * @return true if connection has been opened
+ */
+bool DbManager::reconnect(QString &error)
+{
+    if (!m_available)
+    {
+        error = QObject::tr("Database not initialized or could't be opened");
+        return false;
+    }
+
+    if (QThread::currentThread() != m_owner_thread_ptr)
+    {
+        return m_pool_ptr->reconnectCurrentThread(error);
+    }
+
+    if (m_statement_cache_ptr)
+    {
+        m_statement_cache_ptr->clear();
+    }
+
+    m_main_stale = false;
+    QSqlDatabase::removeDatabase(m_db_name);
+
+    return addConnection(m_db_name, error);
+}
+
+/**
+ * Pool Metrics Getter
+ *
+ * @return snapshot of worker connections pool state
+ */
+PoolMetrics DbManager::poolMetrics() const
+{
+    return m_pool_ptr->metrics();
+}
+
+/**
+ * Sets maximal count of worker connections opened at the same time
+ *
+ * @param max_connections - pool bound (at least 1)
+ */
+void DbManager::setMaxPoolConnections(int max_connections)
+{
+    m_pool_ptr->setMaxConnections(max_connections);
+}
+
+/**
+ * Gives prepared statement from cache of calling thread's connection
+ * Repeated SQL text reuses statement prepared before, so only parameters have to be bound
+ *
+ * Note: Statement has to be used before the same SQL is requested again
+ * (it's shared with cache). Worker threads need leased connection
+ *
+ * @param sql - SQL statement with placeholders
+ * @param ok - if not null - set to false when statement could not be prepared
+ * @return prepared forward only query
+ */
+QSqlQuery DbManager::preparedQuery(const QString &sql, bool *ok)
+{
+    if (QThread::currentThread() == m_owner_thread_ptr)
+    {
+        if (!m_statement_cache_ptr)
+        {
+            m_statement_cache_ptr = std::make_shared<StatementCache>(m_db_name);
+        }
+
+        return m_statement_cache_ptr->prepared(sql, ok);
+    }
+
+    auto statement_cache_ptr(m_pool_ptr->statementCacheForCurrentThread());
+
+    if (!statement_cache_ptr)
+    {
+        throw std::runtime_error("No database connection leased for calling thread");
+    }
+
+    return statement_cache_ptr->prepared(sql, ok);
+}
+
+/**
+ * Gives statement for streaming large results (see AsyncExecutor::submitStream)
+ * Query is forward-only, so rows already read are not kept by driver,
+ * and it's not cached - its cursor stays open while rows are streamed
+ *
+ * Note: Uses connection of calling thread (worker threads need leased connection)
+ *
+ * @param sql - SQL statement with placeholders
+ * @param ok - if not null - set to false when statement could not be prepared
+ * @return prepared forward only query
+ */
+QSqlQuery DbManager::streamingQuery(const QString &sql, bool *ok)
+{
+    QSqlQuery qry(getDatabase());
+    qry.setForwardOnly(true);
+
+    bool is_prepared(qry.prepare(sql));
+
+    if (ok)
+    {
+        *ok = is_prepared;
+    }
+
+    return qry;
+}
+
+/**
+ * Statement Cache Statistics Getter
+ *
+ * @return sum of hit/miss counters of all connections (main and pooled)
+ */
+StatementCacheStats DbManager::statementCacheStats() const
+{
+    StatementCacheStats result(m_pool_ptr->statementCacheStats());
+
+    auto main_cache_ptr(m_statement_cache_ptr);
+
+    if (main_cache_ptr)
+    {
+        StatementCacheStats stats(main_cache_ptr->stats());
+
+        result.hits += stats.hits;
+        result.misses += stats.misses;
+        result.evictions += stats.evictions;
+        result.size += stats.size;
+        result.capacity += stats.capacity;
+    }
+
+    return result;
+}
+
+/**
+ * Async Executor Getter
+ *
+ * Note: Executor is created on first use - it has to happen in GUI thread,
+ * because callbacks of queries are delivered to thread of executor
+ *
+ * @return executor of queries running in database worker thread
+ */
+database::AsyncExecutor *DbManager::asyncExecutor()
+{
+    if (!m_executor_ptr)
+    {
+        m_executor_ptr.reset(new database::AsyncExecutor(this));
+    }
+
+    return m_executor_ptr.get();
+}
+
+/**
+ * Health Monitor Getter
+ *
+ * Note: Monitor is created on first use - it has to happen in GUI thread,
+ * signals of connection state are emitted there. It has to be started with start()
+ *
+ * @return monitor of connection with database
+ */
+database::HealthMonitor *DbManager::healthMonitor()
+{
+    if (!m_monitor_ptr)
+    {
+        m_monitor_ptr.reset(new database::HealthMonitor(this, database::defaultHealthConfig()));
+    }
+
+    return m_monitor_ptr.get();
+}
+
+/**
+ * Reference Cache Getter
+ *
+ * Note: Cache is shared by all windows using this database, it has to be used from GUI thread
+ *
+ * @return cache of plants and substrate catalog of users
+ */
+database::ReferenceCache *DbManager::referenceCache()
+{
+    if (!m_reference_cache_ptr)
+    {
+        m_reference_cache_ptr.reset(new database::ReferenceCache(this));
+    }
+
+    return m_reference_cache_ptr.get();
+}
+
+/**
+ * Sets local mirror that serves reads of mirrored tables (see database::ReplicaSync)
+ *
+ * @param replica_ptr - open mirror database, nullptr detaches mirror
+ */
+void DbManager::setReadReplica(std::shared_ptr<DbManager> replica_ptr)
+{
+    m_replica_ptr = replica_ptr;
+}
+
+/**
+ * Read Replica Getter
+ *
+ * Note: Only reads of tables mirrored by replica can be sent there
+ * (plants, containers, substrates, substrate owners, services)
+ *
+ * @return attached mirror if it's available, otherwise this database
+ */
+DbManager *DbManager::readReplica()
+{
+    if (m_replica_ptr && m_replica_ptr->isDatabaseAvailable())
+    {
+        return m_replica_ptr.get();
+    }
+
+    return this;
+}
@@ -0,0 +1,517 @@
+#include "Database/Inc/db_migrations.h"
+
+#include <QDateTime>
+#include <QObject>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QSqlRecord>
+
+/* ************************
+ * Local Functions Prototypes - Begin
+ *************************/
+
+static bool isMySQL(const QSqlDatabase &db);
+
+static bool createVersionTable(QSqlDatabase &db, QString &error);
+
+static bool existsIndex(QSqlDatabase &db, const IndexSpec &index, bool &exists, QString &error);
+
+static bool createIndex(QSqlDatabase &db, const IndexSpec &index, QString &error);
+
+static bool addChangeTracking(QSqlDatabase &db, const QString &table, QString &error);
+
+static bool createSubstrateSearch(QSqlDatabase &db, QString &error);
+
+static bool applyMigration(QSqlDatabase &db, const Migration &migration, QString &error);
+
+/* ************************
+ * Local Functions Prototypes - End
+ *************************/
+
+
+namespace schema{
+
+/**
+ * Column with time of last change of row (MySQL server only),
+ * replicas pull rows changed since their last sync
+ */
+const char *const change_tracking_column = "updated_at";
+
+/**
+ * Full-text index of substrate names - FTS5 table kept in sync by triggers (SQLite)
+ * or FULLTEXT index (MySQL). SQLite built without FTS5 has neither,
+ * search falls back to catalog in memory then
+ */
+const char *const substrate_search_table = "substrate_search";
+const char *const substrate_search_index = "ft_substrate_name";
+
+/**
+ * Ordered list of schema migrations
+ * Note: Migrations that were released must never be changed - add new one instead
+ *
+ * @return all migrations sorted by version
+ */
+const std::vector<Migration> &migrations()
+{
+    static const std::vector<Migration> all_migrations{
+        {
+            1,
+            "Indexes for queries issued by GUI",
+            {
+                // Plant list (BiogasCalculator, Services)
+                {"idx_plant_owner", "biogas_server_plant", {"owner_id"}},
+                // SUM(volume) of plant - covering index, table is not read
+                {"idx_container_plant_volume", "biogas_server_container", {"fromPlant_id", "volume"}},
+                // Substrates owned by user and NOT EXISTS check of public substrates
+                {"idx_substrate_owner_user", "biogas_server_substrate_owner", {"user_id", "substrate_id"}},
+                {"idx_substrate_owner_substrate", "biogas_server_substrate_owner", {"substrate_id"}},
+                // Services of plant grouped by date
+                {"idx_service_plant_date", "biogas_server_service", {"forPlant_id", "date"}},
+                // Phone numbers of user and duplicate check on adding number
+                {"idx_phonenumber_owner_number", "biogas_server_phonenumber", {"owner_id", "phoneNumber"}},
+                // Corespondance address of user
+                {"idx_address_user", "biogas_server_corespondanceaddres", {"userID_id"}}
+            },
+            {},
+            {},
+            false
+        },
+        {
+            2,
+            "Change tracking of tables mirrored by local replicas",
+            {},
+            {},
+            {
+                "biogas_server_plant",
+                "biogas_server_container",
+                "biogas_server_substrate",
+                "biogas_server_substrate_owner",
+                "biogas_server_service"
+            },
+            false
+        },
+        {
+            3,
+            "Keyset pagination of services",
+            {
+                // Pages of services of plant ordered by (date, serviceID)
+                {"idx_service_plant_date_id", "biogas_server_service", {"forPlant_id", "date", "serviceID"}}
+            },
+            {},
+            {},
+            false
+        },
+        {
+            4,
+            "Search of substrates by name",
+            {
+                // Prefix search (LIKE 'text%') of short texts and ordering of matches
+                {"idx_substrate_name", "biogas_server_substrate", {"name"}}
+            },
+            {},
+            {},
+            true
+        }
+    };
+
+    return all_migrations;
+}
+
+/**
+ * @return version of schema expected by application
+ */
+int latestVersion()
+{
+    return migrations().empty() ? 0 : migrations().back().version;
+}
+
+/**
+ * Reads version of schema stored in database
+ *
+ * @param db - open connection
+ * @param error - set to error message on failure
+ * @return version of schema (0 if no migration was applied), -1 on failure
+ */
+int currentVersion(QSqlDatabase &db, QString &error)
+{
+    if(!db.tables().contains("app_schema_version"))
+    {
+        return 0;
+    }
+
+    QSqlQuery qry(db);
+
+    if(!qry.exec("SELECT MAX(version) FROM app_schema_version"))
+    {
+        error = qry.lastError().text();
+        return -1;
+    }
+
+    return qry.next() ? qry.value(0).toInt() : 0;
+}
+
+/**
+ * Checks if schema of database matches version expected by application
+ *
+ * @param db - open connection
+ * @param error - set to error message if schema is outdated or could not be read
+ * @return true if schema is up to date
+ */
+bool isUpToDate(QSqlDatabase &db, QString &error)
+{
+    int version(currentVersion(db, error));
+
+    if(version < 0)
+    {
+        return false;
+    }
+
+    if(version != latestVersion())
+    {
+        error = QObject::tr("Database schema version %1, application requires %2")
+                .arg(version).arg(latestVersion());
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * Applies all migrations newer than version stored in database
+ *
+ * Each migration is recorded in app_schema_version table. Migration runs
+ * in transaction where backend allows it (MySQL commits DDL implicitly,
+ * so index steps check if index already exists and can be repeated)
+ *
+ * @param db - open connection
+ * @param error - set to error message on failure
+ * @return true if schema is up to date after migration
+ */
+bool migrate(QSqlDatabase &db, QString &error)
+{
+    if(!createVersionTable(db, error))
+    {
+        return false;
+    }
+
+    int version(currentVersion(db, error));
+
+    if(version < 0)
+    {
+        return false;
+    }
+
+    if(version > latestVersion())
+    {
+        error = QObject::tr("Database schema version %1 is newer than supported by application (%2)")
+                .arg(version).arg(latestVersion());
+        return false;
+    }
+
+    for(const auto &migration: migrations())
+    {
+        if(migration.version > version && !applyMigration(db, migration, error))
+        {
+            error = QObject::tr("Migration %1 (%2) failed: ")
+                    .arg(migration.version).arg(migration.description) + error;
+            return false;
+        }
+    }
+
+    return isUpToDate(db, error);
+}
+
+}//namespace schema
+
+
+/* ************************
+ * Local Functions - Begin
+ *************************/
+
+/**
+ * @param db - connection
+ * @return true if connection uses MySQL driver (otherwise SQLite is assumed)
+ */
+static bool isMySQL(const QSqlDatabase &db)
+{
+    return db.driverName() == "QMYSQL";
+}
+
+/**
+ * Creates table storing applied migrations (if it does not exist)
+ *
+ * @param db - open connection
+ * @param error - set to error message on failure
+ * @return true if table exists
+ */
+static bool createVersionTable(QSqlDatabase &db, QString &error)
+{
+    QSqlQuery qry(db);
+
+    if(!qry.exec("CREATE TABLE IF NOT EXISTS app_schema_version ("
+                 "version INTEGER NOT NULL PRIMARY KEY, "
+                 "description VARCHAR(255) NOT NULL, "
+                 "applied_at VARCHAR(32) NOT NULL)"))
+    {
+        error = qry.lastError().text();
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * Checks if index of given name exists on table
+ *
+ * @param db - open connection
+ * @param index - specification of index
+ * @param exists - set to true if index exists
+ * @param error - set to error message on failure
+ * @return true if check was performed
+ */
+static bool existsIndex(QSqlDatabase &db, const IndexSpec &index, bool &exists, QString &error)
+{
+    QSqlQuery qry(db);
+
+    if(isMySQL(db))
+    {
+        qry.prepare("SELECT COUNT(*) FROM information_schema.statistics "
+                    "WHERE table_schema = DATABASE() AND table_name = :table AND index_name = :name");
+    }
+    else
+    {
+        qry.prepare("SELECT COUNT(*) FROM sqlite_master "
+                    "WHERE type = 'index' AND tbl_name = :table AND name = :name");
+    }
+
+    qry.bindValue(":table", index.table);
+    qry.bindValue(":name", index.name);
+
+    if(!qry.exec() || !qry.next())
+    {
+        error = qry.lastError().text();
+        return false;
+    }
+
+    exists = qry.value(0).toInt() > 0;
+
+    return true;
+}
+
+/**
+ * Creates index if it does not exist yet
+ *
+ * @param db - open connection
+ * @param index - specification of index
+ * @param error - set to error message on failure
+ * @return true if index exists after call
+ */
+static bool createIndex(QSqlDatabase &db, const IndexSpec &index, QString &error)
+{
+    bool exists(false);
+
+    if(!existsIndex(db, index, exists, error))
+    {
+        return false;
+    }
+
+    if(exists)
+    {
+        return true;
+    }
+
+    QSqlQuery qry(db);
+
+    if(!qry.exec("CREATE INDEX " + index.name + " ON " + index.table
+                 + " (" + index.columns.join(", ") + ")"))
+    {
+        error = qry.lastError().text();
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * Adds column with time of last change (set by server on insert and update)
+ * and index used by incremental sync. Existing column or index is kept,
+ * so step can be repeated (MySQL commits DDL implicitly)
+ *
+ * @param db - open MySQL connection
+ * @param table - table of mirrored data
+ * @param error - set to error message on failure
+ * @return true if table is tracked after call
+ */
+static bool addChangeTracking(QSqlDatabase &db, const QString &table, QString &error)
+{
+    const QString column(schema::change_tracking_column);
+
+    if(!db.record(table).contains(column))
+    {
+        QSqlQuery qry(db);
+
+        if(!qry.exec("ALTER TABLE " + table + " ADD COLUMN " + column + " TIMESTAMP(3) NOT NULL "
+                     "DEFAULT CURRENT_TIMESTAMP(3) ON UPDATE CURRENT_TIMESTAMP(3)"))
+        {
+            error = qry.lastError().text();
+            return false;
+        }
+    }
+
+    return createIndex(db, IndexSpec{"idx_" + table + "_" + column,
+                                     table,
+                                     {column}},
+                       error);
+}
+
+/**
+ * Creates full-text index of substrate names (if it does not exist)
+ * - MySQL: FULLTEXT index on name
+ * - SQLite: external content FTS5 table (rowid is substrateID) with triggers
+ *   keeping it in sync, filled from existing rows. Prefix indexes make
+ *   as-you-type queries ("ma"*) as fast as whole words.
+ *   If SQLite was built without FTS5 step is skipped (search uses memory)
+ *
+ * @param db - open connection
+ * @param error - set to error message on failure
+ * @return true if index exists after call or can't be created by database
+ */
+static bool createSubstrateSearch(QSqlDatabase &db, QString &error)
+{
+    const QString table(schema::substrate_search_table);
+    QSqlQuery qry(db);
+
+    if(isMySQL(db))
+    {
+        const IndexSpec index{schema::substrate_search_index, "biogas_server_substrate", {"name"}};
+        bool exists(false);
+
+        if(!existsIndex(db, index, exists, error))
+        {
+            return false;
+        }
+
+        if(!exists && !qry.exec("ALTER TABLE " + index.table + " ADD FULLTEXT INDEX "
+                                + index.name + " (" + index.columns.join(", ") + ")"))
+        {
+            error = qry.lastError().text();
+            return false;
+        }
+
+        return true;
+    }
+
+    if(db.tables().contains(table))
+    {
+        return true;
+    }
+
+    if(!qry.exec("CREATE VIRTUAL TABLE " + table + " USING fts5("
+                 "name, content='biogas_server_substrate', content_rowid='substrateID', "
+                 "tokenize='unicode61 remove_diacritics 2', prefix='1 2 3')"))
+    {
+        return qry.lastError().text().contains("no such module");
+    }
+
+    const QStringList statements{
+        "CREATE TRIGGER " + table + "_insert AFTER INSERT ON biogas_server_substrate BEGIN "
+        "INSERT INTO " + table + " (rowid, name) VALUES (new.substrateID, new.name); END",
+
+        "CREATE TRIGGER " + table + "_delete AFTER DELETE ON biogas_server_substrate BEGIN "
+        "INSERT INTO " + table + " (" + table + ", rowid, name) VALUES ('delete', old.substrateID, old.name); END",
+
+        "CREATE TRIGGER " + table + "_update AFTER UPDATE OF name ON biogas_server_substrate BEGIN "
+        "INSERT INTO " + table + " (" + table + ", rowid, name) VALUES ('delete', old.substrateID, old.name); "
+        "INSERT INTO " + table + " (rowid, name) VALUES (new.substrateID, new.name); END",
+
+        "INSERT INTO " + table + " (" + table + ") VALUES ('rebuild')"
+    };
+
+    for(const auto &statement: statements)
+    {
+        if(!qry.exec(statement))
+        {
+            error = qry.lastError().text();
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * Applies single migration and records its version
+ *
+ * @param db - open connection
+ * @param migration - migration to apply
+ * @param error - set to error message on failure
+ * @return true if migration was applied
+ */
+static bool applyMigration(QSqlDatabase &db, const Migration &migration, QString &error)
+{
+    bool in_transaction(!isMySQL(db) && db.transaction());
+    bool result(true);
+
+    for(const auto &index: migration.indexes)
+    {
+        result = result && createIndex(db, index, error);
+    }
+
+    if(isMySQL(db))
+    {
+        for(const auto &table: migration.tracked_tables)
+        {
+            result = result && addChangeTracking(db, table, error);
+        }
+    }
+
+    if(migration.substrate_search)
+    {
+        result = result && createSubstrateSearch(db, error);
+    }
+
+    QSqlQuery qry(db);
+
+    for(const auto &statement: migration.statements)
+    {
+        if(result && !qry.exec(statement))
+        {
+            error = qry.lastError().text();
+            result = false;
+        }
+    }
+
+    if(result)
+    {
+        qry.prepare("INSERT INTO app_schema_version (version, description, applied_at) "
+                    "VALUES (:version, :description, :applied_at)");
+        qry.bindValue(":version", migration.version);
+        qry.bindValue(":description", migration.description);
+        qry.bindValue(":applied_at", QDateTime::currentDateTimeUtc().toString(Qt::ISODate));
+
+        if(!qry.exec())
+        {
+            error = qry.lastError().text();
+            result = false;
+        }
+    }
+
+    if(in_transaction)
+    {
+        if(!result)
+        {
+            db.rollback();
+        }
+        else if(!db.commit())
+        {
+            error = db.lastError().text();
+            result = false;
+        }
+    }
+
+    return result;
+}
+
+/* ************************
+ * Local Functions - End
+ *************************/
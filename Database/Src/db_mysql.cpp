@@ -1,11 +1,9 @@
 #include "Database/Inc/db_mysql.h"
-#include "Database/Inc/db_messages.h"
 
 #include <algorithm>
 #include <limits>
 
 #include <QSqlError>
-#include <QMessageBox>
 #include <QRegularExpression>
 
 /* ************************
@@ -46,24 +44,13 @@ bool DbMySQL::initDb() noexcept
 
       if(!QSqlDatabase::contains(m_db_name))
       {
-          auto db = QSqlDatabase::addDatabase("QMYSQL", m_db_name);
-
-          db.setDatabaseName(m_config.db_name);
-          db.setPort(m_config.port);
-          db.setHostName(m_config.hostname);
-
-          db.setUserName(m_config.username); // consider move user_name and password from config
-          db.setPassword(m_config.username);
-
-          if(!db.open())
+          if(!addConnection(m_db_name, m_last_error))
           {
-              m_last_error = db.lastError().text();
-
-              db_msg::showDbCriticalError(QObject::tr("Could not establish connection with database.\n")
-                                                      + m_last_error);
+              reportError(QObject::tr("Could not establish connection with database.\n")
+                          + m_last_error);
           }
 
-          m_available = db.isOpen();
+          m_available = QSqlDatabase::database(m_db_name, false).isOpen();
       }
       else
       {
@@ -72,6 +59,8 @@ bool DbMySQL::initDb() noexcept
           m_available = !(!db.isOpen() && !db.open());
       }
 
+      m_owner_thread_ptr = QThread::currentThread();
+
       return m_available;
     }
 
@@ -83,7 +72,7 @@ bool DbMySQL::initDb() noexcept
         }
         else
         {
-            db_msg::showDbCriticalError(e.what());
+            reportError(e.what());
         }
 
         return false;
@@ -103,7 +92,7 @@ bool DbMySQL::validateDb()
         m_last_error += QObject::tr("Name: ") + m_config.db_name + '\n';
         m_last_error += "Port: " + QString(m_config.port) + 'n';
 
-        db_msg::showDbCriticalError(m_last_error);
+        reportError(m_last_error);
 
         return false;
     }
@@ -123,27 +112,64 @@ bool DbMySQL::badConfigHandler() noexcept
 
     if(!isValidDbName(m_config))
     {
-        result = db_msg::showInputDialogText(QObject::tr("Database name"), m_config.db_name);
+        QVariant db_name(m_config.db_name);
+
+        result = promptConfig(QObject::tr("Database name"), db_name);
+
+        if(result)
+        {
+            m_config.db_name = db_name.toString();
+            m_db_name = m_config.db_name;
+        }
     }
 
     if(!isValidDbPort(m_config))
     {
-        int new_port(m_config.port);
+        QVariant new_port(int(m_config.port));
 
-        result = db_msg::showInputDialogInt(QObject::tr("Database port"),
-                                            new_port,
-                                            std::numeric_limits<unsigned short>::min(),
-                                            std::numeric_limits<unsigned short>::max());
+        result = promptConfig(QObject::tr("Database port"), new_port);
 
         if(result)
         {
-            m_config.port = new_port;
+            m_config.port = (unsigned short)(qBound<int>(std::numeric_limits<unsigned short>::min(),
+                                                         new_port.toInt(),
+                                                         std::numeric_limits<unsigned short>::max()));
         }
     }
 
     return result;
 }
 
+/**
+ * Adds and opens connection with MySQL server
+ *
+ * Note: Used for main connection and for connections of worker threads pool.
+ * Connection can be used only in thread that called this function
+ *
+ * @param connection_name - name of connection in QSqlDatabase registry
+ * @param error - set to error message if connection could not be opened
+ * @return true if connection has been opened
+ */
+bool DbMySQL::addConnection(const QString &connection_name, QString &error) noexcept
+{
+    auto db = QSqlDatabase::addDatabase("QMYSQL", connection_name);
+
+    db.setDatabaseName(m_config.db_name);
+    db.setPort(m_config.port);
+    db.setHostName(m_config.hostname);
+
+    db.setUserName(m_config.username); // consider move user_name and password from config
+    db.setPassword(m_config.password);
+
+    if(!db.open())
+    {
+        error = db.lastError().text();
+        return false;
+    }
+
+    return true;
+}
+
 /* ************************
  * Local Functions - Begin
  *************************/
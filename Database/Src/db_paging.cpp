@@ -0,0 +1,196 @@
+#include "Database/Inc/db_paging.h"
+
+#include <QStringList>
+
+/* ************************
+ * Local Functions Prototypes - Begin
+ *************************/
+
+static QString afterPlaceholder(int term, int key);
+
+/* ************************
+ * Local Functions Prototypes - End
+ *************************/
+
+
+namespace database {
+
+    KeysetPager::KeysetPager():
+        m_page_rows(0),
+        m_at_end(true)
+    {}
+
+    /**
+     * Creates cursor placed before first row
+     *
+     * @param select - SELECT with FROM, without WHERE and ORDER BY (see schema::selectFrom)
+     * @param filter - condition of rows (empty for all rows of table)
+     * @param binds - values of placeholders used in filter
+     * @param keys - columns that rows are ordered by (have to identify row uniquely)
+     * @param page_rows - maximal number of rows in one page
+     */
+    KeysetPager::KeysetPager(const QString &select,
+                             const QString &filter,
+                             const QVariantMap &binds,
+                             const QVector<KeysetColumn> &keys,
+                             int page_rows):
+        m_select(select),
+        m_filter(filter),
+        m_binds(binds),
+        m_keys(keys),
+        m_page_rows(page_rows),
+        m_at_end(keys.isEmpty() || page_rows <= 0)
+    {}
+
+    /**
+     * Gives statement reading next page
+     * Rows after last row read are selected with expanded comparison of keys
+     * ("k1 > :a OR (k1 = :b AND k2 > :c)") - row values aren't supported by all
+     * versions of SQLite, each placeholder is used once for the same reason
+     *
+     * @return SQL statement of next page (use with pageBinds)
+     */
+    QString KeysetPager::pageSql() const
+    {
+        QStringList conditions;
+
+        if(!m_filter.isEmpty())
+        {
+            conditions.append("(" + m_filter + ")");
+        }
+
+        if(!m_last_keys.isEmpty())
+        {
+            QStringList terms;
+
+            for(int term = 0; term < m_keys.size(); term++)
+            {
+                QStringList comparisons;
+
+                for(int key = 0; key < term; key++)
+                {
+                    comparisons.append(m_keys.at(key).expression + " = " + afterPlaceholder(term, key));
+                }
+
+                comparisons.append(m_keys.at(term).expression + " > " + afterPlaceholder(term, term));
+                terms.append("(" + comparisons.join(" AND ") + ")");
+            }
+
+            conditions.append("(" + terms.join(" OR ") + ")");
+        }
+
+        QStringList order;
+
+        for(const auto &key: m_keys)
+        {
+            order.append(key.expression);
+        }
+
+        return m_select
+                + (conditions.isEmpty() ? QString() : " WHERE " + conditions.join(" AND "))
+                + " ORDER BY " + order.join(", ")
+                + " LIMIT " + QString::number(m_page_rows);
+    }
+
+    /**
+     * @return values of placeholders of filter and of keys of last row read
+     */
+    QVariantMap KeysetPager::pageBinds() const
+    {
+        QVariantMap binds(m_binds);
+
+        if(!m_last_keys.isEmpty())
+        {
+            for(int term = 0; term < m_keys.size(); term++)
+            {
+                for(int key = 0; key <= term; key++)
+                {
+                    binds.insert(afterPlaceholder(term, key), m_last_keys.at(key));
+                }
+            }
+        }
+
+        return binds;
+    }
+
+    /**
+     * Moves cursor behind last row of page
+     * Page shorter than page_rows is the last one
+     *
+     * @param page - result of statement given by pageSql
+     */
+    void KeysetPager::advance(const QueryResult &page)
+    {
+        if(!page.ok || page.rows.size() < m_page_rows)
+        {
+            m_at_end = true;
+        }
+
+        if(!page.ok || page.rows.isEmpty())
+        {
+            return;
+        }
+
+        const QVector<QVariant> &last_row(page.rows.last());
+
+        m_last_keys.resize(m_keys.size());
+
+        for(int key = 0; key < m_keys.size(); key++)
+        {
+            m_last_keys[key] = last_row.value(m_keys.at(key).position);
+        }
+    }
+
+    /**
+     * Moves cursor before first row
+     */
+    void KeysetPager::reset()
+    {
+        m_last_keys.clear();
+        m_at_end = !isValid();
+    }
+
+    /**
+     * @return true if pager has keys and size of page
+     */
+    bool KeysetPager::isValid() const
+    {
+        return !m_keys.isEmpty() && m_page_rows > 0;
+    }
+
+    /**
+     * @return true if last page has been read (or reading failed)
+     */
+    bool KeysetPager::atEnd() const
+    {
+        return m_at_end;
+    }
+
+    /**
+     * @return maximal number of rows in one page
+     */
+    int KeysetPager::pageRows() const
+    {
+        return m_page_rows;
+    }
+
+}//namespace database
+
+
+/* ************************
+ * Local Functions - Begin
+ *************************/
+
+/**
+ * @param term - index of OR term of keyset condition
+ * @param key - index of key compared in that term
+ * @return placeholder of value of key of last row (e.g. ":after_1_0")
+ */
+static QString afterPlaceholder(int term, int key)
+{
+    return ":after_" + QString::number(term) + "_" + QString::number(key);
+}
+
+/* ************************
+ * Local Functions - End
+ *************************/
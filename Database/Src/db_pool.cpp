@@ -0,0 +1,620 @@
+#include "Database/Inc/db_pool.h"
+
+#include <algorithm>
+#include <atomic>
+
+#include <QDeadlineTimer>
+#include <QObject>
+#include <QSqlError>
+
+/* ************************
+ * Local Functions Prototypes - Begin
+ *************************/
+
+static unsigned long long currentThreadId();
+
+/* ************************
+ * Local Functions Prototypes - End
+ *************************/
+
+
+DbConnectionLease::DbConnectionLease():
+    m_pool_ptr(nullptr),
+    m_connection_name("")
+{}
+
+/**
+ * Creates lease of connection
+ *
+ * @param pool_ptr - pool that the connection has to be returned to,
+ * nullptr if connection is not pooled (e.g. main connection of GUI thread)
+ * @param connection_name - name of connection in QSqlDatabase registry
+ */
+DbConnectionLease::DbConnectionLease(DbConnectionPool *pool_ptr, const QString &connection_name):
+    m_pool_ptr(pool_ptr),
+    m_connection_name(connection_name)
+{}
+
+DbConnectionLease::~DbConnectionLease()
+{
+    release();
+}
+
+DbConnectionLease::DbConnectionLease(DbConnectionLease &&other) noexcept:
+    m_pool_ptr(other.m_pool_ptr),
+    m_connection_name(std::move(other.m_connection_name))
+{
+    other.m_pool_ptr = nullptr;
+    other.m_connection_name.clear();
+}
+
+DbConnectionLease &DbConnectionLease::operator= (DbConnectionLease &&other) noexcept
+{
+    if(this != &other)
+    {
+        release();
+
+        m_pool_ptr = other.m_pool_ptr;
+        m_connection_name = std::move(other.m_connection_name);
+
+        other.m_pool_ptr = nullptr;
+        other.m_connection_name.clear();
+    }
+
+    return *this;
+}
+
+/**
+ * @return true if lease holds connection that can be used in calling thread
+ */
+bool DbConnectionLease::isValid() const
+{
+    return !m_connection_name.isEmpty();
+}
+
+/**
+ * @return name of leased connection (empty if lease is invalid)
+ */
+QString DbConnectionLease::connectionName() const
+{
+    return m_connection_name;
+}
+
+/**
+ * Leased Database Getter
+ *
+ * Note: Connection can be used only in thread that leased it
+ *
+ * @return QSqlDatabase object of leased connection
+ * (invalid QSqlDatabase if lease is invalid)
+ */
+QSqlDatabase DbConnectionLease::database() const
+{
+    if(!isValid())
+    {
+        return QSqlDatabase();
+    }
+
+    return QSqlDatabase::database(m_connection_name, false);
+}
+
+/**
+ * Returns connection to pool before lease goes out of scope
+ * Connection stays open and assigned to thread until it's evicted
+ *
+ * Note: Has to be called in thread that leased connection - evicted connection is closed here
+ */
+void DbConnectionLease::release()
+{
+    if(m_pool_ptr && isValid())
+    {
+        m_pool_ptr->mRelease(m_connection_name);
+    }
+
+    m_pool_ptr = nullptr;
+    m_connection_name.clear();
+}
+
+
+/**
+ * Creates bounded pool of connections (one per thread)
+ *
+ * @param name_prefix - prefix of pooled connection names in QSqlDatabase registry
+ * @param factory - function that adds and opens connection with given name
+ * @param max_connections - maximal count of connections opened at the same time
+ */
+DbConnectionPool::DbConnectionPool(const QString &name_prefix,
+                                   ConnectionFactory factory,
+                                   int max_connections):
+    m_name_prefix(name_prefix),
+    m_factory(factory),
+    m_max_connections(std::max(1, max_connections)),
+    m_serial(0),
+    m_last_error(""),
+    m_metrics{}
+{}
+
+DbConnectionPool::~DbConnectionPool()
+{
+    clear();
+}
+
+/**
+ * Leases connection for calling thread
+ *
+ * Thread that already has connection gets the same one (nested leases are counted).
+ * If pool is full - idle connection of other thread is evicted (marked stale and
+ * closed later by its own thread), if there's none - waits until some lease is returned.
+ * Connection is closed when thread that leased it finishes
+ *
+ * @param timeout_ms - maximal time of waiting for free slot (-1 waits forever)
+ * @return lease of connection, invalid lease if timed out or connection could not be opened
+ */
+DbConnectionLease DbConnectionPool::lease(int timeout_ms)
+{
+    const unsigned long long thread_id(currentThreadId());
+    QDeadlineTimer deadline(timeout_ms < 0 ? QDeadlineTimer(QDeadlineTimer::Forever)
+                                           : QDeadlineTimer(timeout_ms));
+    QString connection_name("");
+    bool is_new(false);
+
+    {
+        QMutexLocker locker(&m_mutex);
+        ++m_metrics.leases_total;
+
+        while(connection_name.isEmpty())
+        {
+            auto entry = mFindEntry(thread_id);
+
+            if(entry != m_entries.end() && entry->stale)
+            {
+                // Connection of calling thread was evicted - it's closed here, in thread that owns it
+                mRemoveConnection(*entry);
+                m_entries.erase(entry);
+                entry = m_entries.end();
+            }
+
+            if(entry != m_entries.end())
+            {
+                ++entry->lease_count;
+                connection_name = entry->connection_name;
+            }
+            else if(mActiveCount() < m_max_connections || mEvictIdleEntry())
+            {
+                connection_name = m_name_prefix + "_" + QString::number(++m_serial);
+                m_entries.push_back(Entry{thread_id,
+                                          QThread::currentThread(),
+                                          connection_name,
+                                          1,
+                                          nullptr,
+                                          false,
+                                          QMetaObject::Connection()});
+                is_new = true;
+            }
+            else
+            {
+                ++m_metrics.waits_total;
+
+                if(!m_slot_freed.wait(&m_mutex, deadline))
+                {
+                    ++m_metrics.lease_failures;
+                    m_last_error = QObject::tr("Timed out waiting for free database connection");
+
+                    return DbConnectionLease();
+                }
+            }
+        }
+    }
+
+    // Opening is done without lock - it might take whole handshake with server
+    QString error("");
+    bool is_open(false);
+
+    if(is_new)
+    {
+        is_open = m_factory(connection_name, error);
+    }
+    else
+    {
+        auto db = QSqlDatabase::database(connection_name, false);
+
+        is_open = db.isOpen() || db.open(); //sometimes connection might be lost
+        if(!is_open)
+        {
+            error = db.lastError().text();
+        }
+    }
+
+    if(!is_open)
+    {
+        mRelease(connection_name);
+
+        QMutexLocker locker(&m_mutex);
+        ++m_metrics.lease_failures;
+        m_last_error = error;
+
+        if(is_new)
+        {
+            auto entry = std::find_if(m_entries.begin(), m_entries.end(),
+                                      [&connection_name](const Entry &x){return x.connection_name == connection_name;});
+
+            if(entry != m_entries.end() && entry->lease_count == 0)
+            {
+                mRemoveConnection(*entry);
+                m_entries.erase(entry);
+            }
+        }
+
+        return DbConnectionLease();
+    }
+
+    if(is_new)
+    {
+        auto statement_cache_ptr = std::make_shared<StatementCache>(connection_name);
+
+        // finished is emitted from the thread itself - connection is closed where it's owned
+        QMetaObject::Connection finished_hook(QObject::connect(QThread::currentThread(),
+                                                               &QThread::finished,
+                                                               [this, thread_id](){mCloseThreadEntry(thread_id); }));
+
+        QMutexLocker locker(&m_mutex);
+        ++m_metrics.connections_created;
+
+        for(auto &entry: m_entries)
+        {
+            if(entry.connection_name == connection_name)
+            {
+                entry.statement_cache_ptr = statement_cache_ptr;
+                entry.finished_hook = finished_hook;
+            }
+        }
+    }
+
+    return DbConnectionLease(this, connection_name);
+}
+
+/**
+ * Opens connection of calling thread again (e.g. after it was dropped by server)
+ * Connection keeps its name and lease, prepared statements of old connection are released
+ *
+ * Note: Calling thread has to hold lease of connection
+ *
+ * @param error - set to error message if connection could not be opened
+ * @return true if connection has been opened again
+ */
+bool DbConnectionPool::reconnectCurrentThread(QString &error)
+{
+    const unsigned long long thread_id(currentThreadId());
+    QString connection_name("");
+    std::shared_ptr<StatementCache> statement_cache_ptr;
+
+    {
+        QMutexLocker locker(&m_mutex);
+        auto entry = mFindEntry(thread_id);
+
+        if(entry != m_entries.end() && entry->lease_count > 0)
+        {
+            connection_name = entry->connection_name;
+            statement_cache_ptr = entry->statement_cache_ptr;
+        }
+    }
+
+    if(connection_name.isEmpty())
+    {
+        error = QObject::tr("No database connection leased for calling thread");
+        return false;
+    }
+
+    if(statement_cache_ptr)
+    {
+        statement_cache_ptr->clear();   // statements have to be released before connection
+    }
+
+    // Connection is used only by calling thread - it can be replaced without lock
+    QSqlDatabase::removeDatabase(connection_name);
+
+    if(!m_factory(connection_name, error))
+    {
+        QMutexLocker locker(&m_mutex);
+        m_last_error = error;
+
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * @return name of connection leased by calling thread or empty string if there's none
+ */
+QString DbConnectionPool::connectionForCurrentThread() const
+{
+    const unsigned long long thread_id(currentThreadId());
+
+    QMutexLocker locker(&m_mutex);
+
+    for(const auto &entry: m_entries)
+    {
+        if(entry.thread_id == thread_id && entry.lease_count > 0)
+        {
+            return entry.connection_name;
+        }
+    }
+
+    return "";
+}
+
+/**
+ * @return cache of prepared statements of connection leased by calling thread
+ * or nullptr if thread has no leased connection
+ */
+std::shared_ptr<StatementCache> DbConnectionPool::statementCacheForCurrentThread() const
+{
+    const unsigned long long thread_id(currentThreadId());
+
+    QMutexLocker locker(&m_mutex);
+
+    for(const auto &entry: m_entries)
+    {
+        if(entry.thread_id == thread_id && entry.lease_count > 0)
+        {
+            return entry.statement_cache_ptr;
+        }
+    }
+
+    return nullptr;
+}
+
+/**
+ * @return sum of prepared statements caches statistics of all pooled connections
+ */
+StatementCacheStats DbConnectionPool::statementCacheStats() const
+{
+    QMutexLocker locker(&m_mutex);
+
+    StatementCacheStats result{0, 0, 0, 0, 0};
+
+    for(const auto &entry: m_entries)
+    {
+        if(entry.statement_cache_ptr)
+        {
+            StatementCacheStats stats(entry.statement_cache_ptr->stats());
+
+            result.hits += stats.hits;
+            result.misses += stats.misses;
+            result.evictions += stats.evictions;
+            result.size += stats.size;
+            result.capacity += stats.capacity;
+        }
+    }
+
+    return result;
+}
+
+/**
+ * @return Message of last error that occured on leasing connection
+ */
+QString DbConnectionPool::lastError() const
+{
+    QMutexLocker locker(&m_mutex);
+
+    return m_last_error;
+}
+
+/**
+ * Pool Metrics Getter
+ *
+ * @return snapshot of pool state and counters collected since pool creation
+ */
+PoolMetrics DbConnectionPool::metrics() const
+{
+    QMutexLocker locker(&m_mutex);
+
+    PoolMetrics result(m_metrics);
+
+    result.max_connections = m_max_connections;
+    result.open_connections = int(m_entries.size());
+    result.leased_connections = int(std::count_if(m_entries.begin(), m_entries.end(),
+                                                   [](const Entry &x){return x.lease_count > 0;}));
+    result.idle_connections = result.open_connections - result.leased_connections;
+
+    return result;
+}
+
+/**
+ * Changes pool bound
+ * Connections over new bound are evicted when they become idle
+ *
+ * @param max_connections - maximal count of connections opened at the same time
+ */
+void DbConnectionPool::setMaxConnections(int max_connections)
+{
+    QMutexLocker locker(&m_mutex);
+
+    m_max_connections = std::max(1, max_connections);
+
+    while(mActiveCount() > m_max_connections && mEvictIdleEntry())
+    {
+    }
+
+    m_slot_freed.wakeAll();
+}
+
+/**
+ * Removes all pooled connections
+ * Connection of calling thread is closed now, connections of other threads
+ * are closed by those threads when they finish (pool doesn't have to exist then)
+ *
+ * Note: Leases have to be returned before pool is cleared
+ */
+void DbConnectionPool::clear()
+{
+    const unsigned long long thread_id(currentThreadId());
+
+    QMutexLocker locker(&m_mutex);
+
+    for(auto &entry: m_entries)
+    {
+        if(entry.thread_id == thread_id)
+        {
+            mRemoveConnection(entry);
+            continue;
+        }
+
+        QObject::disconnect(entry.finished_hook);
+
+        if(entry.thread_ptr)
+        {
+            const QString connection_name(entry.connection_name);
+            std::shared_ptr<StatementCache> statement_cache_ptr(entry.statement_cache_ptr);
+
+            QObject::connect(entry.thread_ptr,
+                             &QThread::finished,
+                             [connection_name, statement_cache_ptr]() mutable
+                             {
+                                 statement_cache_ptr.reset();    // statements have to be released before connection
+                                 QSqlDatabase::removeDatabase(connection_name);
+                             });
+        }
+    }
+
+    m_metrics.connections_evicted += m_entries.size();
+    m_entries.clear();
+
+    m_slot_freed.wakeAll();
+}
+
+/**
+ * Returns single lease of connection (called by DbConnectionLease in thread that leased it)
+ * Connection stays assigned to its thread to be reused by next lease,
+ * unless it was evicted meanwhile - then it's closed
+ *
+ * @param connection_name - name of returned connection
+ */
+void DbConnectionPool::mRelease(const QString &connection_name)
+{
+    QMutexLocker locker(&m_mutex);
+
+    auto entry = std::find_if(m_entries.begin(), m_entries.end(),
+                              [&connection_name](const Entry &x){return x.connection_name == connection_name;});
+
+    if(entry == m_entries.end() || entry->lease_count == 0 || --entry->lease_count > 0)
+    {
+        return;
+    }
+
+    if(entry->stale)
+    {
+        mRemoveConnection(*entry);
+        m_entries.erase(entry);
+    }
+
+    m_slot_freed.wakeOne();
+}
+
+/**
+ * Evicts one idle connection to make space for other thread
+ * Connection is only marked stale - its owner may still hold statements of it,
+ * so it's closed by owner thread (on next lease or when thread finishes)
+ * Note: Has to be called with locked mutex
+ *
+ * @return true if some connection was evicted
+ */
+bool DbConnectionPool::mEvictIdleEntry()
+{
+    auto entry = std::find_if(m_entries.begin(), m_entries.end(),
+                              [](const Entry &x){return x.lease_count == 0 && !x.stale;});
+
+    if(entry == m_entries.end())
+    {
+        return false;
+    }
+
+    entry->stale = true;
+    ++m_metrics.connections_evicted;
+
+    return true;
+}
+
+/**
+ * Note: Has to be called with locked mutex
+ *
+ * @return count of connections that take slot of pool (not evicted)
+ */
+int DbConnectionPool::mActiveCount() const
+{
+    return int(std::count_if(m_entries.begin(), m_entries.end(),
+                             [](const Entry &x){return !x.stale;}));
+}
+
+/**
+ * Closes connection of thread that finishes (called from that thread)
+ *
+ * @param thread_id - id of finishing thread (see currentThreadId)
+ */
+void DbConnectionPool::mCloseThreadEntry(unsigned long long thread_id)
+{
+    QMutexLocker locker(&m_mutex);
+
+    auto entry = mFindEntry(thread_id);
+
+    if(entry == m_entries.end())
+    {
+        return;
+    }
+
+    mRemoveConnection(*entry);
+    m_entries.erase(entry);
+
+    m_slot_freed.wakeAll();
+}
+
+/**
+ * Releases prepared statements of connection and removes it from QSqlDatabase registry
+ * Note: Has to be called with locked mutex, in thread that owns connection
+ *
+ * @param entry - entry of idle connection
+ */
+void DbConnectionPool::mRemoveConnection(Entry &entry)
+{
+    QObject::disconnect(entry.finished_hook);
+    entry.statement_cache_ptr.reset();  // statements have to be released before connection
+
+    QSqlDatabase::removeDatabase(entry.connection_name);
+}
+
+/**
+ * Finds connection assigned to thread
+ * Note: Has to be called with locked mutex
+ *
+ * @param thread_id - id of thread (see currentThreadId)
+ * @return iterator to entry or end() if thread has no connection
+ */
+std::vector<DbConnectionPool::Entry>::iterator DbConnectionPool::mFindEntry(unsigned long long thread_id)
+{
+    return std::find_if(m_entries.begin(), m_entries.end(),
+                        [thread_id](const Entry &x){return x.thread_id == thread_id;});
+}
+
+/* ************************
+ * Local Functions - Begin
+ *************************/
+
+/**
+ * Gives unique id for calling thread
+ * Unlike QThread pointers or native handles - ids are never reused,
+ * so connection of finished thread will never be handed to a new one
+ *
+ * @return id of calling thread
+ */
+static unsigned long long currentThreadId()
+{
+    static std::atomic<unsigned long long> thread_counter(0);
+    thread_local unsigned long long thread_id(++thread_counter);
+
+    return thread_id;
+}
+
+/* ************************
+ * Local Functions - End
+ *************************/
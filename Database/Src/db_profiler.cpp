@@ -0,0 +1,345 @@
+#include "Database/Inc/db_profiler.h"
+
+#include <algorithm>
+
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QStandardPaths>
+#include <QTextStream>
+
+/* ************************
+ * Local Functions Prototypes - Begin
+ *************************/
+
+static int histogramBucket(qint64 elapsed_ns);
+
+static bool &isBackgroundThread();
+
+static QString slowLogLine(const QString &sql,
+                           qint64 elapsed_ns,
+                           int rows,
+                           const QStringList &bound_names);
+
+/* ************************
+ * Local Functions Prototypes - End
+ *************************/
+
+
+/**
+ * Approximates percentile of latency from histogram
+ *
+ * @param fraction - percentile as fraction (0.99 for p99)
+ * @return upper bound of histogram bucket containing percentile (in ms)
+ */
+double StatementStats::percentileMs(double fraction) const
+{
+    if(count == 0)
+    {
+        return 0;
+    }
+
+    const unsigned long long rank(std::max<unsigned long long>(1, static_cast<unsigned long long>(fraction * count)));
+    unsigned long long seen(0);
+
+    for(int bucket = 0; bucket < histogram_buckets; bucket++)
+    {
+        seen += histogram[bucket];
+
+        if(seen >= rank)
+        {
+            return bucket == histogram_buckets - 1 ? max_ns / 1e6
+                                                   : double(1ll << bucket) / 1e3;
+        }
+    }
+
+    return max_ns / 1e6;
+}
+
+
+/**
+ * Gives profiler shared by all connections of application
+ */
+QueryProfiler &QueryProfiler::instance()
+{
+    static QueryProfiler profiler;
+
+    return profiler;
+}
+
+/**
+ * Creates profiler with slow query log in application data directory
+ * (statements over 200 ms, rotated at 1 MiB, 3 old files kept)
+ */
+QueryProfiler::QueryProfiler():
+    m_slow_log{QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation)
+               + "/slow_queries.log",
+               200,
+               1024 * 1024,
+               3}
+{
+    m_activity_timer.start();
+}
+
+/**
+ * Records single execution of statement
+ * Note: Can be called from any thread
+ *
+ * @param sql - text of statement (with placeholders, not bound values)
+ * @param elapsed_ns - time of execution (and fetching if rows were read)
+ * @param rows - rows returned or affected, -1 if unknown
+ * @param bound_names - names of bound placeholders (values are never logged)
+ */
+void QueryProfiler::record(const QString &sql,
+                           qint64 elapsed_ns,
+                           int rows,
+                           const QStringList &bound_names)
+{
+    SlowLogConfig slow_log{QString(), 0, 0, 0};
+    bool is_slow(false);
+
+    {
+        QMutexLocker locker(&m_mutex);
+
+        if(!isBackgroundThread())
+        {
+            m_activity_timer.restart();
+        }
+
+        auto stats = m_stats.find(sql);
+
+        if(stats == m_stats.end())
+        {
+            stats = m_stats.insert(sql, StatementStats{sql, 0, 0, 0, 0, 0, {}});
+        }
+
+        ++stats->count;
+
+        if(rows >= 0)
+        {
+            stats->rows += static_cast<unsigned long long>(rows);
+        }
+        else
+        {
+            ++stats->rows_unknown;
+        }
+
+        stats->total_ns += elapsed_ns;
+        stats->max_ns = std::max(stats->max_ns, elapsed_ns);
+        ++stats->histogram[histogramBucket(elapsed_ns)];
+
+        is_slow = !m_slow_log.file_path.isEmpty() && elapsed_ns >= m_slow_log.threshold_ms * 1000000;
+
+        if(is_slow)
+        {
+            slow_log = m_slow_log;
+        }
+    }
+
+    // File is written without lock of statistics - other threads don't wait for disk
+    if(is_slow)
+    {
+        mAppendSlowLog(slow_log, slowLogLine(sql, elapsed_ns, rows, bound_names));
+    }
+}
+
+/**
+ * Gives statements that took the most time in total
+ *
+ * @param count - maximal count of returned statements
+ * @return statistics sorted descending by total time
+ */
+std::vector<StatementStats> QueryProfiler::topByTotalTime(int count) const
+{
+    std::vector<StatementStats> result;
+
+    {
+        QMutexLocker locker(&m_mutex);
+
+        result.reserve(m_stats.size());
+        for(const auto &stats: m_stats)
+        {
+            result.push_back(stats);
+        }
+    }
+
+    std::sort(result.begin(), result.end(),
+              [](const StatementStats &a, const StatementStats &b){return a.total_ns > b.total_ns;});
+
+    if(count >= 0 && result.size() > size_t(count))
+    {
+        result.resize(size_t(count));
+    }
+
+    return result;
+}
+
+/**
+ * Clears collected statistics (slow query log is kept)
+ */
+void QueryProfiler::reset()
+{
+    QMutexLocker locker(&m_mutex);
+
+    m_stats.clear();
+}
+
+/**
+ * @return time since last recorded statement (or since start of application)
+ * in milliseconds - used to detect idle periods (background threads are not counted)
+ */
+qint64 QueryProfiler::msecsSinceLastQuery() const
+{
+    QMutexLocker locker(&m_mutex);
+
+    return m_activity_timer.elapsed();
+}
+
+/**
+ * Marks calling thread as background worker (e.g. replica sync) - its statements
+ * are still recorded, but they don't count as activity of user
+ */
+void QueryProfiler::markBackgroundThread()
+{
+    isBackgroundThread() = true;
+}
+
+/**
+ * @return configuration of slow query log
+ */
+SlowLogConfig QueryProfiler::slowLog() const
+{
+    QMutexLocker locker(&m_mutex);
+
+    return m_slow_log;
+}
+
+/**
+ * Changes configuration of slow query log
+ *
+ * @param config - new configuration (empty file_path disables log)
+ */
+void QueryProfiler::setSlowLog(const SlowLogConfig &config)
+{
+    QMutexLocker locker(&m_mutex);
+
+    m_slow_log = config;
+}
+
+/**
+ * Appends line to slow query log (rotates file when it's too big)
+ * Note: Called without locked m_mutex - only writers of log wait for each other
+ *
+ * @param config - configuration of log at time of recording
+ * @param line - formatted entry (see slowLogLine)
+ */
+void QueryProfiler::mAppendSlowLog(const SlowLogConfig &config, const QString &line)
+{
+    QMutexLocker locker(&m_log_mutex);
+
+    QFileInfo info(config.file_path);
+
+    if(info.exists() && info.size() >= config.max_file_size)
+    {
+        mRotateSlowLog(config);
+    }
+
+    QDir().mkpath(info.absolutePath());
+
+    QFile file(config.file_path);
+
+    if(!file.open(QIODevice::Append | QIODevice::Text))
+    {
+        return;
+    }
+
+    QTextStream out(&file);
+    out << line << '\n';
+}
+
+/**
+ * Rotates slow query log: file.N-1 -> file.N, ..., file -> file.1
+ * Files over max_files are removed
+ * Note: Has to be called with locked m_log_mutex
+ */
+void QueryProfiler::mRotateSlowLog(const SlowLogConfig &config)
+{
+    const QString &path(config.file_path);
+
+    QFile::remove(path + '.' + QString::number(config.max_files));
+
+    for(int index = config.max_files - 1; index >= 1; index--)
+    {
+        QFile::rename(path + '.' + QString::number(index),
+                      path + '.' + QString::number(index + 1));
+    }
+
+    if(config.max_files > 0)
+    {
+        QFile::rename(path, path + ".1");
+    }
+    else
+    {
+        QFile::remove(path);
+    }
+}
+
+/* ************************
+ * Local Functions - Begin
+ *************************/
+
+/**
+ * @param elapsed_ns - latency
+ * @return index of histogram bucket (power of two of microseconds)
+ */
+static int histogramBucket(qint64 elapsed_ns)
+{
+    qint64 elapsed_us(elapsed_ns / 1000);
+    int bucket(0);
+
+    while(bucket < StatementStats::histogram_buckets - 1 && elapsed_us >= (1ll << bucket))
+    {
+        ++bucket;
+    }
+
+    return bucket;
+}
+
+/**
+ * @return flag of calling thread - true if statements of thread are not user activity
+ */
+static bool &isBackgroundThread()
+{
+    thread_local bool is_background(false);
+
+    return is_background;
+}
+
+/**
+ * Formats entry of slow query log
+ * Bound values are redacted - only placeholder names are written
+ *
+ * @return line without line break
+ */
+static QString slowLogLine(const QString &sql,
+                           qint64 elapsed_ns,
+                           int rows,
+                           const QStringList &bound_names)
+{
+    QStringList binds;
+    for(const auto &name: bound_names)
+    {
+        binds.append(name + "=<redacted>");
+    }
+
+    return QDateTime::currentDateTime().toString(Qt::ISODateWithMs)
+            + " | " + QString::number(elapsed_ns / 1e6, 'f', 3) + " ms"
+            + " | rows: " + (rows >= 0 ? QString::number(rows) : QString("unknown"))
+            + " | " + QString(sql).simplified()
+            + " | binds: " + binds.join(", ");
+}
+
+/* ************************
+ * Local Functions - End
+ *************************/
@@ -0,0 +1,439 @@
+#include "Database/Inc/db_reference_cache.h"
+#include "Database/Inc/database.h"
+#include "Database/Inc/db_profiler.h"
+#include "Database/Inc/db_schema.h"
+
+#include <QSqlError>
+#include <QSqlRecord>
+
+/* ************************
+ * Local Functions Prototypes - Begin
+ *************************/
+
+static QString referenceSql(database::ReferenceData data);
+
+static QString referenceSelect(database::ReferenceData data);
+
+static database::KeysetColumn referenceKey(database::ReferenceData data);
+
+/* ************************
+ * Local Functions Prototypes - End
+ *************************/
+
+
+namespace database {
+
+    /**
+     * Gives cursor reading reference data in pages ordered by primary key
+     * - for views of catalogs too large to be loaded (and cached) at once.
+     * Rows are the same as rows of cached entry
+     *
+     * @param data - kind of reference data
+     * @param user_id - user that data belongs to
+     * @param page_rows - maximal number of rows in one page
+     * @return cursor placed before first row
+     */
+    KeysetPager referencePager(ReferenceData data, unsigned int user_id, int page_rows)
+    {
+        return KeysetPager(referenceSelect(data),
+                           referenceFilter(data),
+                           {{":user", user_id}},
+                           {referenceKey(data)},
+                           page_rows);
+    }
+
+    /**
+     * Gives condition selecting reference data of user
+     * (table of substrates has to be aliased as "substrates")
+     *
+     * @param data - kind of reference data
+     * @return condition of rows of user (:user placeholder)
+     * - public substrates (without owner) and substrates owned by user
+     * - plants owned by user
+     */
+    QString referenceFilter(ReferenceData data)
+    {
+        switch(data)
+        {
+            case ReferenceData::Substrates:
+                return "NOT EXISTS (SELECT * FROM biogas_server_substrate_owner AS owners "
+                       "WHERE substrates.substrateID = owners.substrate_id) "
+                       "OR substrates.substrateID IN "
+                       "(SELECT substrate_id FROM biogas_server_substrate_owner AS owners "
+                       "WHERE owners.user_id = :user)";
+
+            case ReferenceData::Plants:
+            default:
+                return "owner_id = :user";
+        }
+    }
+
+    /**
+     * Creates cache of reference data shared by windows of application
+     *
+     * Note: Cache has to be used only from GUI thread
+     * (queries run in worker thread, results are stored in GUI thread)
+     *
+     * @param db_ptr - database that reference data is loaded from
+     * @param ttl_ms - time after which entry is loaded again
+     * (covers changes made by other clients of database)
+     */
+    ReferenceCache::ReferenceCache(DbManager *db_ptr, int ttl_ms):
+        m_db_ptr(db_ptr),
+        m_ttl_ms(ttl_ms),
+        m_stats{0, 0, 0, 0}
+    {}
+
+    /**
+     * Gives reference data, loading it with main connection on miss
+     * (of local replica if one is attached)
+     * For windows that need data before they are shown
+     *
+     * @param data - kind of reference data
+     * @param user_id - user that data belongs to
+     * @return cached or loaded result (result.ok is false if loading failed)
+     */
+    QueryResult ReferenceCache::fetchNow(ReferenceData data, unsigned int user_id)
+    {
+        const Key key(int(data), user_id);
+        QueryResult result;
+
+        if(mLookup(key, result))
+        {
+            return result;
+        }
+
+        const quint64 generation(mGeneration(key));
+        bool is_prepared(false);
+        QSqlQuery qry(m_db_ptr->readReplica()->preparedQuery(referenceSql(data), &is_prepared));
+
+        if(!is_prepared)
+        {
+            result.error = qry.lastError().text();
+            return result;
+        }
+
+        qry.bindValue(":user", user_id);
+
+        QElapsedTimer timer;
+        timer.start();
+
+        if(!qry.exec())
+        {
+            result.error = qry.lastError().text();
+            return result;
+        }
+
+        QSqlRecord record(qry.record());
+
+        for(int column = 0; column < record.count(); column++)
+        {
+            result.columns.append(record.fieldName(column));
+        }
+
+        while(qry.next())
+        {
+            QVector<QVariant> row(record.count());
+
+            for(int column = 0; column < record.count(); column++)
+            {
+                row[column] = qry.value(column);
+            }
+
+            result.rows.append(row);
+        }
+
+        // execution with fetching of all rows - count of rows is known only now
+        QueryProfiler::instance().record(referenceSql(data), timer.nsecsElapsed(), result.rows.size(), {":user"});
+
+        qry.finish();
+        result.ok = true;
+
+        mStore(key, result, generation);
+
+        return result;
+    }
+
+    /**
+     * Gives reference data, loading it in database worker thread on miss
+     * On hit callback is called immediately (before function returns)
+     *
+     * @param data - kind of reference data
+     * @param user_id - user that data belongs to
+     * @param context_ptr - object that callback belongs to
+     * @param on_finished - callback called in GUI thread with result
+     * @return handle of query (empty handle on hit)
+     */
+    QueryHandle ReferenceCache::fetch(ReferenceData data,
+                                      unsigned int user_id,
+                                      QObject *context_ptr,
+                                      QueryCallback on_finished)
+    {
+        const Key key(int(data), user_id);
+        QueryResult result;
+
+        if(mLookup(key, result))
+        {
+            if(on_finished)
+            {
+                on_finished(result);
+            }
+
+            return QueryHandle();
+        }
+
+        if(!m_db_ptr->isDatabaseAvailable())
+        {
+            result.error = QObject::tr("Database not initialized or could't be opened");
+
+            if(on_finished)
+            {
+                on_finished(result);
+            }
+
+            return QueryHandle();
+        }
+
+        const quint64 generation(mGeneration(key));
+
+        return m_db_ptr->readReplica()->asyncExecutor()->submit(referenceSql(data),
+                                                                {{":user", user_id}},
+                                                                context_ptr,
+                                                                [this, key, generation, on_finished](const QueryResult &result)
+        {
+            mStore(key, result, generation);
+
+            if(on_finished)
+            {
+                on_finished(result);
+            }
+        });
+    }
+
+    /**
+     * Gives reference data, loading it on miss in thread of global thread pool
+     * with its own pooled connection (see execParallel) - so it runs at the same
+     * time as other queries instead of waiting in queue of database worker thread
+     * On hit callback is called immediately (before function returns)
+     *
+     * @param data - kind of reference data
+     * @param user_id - user that data belongs to
+     * @param context_ptr - object that callback belongs to
+     * @param on_finished - callback called in GUI thread with result
+     */
+    void ReferenceCache::fetchParallel(ReferenceData data,
+                                       unsigned int user_id,
+                                       QObject *context_ptr,
+                                       QueryCallback on_finished)
+    {
+        const Key key(int(data), user_id);
+        QueryResult result;
+
+        if(mLookup(key, result))
+        {
+            if(on_finished)
+            {
+                on_finished(result);
+            }
+
+            return;
+        }
+
+        const quint64 generation(mGeneration(key));
+
+        execParallel(m_db_ptr->readReplica(),
+                     referenceSql(data),
+                     {{":user", user_id}},
+                     context_ptr,
+                     [this, key, generation, on_finished](const QueryResult &result)
+        {
+            mStore(key, result, generation);
+
+            if(on_finished)
+            {
+                on_finished(result);
+            }
+        });
+    }
+
+    /**
+     * Removes entry - has to be called after writes that change reference data
+     * Query already running for that entry will not store its result
+     *
+     * @param data - kind of reference data
+     * @param user_id - user that data belongs to
+     */
+    void ReferenceCache::invalidate(ReferenceData data, unsigned int user_id)
+    {
+        const Key key(int(data), user_id);
+
+        m_entries.remove(key);
+        m_generations[key] = mGeneration(key) + 1;
+    }
+
+    /**
+     * Removes all entries of user
+     *
+     * @param user_id - user that data belongs to
+     */
+    void ReferenceCache::invalidateUser(unsigned int user_id)
+    {
+        invalidate(ReferenceData::Plants, user_id);
+        invalidate(ReferenceData::Substrates, user_id);
+    }
+
+    /**
+     * Removes all entries
+     */
+    void ReferenceCache::clear()
+    {
+        for(auto key: m_entries.keys())
+        {
+            m_generations[key] = mGeneration(key) + 1;
+        }
+
+        m_entries.clear();
+    }
+
+    /**
+     * @param ttl_ms - time after which entry is loaded again (0 disables caching)
+     */
+    void ReferenceCache::setTtl(int ttl_ms)
+    {
+        m_ttl_ms = ttl_ms;
+    }
+
+    /**
+     * Reference Cache Statistics Getter
+     *
+     * @return hit/miss counters and count of stored entries
+     */
+    ReferenceCacheStats ReferenceCache::stats() const
+    {
+        ReferenceCacheStats result(m_stats);
+        result.size = m_entries.size();
+
+        return result;
+    }
+
+    /**
+     * Finds entry that is still fresh (expired entries are removed)
+     *
+     * @return true on hit (result is set)
+     */
+    bool ReferenceCache::mLookup(const Key &key, QueryResult &result)
+    {
+        auto entry = m_entries.find(key);
+
+        if(entry != m_entries.end())
+        {
+            if(entry->age.elapsed() < m_ttl_ms)
+            {
+                ++m_stats.hits;
+                result = entry->result;
+
+                return true;
+            }
+
+            ++m_stats.expired;
+            m_entries.erase(entry);
+        }
+
+        ++m_stats.misses;
+
+        return false;
+    }
+
+    /**
+     * Stores successfully loaded result,
+     * unless entry was invalidated after loading started
+     */
+    void ReferenceCache::mStore(const Key &key, const QueryResult &result, quint64 generation)
+    {
+        if(!result.ok || generation != mGeneration(key))
+        {
+            return;
+        }
+
+        Entry entry{result, QElapsedTimer(), generation};
+        entry.age.start();
+
+        m_entries.insert(key, entry);
+    }
+
+    /**
+     * @return count of invalidations of entry
+     */
+    quint64 ReferenceCache::mGeneration(const Key &key) const
+    {
+        return m_generations.value(key, 0);
+    }
+
+}//namespace database
+
+
+/* ************************
+ * Local Functions - Begin
+ *************************/
+
+/**
+ * @param data - kind of reference data
+ * @return SQL statement loading data (:user placeholder)
+ */
+static QString referenceSql(database::ReferenceData data)
+{
+    // Built once - projections come from schema descriptors
+    static const QString substrates(referenceSelect(database::ReferenceData::Substrates)
+                                    + " WHERE " + database::referenceFilter(database::ReferenceData::Substrates));
+
+    static const QString plants(referenceSelect(database::ReferenceData::Plants)
+                                + " WHERE " + database::referenceFilter(database::ReferenceData::Plants));
+
+    switch(data)
+    {
+        case database::ReferenceData::Substrates:
+            return substrates;
+
+        case database::ReferenceData::Plants:
+        default:
+            return plants;
+    }
+}
+
+/**
+ * @param data - kind of reference data
+ * @return SELECT of data, without WHERE
+ */
+static QString referenceSelect(database::ReferenceData data)
+{
+    switch(data)
+    {
+        case database::ReferenceData::Substrates:
+            return schema::selectFrom<schema::Substrate>("substrates");
+
+        case database::ReferenceData::Plants:
+        default:
+            return schema::selectFrom<schema::Plant>();
+    }
+}
+
+/**
+ * @param data - kind of reference data
+ * @return primary key of data, used by keyset pagination
+ */
+static database::KeysetColumn referenceKey(database::ReferenceData data)
+{
+    switch(data)
+    {
+        case database::ReferenceData::Substrates:
+            return database::KeysetColumn{"substrates.substrateID", schema::Substrate::Id};
+
+        case database::ReferenceData::Plants:
+        default:
+            return database::KeysetColumn{"PlantID", schema::Plant::Id};
+    }
+}
+
+/* ************************
+ * Local Functions - End
+ *************************/
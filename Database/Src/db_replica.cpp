@@ -0,0 +1,747 @@
+#include "Database/Inc/db_replica.h"
+#include "Database/Inc/db_migrations.h"
+#include "Database/Inc/db_profiler.h"
+#include "Database/Inc/db_reference_cache.h"
+
+#include <algorithm>
+
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QHash>
+#include <QSet>
+#include <QSqlError>
+#include <QSqlField>
+#include <QSqlIndex>
+#include <QSqlRecord>
+
+/* ************************
+ * Local Functions Prototypes - Begin
+ *************************/
+
+static bool createStateTable(QSqlDatabase &mirror, QString &error);
+
+static bool createMirrorTable(QSqlDatabase &primary,
+                              QSqlDatabase &mirror,
+                              const QString &table,
+                              QString &error);
+
+static QStringList primaryKeyColumns(QSqlDatabase &db, const QString &table);
+
+static bool readCursor(QSqlDatabase &mirror,
+                       const QString &table,
+                       QDateTime &cursor,
+                       QString &error);
+
+static bool readKeys(QSqlDatabase &db,
+                     const QString &table,
+                     const QStringList &key_columns,
+                     QHash<QString, QVariantMap> &keys,
+                     QString &error);
+
+static QString sqliteType(QVariant::Type type);
+
+/* ************************
+ * Local Functions Prototypes - End
+ *************************/
+
+
+namespace database {
+
+    /**
+     * Gives default configuration of replica
+     *
+     * Incremental pull every minute, deleted rows are detected every 10th sync
+     * (primary keys of whole tables are compared). Rows changed up to 5 s
+     * before last seen change are pulled again - covers transactions
+     * commited after rows with later timestamps were read
+     *
+     * @return configuration used by createSQLiteReplica()
+     */
+    ReplicaConfig defaultReplicaConfig()
+    {
+        return ReplicaConfig{60000, 10, 5000, 2000};
+    }
+
+    /**
+     * @return tables mirrored by replica (data that GUI only reads)
+     */
+    const QStringList &replicaTables()
+    {
+        static const QStringList tables{"biogas_server_plant",
+                                        "biogas_server_container",
+                                        "biogas_server_substrate",
+                                        "biogas_server_substrate_owner",
+                                        "biogas_server_service"};
+        return tables;
+    }
+
+
+    /**
+     * Creates sync engine of local mirror with dedicated worker thread
+     *
+     * Note: Has to be created in GUI thread - signals are emitted there.
+     * Primary database needs schema migration 2 (change tracking columns)
+     *
+     * @param primary_ptr - database of server (writes always go there)
+     * @param mirror_ptr - open local database that serves reads of mirrored tables
+     * @param config - intervals of sync
+     */
+    ReplicaSync::ReplicaSync(DbSQL primary_ptr, DbSQL mirror_ptr, const ReplicaConfig &config):
+        QObject(nullptr),
+        m_primary_ptr(primary_ptr),
+        m_mirror_ptr(mirror_ptr),
+        m_config(config),
+        m_is_ready(false),
+        m_is_sync_pending(false),
+        m_sync_count(0),
+        m_last_sync{false, "", 0, 0, {}, 0, QDateTime()},
+        m_worker_ptr(new QObject)
+    {
+        m_thread.setObjectName("DbReplica");
+        m_worker_ptr->moveToThread(&m_thread);
+
+        // finished is emitted from worker thread - leases are returned there
+        QObject::connect(&m_thread,
+                         &QThread::finished,
+                         m_worker_ptr.get(),
+                         [this]()
+                         {
+                             m_primary_lease.release();
+                             m_mirror_lease.release();
+                         },
+                         Qt::DirectConnection);
+
+        m_timer.setSingleShot(true);
+        QObject::connect(&m_timer, &QTimer::timeout, this, [this](){mSchedule(); });
+    }
+
+    ReplicaSync::~ReplicaSync()
+    {
+        stop();
+        m_primary_ptr->setReadReplica(nullptr);
+    }
+
+    /**
+     * Starts syncing - first sync is started immediately
+     * Mirror filled by previous run of application serves reads at once
+     */
+    void ReplicaSync::start()
+    {
+        if(m_thread.isRunning())
+        {
+            return;
+        }
+
+        QString error("");
+        auto mirror = m_mirror_ptr->getDatabase();
+
+        if(createStateTable(mirror, error))
+        {
+            QSqlQuery qry(mirror);
+
+            if(qry.exec("SELECT COUNT(*) FROM replica_sync_state") && qry.next()
+                    && qry.value(0).toInt() == replicaTables().size())
+            {
+                m_is_ready = true;
+                m_primary_ptr->setReadReplica(m_mirror_ptr);
+            }
+        }
+
+        m_thread.start();
+        m_timer.start(0);
+    }
+
+    /**
+     * Stops syncing (waits for sync in progress)
+     * Mirror keeps serving reads
+     */
+    void ReplicaSync::stop()
+    {
+        m_timer.stop();
+
+        m_thread.quit();
+        m_thread.wait();
+
+        m_is_sync_pending = false;
+    }
+
+    /**
+     * Starts sync without waiting for next scheduled one
+     * (e.g. after application wrote to mirrored tables of server)
+     */
+    void ReplicaSync::syncNow()
+    {
+        if(m_thread.isRunning() && !m_is_sync_pending)
+        {
+            m_timer.stop();
+            mSchedule();
+        }
+    }
+
+    /**
+     * @return true if mirror serves reads
+     */
+    bool ReplicaSync::isReady() const
+    {
+        return m_is_ready;
+    }
+
+    /**
+     * @return statistics of last finished sync
+     */
+    ReplicaSyncStats ReplicaSync::lastSync() const
+    {
+        return m_last_sync;
+    }
+
+    /**
+     * Sends sync to worker thread (called in GUI thread)
+     */
+    void ReplicaSync::mSchedule()
+    {
+        if(m_is_sync_pending)
+        {
+            return;
+        }
+
+        m_is_sync_pending = true;
+
+        const bool reconcile(m_sync_count % std::max(1, m_config.reconcile_every) == 0);
+        ++m_sync_count;
+
+        QMetaObject::invokeMethod(m_worker_ptr.get(),
+                                  [this, reconcile]()
+                                  {
+                                      ReplicaSyncStats stats(mSync(reconcile));
+
+                                      QMetaObject::invokeMethod(this,
+                                                                [this, stats]()
+                                                                {mOnSyncFinished(stats); },
+                                                                Qt::QueuedConnection);
+                                  },
+                                  Qt::QueuedConnection);
+    }
+
+    /**
+     * Pulls changes of all mirrored tables (called in worker thread)
+     *
+     * @param reconcile - true if rows deleted on server have to be looked for
+     * @return statistics of sync
+     */
+    ReplicaSyncStats ReplicaSync::mSync(bool reconcile)
+    {
+        ReplicaSyncStats stats{false, "", 0, 0, {}, 0, QDateTime()};
+        QElapsedTimer timer;
+        timer.start();
+
+        QueryProfiler::markBackgroundThread();  // sync doesn't break idle periods (see HealthMonitor)
+
+        if(!m_primary_lease.isValid())
+        {
+            m_primary_lease = m_primary_ptr->leaseConnection(m_config.sync_interval_ms);
+        }
+
+        if(!m_mirror_lease.isValid())
+        {
+            m_mirror_lease = m_mirror_ptr->leaseConnection(m_config.sync_interval_ms);
+        }
+
+        if(!m_primary_lease.isValid() || !m_mirror_lease.isValid())
+        {
+            stats.error = QObject::tr("No database connection available for replica sync");
+        }
+        else
+        {
+            QSqlDatabase primary(m_primary_lease.database());
+            QSqlDatabase mirror(m_mirror_lease.database());
+
+            stats.ok = createStateTable(mirror, stats.error);
+
+            for(const auto &table: replicaTables())
+            {
+                if(!stats.ok)
+                {
+                    break;
+                }
+
+                stats.ok = mSyncTable(primary, mirror, table, reconcile, stats);
+
+                if(!stats.ok)
+                {
+                    stats.error = table + ": " + stats.error;
+                }
+            }
+        }
+
+        stats.elapsed_ns = timer.nsecsElapsed();
+        stats.finished_at = QDateTime::currentDateTime();
+
+        return stats;
+    }
+
+    /**
+     * Pulls rows of table changed since last sync and writes them to mirror
+     * Rows are written in chunks, each chunk is one transaction.
+     * Cursor is saved with last chunk - interrupted sync is repeated from previous cursor
+     * (writes are idempotent - INSERT OR REPLACE by primary key)
+     *
+     * @return false on failure (stats.error is set)
+     */
+    bool ReplicaSync::mSyncTable(QSqlDatabase &primary,
+                                 QSqlDatabase &mirror,
+                                 const QString &table,
+                                 bool reconcile,
+                                 ReplicaSyncStats &stats)
+    {
+        const QString tracking_column(schema::change_tracking_column);
+
+        if(!primary.record(table).contains(tracking_column))
+        {
+            stats.error = QObject::tr("Table is not tracked on server - schema migration is required");
+            return false;
+        }
+
+        if(!createMirrorTable(primary, mirror, table, stats.error))
+        {
+            return false;
+        }
+
+        QDateTime cursor;
+
+        if(!readCursor(mirror, table, cursor, stats.error))
+        {
+            return false;
+        }
+
+        QSqlQuery qry(primary);
+        qry.setForwardOnly(true);
+
+        qry.prepare("SELECT * FROM " + table
+                    + (cursor.isValid() ? " WHERE " + tracking_column + " >= :since" : QString())
+                    + " ORDER BY " + tracking_column);
+
+        if(cursor.isValid())
+        {
+            qry.bindValue(":since", cursor.addMSecs(-m_config.cursor_overlap_ms));
+        }
+
+        if(!qry_helper::exec(qry))
+        {
+            stats.error = qry.lastError().text();
+            return false;
+        }
+
+        const QSqlRecord record(qry.record());
+        const int tracking_index(record.indexOf(tracking_column));
+        QStringList columns, placeholders;
+
+        for(int column = 0; column < record.count(); column++)
+        {
+            columns.append(record.fieldName(column));
+            placeholders.append(":c" + QString::number(column));
+        }
+
+        const QString upsert_sql("INSERT OR REPLACE INTO " + table + " (" + columns.join(", ")
+                                 + ") VALUES (" + placeholders.join(", ") + ")");
+
+        qry_helper::BatchWriter batch;
+        QDateTime last_change(cursor);
+        int changed_rows(0);
+
+        while(qry.next())
+        {
+            QVariantMap binds;
+
+            for(int column = 0; column < record.count(); column++)
+            {
+                binds.insert(placeholders.at(column), qry.value(column));
+            }
+
+            const QDateTime changed_at(qry.value(tracking_index).toDateTime());
+
+            if(!cursor.isValid() || changed_at > cursor)
+            {
+                ++changed_rows;     // rows of overlap window were mirrored before
+            }
+
+            if(!last_change.isValid() || changed_at > last_change)
+            {
+                last_change = changed_at;
+            }
+
+            batch.add(upsert_sql, binds);
+
+            if(batch.size() >= m_config.chunk_rows)
+            {
+                if(!batch.exec(mirror, stats.error))
+                {
+                    return false;
+                }
+
+                batch.clear();
+            }
+        }
+
+        if(qry.lastError().isValid())
+        {
+            stats.error = qry.lastError().text();
+            return false;
+        }
+
+        int deleted_rows(0);
+
+        if(reconcile)
+        {
+            const QStringList key_columns(primaryKeyColumns(primary, table));
+            QHash<QString, QVariantMap> primary_keys, mirror_keys;
+
+            if(!readKeys(primary, table, key_columns, primary_keys, stats.error)
+                    || !readKeys(mirror, table, key_columns, mirror_keys, stats.error))
+            {
+                return false;
+            }
+
+            QStringList conditions;
+            for(const auto &key_column: key_columns)
+            {
+                conditions.append(key_column + " = :" + key_column);
+            }
+
+            const QString delete_sql("DELETE FROM " + table + " WHERE " + conditions.join(" AND "));
+
+            for(auto key = mirror_keys.cbegin(); key != mirror_keys.cend(); ++key)
+            {
+                if(!primary_keys.contains(key.key()))
+                {
+                    batch.add(delete_sql, key.value());
+                    ++deleted_rows;
+                }
+            }
+        }
+
+        batch.add("INSERT OR REPLACE INTO replica_sync_state (table_name, cursor_at, synced_at) "
+                  "VALUES (:table, :cursor, :synced)",
+                  {{":table", table},
+                   {":cursor", last_change.isValid() ? last_change.toString(Qt::ISODateWithMs) : QVariant()},
+                   {":synced", QDateTime::currentDateTime().toString(Qt::ISODateWithMs)}});
+
+        if(!batch.exec(mirror, stats.error))
+        {
+            return false;
+        }
+
+        stats.rows_upserted += changed_rows;
+        stats.rows_deleted += deleted_rows;
+
+        if(changed_rows > 0 || deleted_rows > 0)
+        {
+            stats.changed_tables.append(table);
+        }
+
+        return true;
+    }
+
+    /**
+     * Publishes result of sync and schedules next one (called in GUI thread)
+     * Mirror starts serving reads after first successful sync.
+     * Cached plants and substrates are dropped when their tables changed
+     */
+    void ReplicaSync::mOnSyncFinished(const ReplicaSyncStats &stats)
+    {
+        m_is_sync_pending = false;
+        m_last_sync = stats;
+
+        if(!m_thread.isRunning())
+        {
+            return;
+        }
+
+        if(stats.ok)
+        {
+            if(!m_is_ready)
+            {
+                m_is_ready = true;
+                m_primary_ptr->setReadReplica(m_mirror_ptr);
+            }
+
+            for(const auto &table: {"biogas_server_plant", "biogas_server_substrate", "biogas_server_substrate_owner"})
+            {
+                if(stats.changed_tables.contains(table))
+                {
+                    m_primary_ptr->referenceCache()->clear();
+                    break;
+                }
+            }
+
+            emit synced(stats.rows_upserted, stats.rows_deleted);
+        }
+        else
+        {
+            emit syncFailed(stats.error);     // mirror keeps serving last synced data
+        }
+
+        m_timer.start(m_config.sync_interval_ms);
+    }
+
+
+    /**
+     * Creates local SQLite mirror of server database
+     * Mirror file is created if it does not exist
+     *
+     * Usage: keep returned object alive and call start() - reads of mirrored tables
+     * (execReadAsync, ReferenceCache) go to mirror once it's filled
+     *
+     * @param primary_ptr - initialized database of server
+     * @param path - directory of mirror file
+     * @param filename - name of mirror file (SQLite extension)
+     * @return sync engine, nullptr if mirror could not be opened
+     */
+    std::unique_ptr<ReplicaSync> createSQLiteReplica(DbSQL primary_ptr,
+                                                     const QString &path,
+                                                     const QString &filename)
+    {
+        const QString file_path(path + QDir::separator() + filename);
+
+        if(!QFile::exists(file_path))
+        {
+            QDir().mkpath(path);
+
+            QFile file(file_path);
+
+            if(!file.open(QIODevice::WriteOnly))
+            {
+                return nullptr;
+            }
+        }
+
+        DbSQL mirror_ptr(createSQLiteDatabase(path, filename, SQLiteProfile::Kiosk));
+
+        if(!mirror_ptr->initDb())
+        {
+            return nullptr;
+        }
+
+        return std::unique_ptr<ReplicaSync>(new ReplicaSync(primary_ptr, mirror_ptr, defaultReplicaConfig()));
+    }
+
+}//namespace database
+
+
+/* ************************
+ * Local Functions - Begin
+ *************************/
+
+/**
+ * Creates table with sync cursors of mirrored tables (if it does not exist)
+ *
+ * @param mirror - open connection of mirror
+ * @param error - set to error message on failure
+ * @return true if table exists
+ */
+static bool createStateTable(QSqlDatabase &mirror, QString &error)
+{
+    QSqlQuery qry(mirror);
+
+    if(!qry.exec("CREATE TABLE IF NOT EXISTS replica_sync_state ("
+                 "table_name VARCHAR(64) NOT NULL PRIMARY KEY, "
+                 "cursor_at VARCHAR(32), "
+                 "synced_at VARCHAR(32) NOT NULL)"))
+    {
+        error = qry.lastError().text();
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * Creates mirror of server table (columns and primary key of server table)
+ * with indexes used by GUI queries (see schema::migrations).
+ * Columns added on server later are added to existing mirror
+ *
+ * @param primary - open connection of server
+ * @param mirror - open connection of mirror
+ * @param table - mirrored table
+ * @param error - set to error message on failure
+ * @return true if mirror table matches server table
+ */
+static bool createMirrorTable(QSqlDatabase &primary,
+                              QSqlDatabase &mirror,
+                              const QString &table,
+                              QString &error)
+{
+    const QSqlRecord record(primary.record(table));
+    const QStringList key_columns(primaryKeyColumns(primary, table));
+
+    if(record.isEmpty() || key_columns.isEmpty())
+    {
+        error = QObject::tr("Table not found on server or has no primary key");
+        return false;
+    }
+
+    QSqlQuery qry(mirror);
+
+    if(!mirror.tables().contains(table))
+    {
+        QStringList definitions;
+
+        for(int column = 0; column < record.count(); column++)
+        {
+            definitions.append(record.fieldName(column) + " " + sqliteType(record.field(column).type()));
+        }
+
+        definitions.append("PRIMARY KEY (" + key_columns.join(", ") + ")");
+
+        if(!qry.exec("CREATE TABLE " + table + " (" + definitions.join(", ") + ")"))
+        {
+            error = qry.lastError().text();
+            return false;
+        }
+
+        for(const auto &migration: schema::migrations())
+        {
+            for(const auto &index: migration.indexes)
+            {
+                if(index.table == table
+                        && !qry.exec("CREATE INDEX IF NOT EXISTS " + index.name + " ON " + table
+                                     + " (" + index.columns.join(", ") + ")"))
+                {
+                    error = qry.lastError().text();
+                    return false;
+                }
+            }
+        }
+
+        return true;
+    }
+
+    const QSqlRecord mirror_record(mirror.record(table));
+
+    for(int column = 0; column < record.count(); column++)
+    {
+        if(!mirror_record.contains(record.fieldName(column))
+                && !qry.exec("ALTER TABLE " + table + " ADD COLUMN " + record.fieldName(column)
+                             + " " + sqliteType(record.field(column).type())))
+        {
+            error = qry.lastError().text();
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @param db - open connection
+ * @param table - table name
+ * @return names of primary key columns (empty if table has no primary key)
+ */
+static QStringList primaryKeyColumns(QSqlDatabase &db, const QString &table)
+{
+    const QSqlIndex index(db.primaryIndex(table));
+    QStringList columns;
+
+    for(int column = 0; column < index.count(); column++)
+    {
+        columns.append(index.fieldName(column));
+    }
+
+    return columns;
+}
+
+/**
+ * Reads time of last change mirrored from table
+ *
+ * @param cursor - set to time of last change (invalid if table was never synced)
+ * @return false on failure (error is set)
+ */
+static bool readCursor(QSqlDatabase &mirror,
+                       const QString &table,
+                       QDateTime &cursor,
+                       QString &error)
+{
+    QSqlQuery qry(mirror);
+
+    qry.prepare("SELECT cursor_at FROM replica_sync_state WHERE table_name = :table");
+    qry.bindValue(":table", table);
+
+    if(!qry.exec())
+    {
+        error = qry.lastError().text();
+        return false;
+    }
+
+    cursor = qry.next() ? QDateTime::fromString(qry.value(0).toString(), Qt::ISODateWithMs)
+                        : QDateTime();
+
+    return true;
+}
+
+/**
+ * Reads primary keys of all rows of table
+ *
+ * @param keys - set to map: key as text -> binds of key columns (":column")
+ * @return false on failure (error is set)
+ */
+static bool readKeys(QSqlDatabase &db,
+                     const QString &table,
+                     const QStringList &key_columns,
+                     QHash<QString, QVariantMap> &keys,
+                     QString &error)
+{
+    QSqlQuery qry(db);
+    qry.setForwardOnly(true);
+
+    if(!qry.exec("SELECT " + key_columns.join(", ") + " FROM " + table))
+    {
+        error = qry.lastError().text();
+        return false;
+    }
+
+    while(qry.next())
+    {
+        QStringList text;
+        QVariantMap binds;
+
+        for(int column = 0; column < key_columns.size(); column++)
+        {
+            text.append(qry.value(column).toString());
+            binds.insert(':' + key_columns.at(column), qry.value(column));
+        }
+
+        keys.insert(text.join(QChar(0x1f)), binds);
+    }
+
+    return true;
+}
+
+/**
+ * @param type - type of column reported by server driver
+ * @return SQLite type affinity for column of mirror
+ */
+static QString sqliteType(QVariant::Type type)
+{
+    switch(type)
+    {
+        case QVariant::Bool:
+        case QVariant::Int:
+        case QVariant::UInt:
+        case QVariant::LongLong:
+        case QVariant::ULongLong:
+            return "INTEGER";
+
+        case QVariant::Double:
+            return "REAL";
+
+        case QVariant::ByteArray:
+            return "BLOB";
+
+        default:
+            return "TEXT";
+    }
+}
+
+/* ************************
+ * Local Functions - End
+ *************************/
@@ -0,0 +1,27 @@
+#include "Database/Inc/db_schema.h"
+
+/*
+ * Definitions of static members of descriptors
+ * (arrays are indexed at runtime by projection(), so they need storage)
+ */
+namespace schema{
+
+    constexpr const char *Profile::table;
+    constexpr const char *Profile::columns[];
+
+    constexpr const char *Address::table;
+    constexpr const char *Address::columns[];
+
+    constexpr const char *Phone::table;
+    constexpr const char *Phone::columns[];
+
+    constexpr const char *Plant::table;
+    constexpr const char *Plant::columns[];
+
+    constexpr const char *Substrate::table;
+    constexpr const char *Substrate::columns[];
+
+    constexpr const char *Service::table;
+    constexpr const char *Service::columns[];
+
+}//namespace schema
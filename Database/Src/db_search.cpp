@@ -0,0 +1,384 @@
+#include "Database/Inc/db_search.h"
+#include "Database/Inc/db_migrations.h"
+#include "Database/Inc/db_schema.h"
+
+#include <algorithm>
+#include <vector>
+
+#include <QRegularExpression>
+
+/* ************************
+ * Local Functions Prototypes - Begin
+ *************************/
+
+static QStringList searchWords(const QString &text);
+
+static int wordPosition(const QString &name, const QString &word);
+
+/* ************************
+ * Local Functions Prototypes - End
+ *************************/
+
+
+namespace database {
+
+    /**
+     * Gives statement searching substrates available to user with full-text index
+     * - SQLite: prefix query of FTS5 table ("ma"* "si"*), ranked by bm25
+     * - MySQL: boolean mode prefix query (+ma* +si*), ranked by relevance.
+     *   Words shorter than innodb_ft_min_token_size (3) aren't indexed -
+     *   such text is matched as prefix of name (LIKE 'ma%') with B-tree index
+     *
+     * @param db - connection that statement will be executed on
+     * @param text - text typed by user
+     * @param user_id - user that searches
+     * @param limit - maximal number of matches
+     * @param binds - set to values of placeholders of statement
+     * @return SQL statement (empty if text has no words)
+     */
+    QString substrateSearchSql(const QSqlDatabase &db,
+                               const QString &text,
+                               unsigned int user_id,
+                               int limit,
+                               QVariantMap &binds)
+    {
+        const QStringList words(searchWords(text));
+        const QString select(schema::selectFrom<schema::Substrate>("substrates"));
+        const QString filter(referenceFilter(ReferenceData::Substrates));
+
+        binds.clear();
+
+        if(words.isEmpty())
+        {
+            return QString();
+        }
+
+        binds.insert(":user", user_id);
+
+        if(db.driverName() != "QMYSQL")
+        {
+            const QString table(schema::substrate_search_table);
+            QStringList terms;
+
+            for(const auto &word: words)
+            {
+                terms.append('"' + word + "\"*");
+            }
+
+            binds.insert(":match", terms.join(' '));
+
+            return select + " JOIN " + table + " ON " + table + ".rowid = substrates.substrateID"
+                    + " WHERE " + table + " MATCH :match AND (" + filter + ")"
+                    + " ORDER BY " + table + ".rank"
+                    + " LIMIT " + QString::number(limit);
+        }
+
+        const bool indexed(std::all_of(words.begin(), words.end(),
+                                       [](const QString &word) {return word.size() >= 3; }));
+
+        if(!indexed)
+        {
+            QString prefix(text.trimmed());
+            prefix.replace('\\', "\\\\").replace('%', "\\%").replace('_', "\\_");
+
+            binds.insert(":prefix", prefix + '%');
+
+            return select + " WHERE substrates.name LIKE :prefix AND (" + filter + ")"
+                    + " ORDER BY substrates.name"
+                    + " LIMIT " + QString::number(limit);
+        }
+
+        QStringList terms;
+
+        for(const auto &word: words)
+        {
+            terms.append('+' + word + '*');
+        }
+
+        // Placeholders are bound once each - the same text is used for matching and ranking
+        binds.insert(":match", terms.join(' '));
+        binds.insert(":rank_match", terms.join(' '));
+
+        return select + " WHERE MATCH (substrates.name) AGAINST (:match IN BOOLEAN MODE) AND (" + filter + ")"
+                + " ORDER BY MATCH (substrates.name) AGAINST (:rank_match IN BOOLEAN MODE) DESC, substrates.name"
+                + " LIMIT " + QString::number(limit);
+    }
+
+
+    /**
+     * Creates search of substrates available to user
+     *
+     * @param db_ptr - database searched (local replica if attached)
+     * @param user_id - user that searches
+     * @param limit - maximal number of matches
+     */
+    SubstrateSearch::SubstrateSearch(DbSQL db_ptr, unsigned int user_id, int limit):
+        m_db_ptr(db_ptr),
+        m_user_id(user_id),
+        m_limit(limit),
+        m_detected_ptr(nullptr),
+        m_backend(SearchBackend::Memory)
+    {}
+
+    /**
+     * Searches substrates matching text
+     * Full-text query runs in database worker thread, search in memory
+     * calls callback immediately (before function returns)
+     *
+     * Note: Database searched is resolved on every call (local replica if attached),
+     * backend is detected first when it differs from database detected before
+     *
+     * @param text - text typed by user
+     * @param context_ptr - object that callback belongs to
+     * @param on_finished - callback called in GUI thread with matches (best first)
+     * @return handle of query (empty handle for search in memory)
+     */
+    QueryHandle SubstrateSearch::search(const QString &text,
+                                        QObject *context_ptr,
+                                        QueryCallback on_finished)
+    {
+        QueryResult result;
+
+        if(!(m_db_ptr && m_db_ptr->isDatabaseAvailable()))
+        {
+            result.error = QObject::tr("Database not initialized or could't be opened");
+        }
+        else if(m_db_ptr->readReplica() != m_detected_ptr)
+        {
+            return mDetectBackend(m_db_ptr->readReplica(), text, context_ptr, on_finished);
+        }
+        else if(m_backend == SearchBackend::FullText)
+        {
+            QVariantMap binds;
+            const QString sql(substrateSearchSql(m_detected_ptr->getDatabase(), text, m_user_id, m_limit, binds));
+
+            if(!sql.isEmpty())
+            {
+                return m_detected_ptr->asyncExecutor()->submit(sql, binds, context_ptr, on_finished);
+            }
+
+            result.columns = schema::projection<schema::Substrate>().split(", ");
+            result.ok = true;
+        }
+        else if(mLoadCatalog(result.error))
+        {
+            result = mSearchMemory(searchWords(text));
+        }
+
+        if(on_finished)
+        {
+            on_finished(result);
+        }
+
+        return QueryHandle();
+    }
+
+    /**
+     * Backend Getter
+     *
+     * @return FullText if database searched last has full-text index of substrates
+     * (Memory until first search detects it)
+     */
+    SearchBackend SubstrateSearch::backend() const
+    {
+        return m_backend;
+    }
+
+    /**
+     * Checks in database worker thread if searched database has full-text index
+     * of substrates (replicas and SQLite built without FTS5 don't have it),
+     * then runs search with detected backend
+     *
+     * @param searched_ptr - database searched (local replica if attached)
+     * @param text - text typed by user
+     * @param context_ptr - object that callback belongs to
+     * @param on_finished - callback of search (gets error if detection failed)
+     * @return handle of detection query
+     */
+    QueryHandle SubstrateSearch::mDetectBackend(DbManager *searched_ptr,
+                                                const QString &text,
+                                                QObject *context_ptr,
+                                                QueryCallback on_finished)
+    {
+        const bool is_mysql(searched_ptr->getDatabase().driverName() == "QMYSQL");
+        const QString sql(is_mysql ? "SELECT COUNT(*) FROM information_schema.statistics "
+                                     "WHERE table_schema = DATABASE() AND table_name = 'biogas_server_substrate' "
+                                     "AND index_name = :name"
+                                   : "SELECT COUNT(*) FROM sqlite_master WHERE type = 'table' AND name = :name");
+        const QString name(is_mysql ? schema::substrate_search_index : schema::substrate_search_table);
+
+        return searched_ptr->asyncExecutor()->submit(sql,
+                                                     {{":name", name}},
+                                                     context_ptr,
+                                                     [this, searched_ptr, text, context_ptr, on_finished](const QueryResult &result)
+        {
+            if(!result.ok)
+            {
+                if(on_finished)
+                {
+                    on_finished(result);
+                }
+
+                return;
+            }
+
+            m_detected_ptr = searched_ptr;
+            m_backend = !result.isEmpty() && result.value<int>(0, 0) > 0 ? SearchBackend::FullText
+                                                                         : SearchBackend::Memory;
+
+            // Replica attached while detection ran is detected again by this search
+            search(text, context_ptr, on_finished);
+        });
+    }
+
+    /**
+     * Loads catalog of user (once) and folds its names for matching
+     *
+     * @return false if catalog couldn't be loaded (error is set)
+     */
+    bool SubstrateSearch::mLoadCatalog(QString &error)
+    {
+        if(m_catalog.ok)
+        {
+            return true;
+        }
+
+        m_catalog = m_db_ptr->referenceCache()->fetchNow(ReferenceData::Substrates, m_user_id);
+
+        if(!m_catalog.ok)
+        {
+            error = m_catalog.error;
+            return false;
+        }
+
+        m_names.resize(m_catalog.rows.size());
+
+        for(int row = 0; row < m_catalog.rows.size(); row++)
+        {
+            m_names[row] = m_catalog.rows.at(row).value(schema::Substrate::Name).toString().toCaseFolded();
+        }
+
+        return true;
+    }
+
+    /**
+     * Searches catalog in memory
+     * Rows are ranked by positions of matched words in name, then by length of name
+     *
+     * @param words - folded words of text (see searchWords)
+     * @return best matches (at most limit rows)
+     */
+    QueryResult SubstrateSearch::mSearchMemory(const QStringList &words)
+    {
+        struct Match
+        {
+            int rank;
+            int length;
+            int row;
+
+            bool operator< (const Match &other) const
+            {
+                return rank != other.rank ? rank < other.rank
+                                          : length != other.length ? length < other.length
+                                                                   : row < other.row;
+            }
+        };
+
+        std::vector<Match> matches;
+
+        if(!words.isEmpty())
+        {
+            for(int row = 0; row < m_names.size(); row++)
+            {
+                const QString &name(m_names.at(row));
+                int rank(0);
+
+                for(const auto &word: words)
+                {
+                    const int position(wordPosition(name, word));
+
+                    if(position < 0)
+                    {
+                        rank = -1;
+                        break;
+                    }
+
+                    rank += position;
+                }
+
+                if(rank >= 0)
+                {
+                    matches.push_back(Match{rank, name.size(), row});
+                }
+            }
+        }
+
+        const size_t count(std::min(matches.size(), size_t(std::max(0, m_limit))));
+        std::partial_sort(matches.begin(), matches.begin() + count, matches.end());
+
+        QueryResult result;
+        result.columns = m_catalog.columns;
+        result.rows.reserve(int(count));
+
+        for(size_t match = 0; match < count; match++)
+        {
+            result.rows.append(m_catalog.rows.at(matches[match].row));
+        }
+
+        result.ok = true;
+
+        return result;
+    }
+
+}//namespace database
+
+
+/* ************************
+ * Local Functions - Begin
+ *************************/
+
+/**
+ * Splits text typed by user into folded words
+ * (characters other than letters and digits separate words, so
+ * words are safe to be put into full-text queries)
+ *
+ * @return words of text
+ */
+static QStringList searchWords(const QString &text)
+{
+    static const QRegularExpression word_regex("\\w+", QRegularExpression::UseUnicodePropertiesOption);
+
+    QStringList words;
+    auto match = word_regex.globalMatch(text.toCaseFolded());
+
+    while(match.hasNext())
+    {
+        words.append(match.next().captured(0));
+    }
+
+    return words;
+}
+
+/**
+ * Finds word of name that begins with given word
+ *
+ * @param name - folded name of substrate
+ * @param word - folded word of text
+ * @return position of word in name, -1 if there's no such word
+ */
+static int wordPosition(const QString &name, const QString &word)
+{
+    for(int position = name.indexOf(word); position >= 0; position = name.indexOf(word, position + 1))
+    {
+        if(position == 0 || !name.at(position - 1).isLetterOrNumber())
+        {
+            return position;
+        }
+    }
+
+    return -1;
+}
+
+/* ************************
+ * Local Functions - End
+ *************************/
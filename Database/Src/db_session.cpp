@@ -0,0 +1,99 @@
+#include "Database/Inc/db_session.h"
+#include "Database/Inc/db_schema.h"
+
+#include <memory>
+
+namespace database {
+
+    SessionData::SessionData():
+        user_id(0)
+    {}
+
+    /**
+     * @return true if every part of session has been loaded
+     * (window should load part that failed by itself)
+     */
+    bool SessionData::isComplete() const
+    {
+        return profile.ok && address.ok && phones.ok && plants.ok && substrates.ok;
+    }
+
+    /**
+     * Loads everything that first windows of session need, right after authentication:
+     * profile, address and phone numbers of user, plants and substrate catalog.
+     *
+     * All five queries run at the same time, each in thread of global thread pool
+     * with its own connection leased from pool (see execParallel), so first paint
+     * waits about as long as the slowest of them, not for their sum. Plants and catalog
+     * go through ReferenceCache (later windows get them from cache, and they are read
+     * from local replica if one is attached). Results are joined in GUI thread -
+     * callback is called once, when the last of them ends
+     *
+     * @param db_ptr - pointer to database
+     * @param user_id - authenticated user
+     * @param context_ptr - object that callback belongs to (usually Login window),
+     * if it's destroyed before loading ends - callback is not called
+     * @param on_ready - callback called in GUI thread with loaded data
+     * (parts that failed have result.ok set to false)
+     */
+    void bootstrapSession(DbSQL &db_ptr,
+                          unsigned int user_id,
+                          QObject *context_ptr,
+                          SessionCallback on_ready)
+    {
+        struct Pending
+        {
+            SessionData session;
+            int remaining;
+        };
+
+        auto pending_ptr = std::make_shared<Pending>();
+        pending_ptr->session.user_id = user_id;
+        pending_ptr->remaining = 5;
+
+        // Each part stores its result, the last one hands whole session over
+        auto store = [pending_ptr, on_ready](QueryResult SessionData::*part)
+        {
+            return [pending_ptr, on_ready, part](const QueryResult &result)
+            {
+                pending_ptr->session.*part = result;
+
+                if(--pending_ptr->remaining == 0 && on_ready)
+                {
+                    on_ready(pending_ptr->session);
+                }
+            };
+        };
+
+        const QVariantMap user{{":user", user_id}};
+
+        execParallel(db_ptr.get(),
+                     schema::selectFrom<schema::Profile>() + " WHERE userID = :user",
+                     user, context_ptr, store(&SessionData::profile));
+
+        execParallel(db_ptr.get(),
+                     schema::selectFrom<schema::Address>() + " WHERE userID_id = :user",
+                     user, context_ptr, store(&SessionData::address));
+
+        execParallel(db_ptr.get(),
+                     schema::selectFrom<schema::Phone>() + " WHERE owner_id = :user",
+                     user, context_ptr, store(&SessionData::phones));
+
+        if(db_ptr && db_ptr->isDatabaseAvailable())
+        {
+            auto cache_ptr = db_ptr->referenceCache();
+
+            cache_ptr->fetchParallel(ReferenceData::Plants, user_id, context_ptr, store(&SessionData::plants));
+            cache_ptr->fetchParallel(ReferenceData::Substrates, user_id, context_ptr, store(&SessionData::substrates));
+        }
+        else
+        {
+            QueryResult result;
+            result.error = QObject::tr("Database not initialized or could't be opened");
+
+            store(&SessionData::plants)(result);
+            store(&SessionData::substrates)(result);
+        }
+    }
+
+}//namespace database
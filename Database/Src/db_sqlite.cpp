@@ -1,7 +1,8 @@
 #include "Database/Inc/db_sqlite.h"
-#include <Database/Inc/db_messages.h>
 
 #include <QSqlError>
+#include <QSqlQuery>
+#include <QStringList>
 #include <QDir>
 #include <QRegularExpression>
 
@@ -49,20 +50,13 @@ bool DbSQLite::initDb() noexcept
 
         if(!QSqlDatabase::contains(m_db_name))
         {
-            auto db = QSqlDatabase::addDatabase("QSQLITE", m_db_name);
-
-            db.setDatabaseName(m_config.db_path + QDir::separator() + m_config.db_name);
-
-
-            if(!db.open())
+            if(!addConnection(m_db_name, m_last_error))
             {
-                m_last_error = db.lastError().text();
-
-                db_msg::showDbCriticalError(QObject::tr("Could not establish connection with database.\n")
-                                                        + m_last_error);
+                reportError(QObject::tr("Could not establish connection with database.\n")
+                            + m_last_error);
             }
 
-            m_available = db.isOpen();
+            m_available = QSqlDatabase::database(m_db_name, false).isOpen();
         }
         else
         {
@@ -71,6 +65,8 @@ bool DbSQLite::initDb() noexcept
             m_available = !(!db.isOpen() && !db.open());
         }
 
+        m_owner_thread_ptr = QThread::currentThread();
+
         return m_available;
     }
 
@@ -82,7 +78,7 @@ bool DbSQLite::initDb() noexcept
         }
         else
         {
-            db_msg::showDbCriticalError(e.what());
+            reportError(e.what());
         }
 
         return false;
@@ -105,7 +101,7 @@ bool DbSQLite::validateDb()
         m_last_error = QObject::tr("Unable to find database file: \n");
         m_last_error += m_config.db_path + QDir::separator() + m_config.db_name;
 
-        db_msg::showDbCriticalError(m_last_error);
+        reportError(m_last_error);
 
         return false;
     }
@@ -126,31 +122,151 @@ bool DbSQLite::validateDb()
 bool DbSQLite::badConfigHandler() noexcept
 {
     bool result(false);
+    QVariant db_name(m_config.db_name),
+             db_path(m_config.db_path);
 
     if (existDbFile(m_config))
     {
         if(!isDbNameValid(m_config))
         {
-            result = db_msg::showInputDialogText("Database filename",
-                                                 m_config.db_name);
-            if(result)
-            {
-                m_db_name = m_config.db_name;
-            }
+            result = promptConfig("Database filename", db_name);
         }
     }
     else
     {
-        result = db_msg::showInputDialogText("Database filename",
-                                             m_config.db_name);
+        result = promptConfig("Database filename", db_name);
 
-        result &= db_msg::showInputDialogText("Database path",
-                                              m_config.db_path);
+        result &= promptConfig("Database path", db_path);
     }
 
+    m_config.db_name = db_name.toString();
+    m_config.db_path = db_path.toString();
+    m_db_name = m_config.db_name;
+
     return result;
 }
 
+/**
+ * Adds and opens connection to database file
+ * and applies pragmas of configured performance profile
+ *
+ * Note: Used for main connection and for connections of worker threads pool.
+ * Connection can be used only in thread that called this function
+ *
+ * @param connection_name - name of connection in QSqlDatabase registry
+ * @param error - set to error message if connection could not be opened
+ * @return true if connection has been opened
+ */
+bool DbSQLite::addConnection(const QString &connection_name, QString &error) noexcept
+{
+    auto db = QSqlDatabase::addDatabase("QSQLITE", connection_name);
+
+    db.setDatabaseName(m_config.db_path + QDir::separator() + m_config.db_name);
+
+    SQLitePragmas pragmas(sqlite_profile::pragmas(m_config.profile));
+
+    db.setConnectOptions("QSQLITE_BUSY_TIMEOUT=" + QString::number(pragmas.busy_timeout));
+
+    if(!db.open())
+    {
+        error = db.lastError().text();
+        return false;
+    }
+
+    return sqlite_profile::apply(db, pragmas, error);
+}
+
+
+
+namespace sqlite_profile{
+
+/**
+ * Gives pragma set of performance profile
+ *
+ * Kiosk - WAL lets readers work while writing, large page cache and mmap
+ *  serve repeated lookups from memory. Default - app mostly reads
+ * Ingest - WAL without syncing (commit can be lost on power failure,
+ *  database stays consistent). For bulk loads of data that can be pulled again
+ * Durable - rollback journal with full sync, no mmap.
+ *  Safest choice for network drives and unreliable power
+ *
+ * @param profile - performance profile
+ * @return pragmas applied on opening connection
+ */
+SQLitePragmas pragmas(SQLiteProfile profile)
+{
+    switch(profile)
+    {
+        case SQLiteProfile::Ingest:
+            return SQLitePragmas{"WAL", "OFF", 64ll * 1024 * 1024, -32768, "MEMORY", 10000};
+
+        case SQLiteProfile::Durable:
+            return SQLitePragmas{"DELETE", "FULL", 0, -8192, "DEFAULT", 30000};
+
+        case SQLiteProfile::Kiosk:
+        default:
+            return SQLitePragmas{"WAL", "NORMAL", 256ll * 1024 * 1024, -65536, "MEMORY", 5000};
+    }
+}
+
+/**
+ * @param profile - performance profile
+ * @return name of profile (for logs and benchmarks)
+ */
+QString name(SQLiteProfile profile)
+{
+    switch(profile)
+    {
+        case SQLiteProfile::Ingest:
+            return "ingest";
+
+        case SQLiteProfile::Durable:
+            return "durable";
+
+        case SQLiteProfile::Kiosk:
+        default:
+            return "kiosk";
+    }
+}
+
+/**
+ * Applies pragmas on open connection
+ * Note: Except journal_mode (stored in file) pragmas work per connection,
+ * so they have to be applied on every opened connection
+ *
+ * @param db - open SQLite connection
+ * @param pragmas - pragma set to apply
+ * @param error - set to error message if any pragma failed
+ * @return true if all pragmas were applied
+ */
+bool apply(QSqlDatabase &db,
+           const SQLitePragmas &pragmas,
+           QString &error)
+{
+    const QStringList statements{
+        "PRAGMA journal_mode = " + pragmas.journal_mode,
+        "PRAGMA synchronous = " + pragmas.synchronous,
+        "PRAGMA mmap_size = " + QString::number(pragmas.mmap_size),
+        "PRAGMA cache_size = " + QString::number(pragmas.cache_size),
+        "PRAGMA temp_store = " + pragmas.temp_store,
+        "PRAGMA busy_timeout = " + QString::number(pragmas.busy_timeout)
+    };
+
+    QSqlQuery qry(db);
+
+    for(const auto &statement: statements)
+    {
+        if(!qry.exec(statement))
+        {
+            error = qry.lastError().text();
+            return false;
+        }
+    }
+
+    return true;
+}
+
+}//namespace sqlite_profile
 
 
 /* ************************
@@ -0,0 +1,134 @@
+#include "Database/Inc/db_statement_cache.h"
+
+#include <algorithm>
+
+#include <QSqlDatabase>
+
+/**
+ * Creates LRU cache of prepared statements for single connection
+ *
+ * Note: As connection - cache can be used only from thread that owns connection
+ *
+ * @param connection_name - name of connection in QSqlDatabase registry
+ * @param capacity - maximal count of prepared statements kept by cache
+ */
+StatementCache::StatementCache(const QString &connection_name, int capacity):
+    m_connection_name(connection_name),
+    m_capacity(std::max(1, capacity)),
+    m_hits(0),
+    m_misses(0),
+    m_evictions(0),
+    m_size(0)
+{}
+
+StatementCache::~StatementCache()
+{
+    clear();
+}
+
+/**
+ * Gives prepared statement for given SQL text
+ *
+ * On hit - statement prepared earlier is reused (only parameters have to be bound again),
+ * on miss - statement is prepared and stored in cache.
+ * Note: Returned query shares handle with cache - it has to be used
+ * (and its results read) before the same SQL is requested again.
+ * Cached statements are forward only
+ *
+ * @param sql - SQL statement with placeholders
+ * @param ok - if not null - set to false when statement could not be prepared
+ * @return prepared query (on failure - query with lastError set, not cached)
+ */
+QSqlQuery StatementCache::prepared(const QString &sql, bool *ok)
+{
+    auto cached = m_index.find(sql);
+
+    if(cached != m_index.end())
+    {
+        ++m_hits;
+
+        m_lru.splice(m_lru.begin(), m_lru, cached.value());
+
+        QSqlQuery qry(m_lru.front().qry);
+        qry.finish();   //releases result of previous execution
+
+        if(ok)
+        {
+            *ok = true;
+        }
+
+        return qry;
+    }
+
+    ++m_misses;
+
+    QSqlQuery qry(QSqlDatabase::database(m_connection_name, false));
+    qry.setForwardOnly(true);
+
+    bool is_prepared(qry.prepare(sql));
+
+    if(ok)
+    {
+        *ok = is_prepared;
+    }
+
+    if(is_prepared)
+    {
+        m_lru.push_front(Entry{sql, qry});
+        m_index.insert(sql, m_lru.begin());
+
+        mEvictOverCapacity();
+        m_size = int(m_lru.size());
+    }
+
+    return qry;
+}
+
+/**
+ * Statistics Getter
+ * Note: Counters can be read from any thread
+ *
+ * @return hit/miss/eviction counters and current size of cache
+ */
+StatementCacheStats StatementCache::stats() const
+{
+    return StatementCacheStats{m_hits, m_misses, m_evictions, m_size, m_capacity};
+}
+
+/**
+ * Changes capacity of cache - least recently used statements over it are released
+ *
+ * @param capacity - maximal count of prepared statements kept by cache
+ */
+void StatementCache::setCapacity(int capacity)
+{
+    m_capacity = std::max(1, capacity);
+
+    mEvictOverCapacity();
+    m_size = int(m_lru.size());
+}
+
+/**
+ * Releases all prepared statements
+ * Note: Has to be called before connection is removed
+ */
+void StatementCache::clear()
+{
+    m_index.clear();
+    m_lru.clear();
+    m_size = 0;
+}
+
+/**
+ * Releases least recently used statements until cache fits its capacity
+ */
+void StatementCache::mEvictOverCapacity()
+{
+    while(int(m_lru.size()) > m_capacity)
+    {
+        m_index.remove(m_lru.back().sql);
+        m_lru.pop_back();
+
+        ++m_evictions;
+    }
+}
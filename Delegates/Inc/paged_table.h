@@ -0,0 +1,40 @@
+#ifndef PAGED_TABLE_H
+#define PAGED_TABLE_H
+
+#include "Database/Inc/database.h"
+#include "Database/Inc/db_paging.h"
+#include "Delegates/Inc/result_table.h"
+
+namespace sqlModels {
+
+    class PagedTable: public ResultTable
+    {
+        Q_OBJECT
+
+    public:
+        PagedTable(QObject *parent_ptr = nullptr);
+        ~PagedTable();
+
+        void setQuery(DbSQL db_ptr, const database::KeysetPager &pager);
+        void setResult(const database::QueryResult &result);
+        void cancel();
+
+        bool isLoading() const;
+
+        bool canFetchMore(const QModelIndex &parent) const override;
+        void fetchMore(const QModelIndex &parent) override;
+
+    signals:
+        void pageLoaded(int rows);
+        void pageFailed(const QString &error);
+
+    private:
+        DbSQL m_db_ptr;
+        database::KeysetPager m_pager;
+        database::QueryHandle m_page_qry;
+        bool m_loading;     //set until page is delivered (handle is finished earlier, in worker thread)
+    };
+
+} //namespace sqlModels
+
+#endif // PAGED_TABLE_H
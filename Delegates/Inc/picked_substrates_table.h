@@ -0,0 +1,65 @@
+#ifndef PICKED_SUBSTRATES_TABLE_H
+#define PICKED_SUBSTRATES_TABLE_H
+
+#include <QAbstractTableModel>
+#include <QHash>
+#include <QVector>
+#include <vector>
+
+#include "Calculation/Inc/biogas_yield.h"
+#include "Calculation/Inc/yield_kernel.h"
+#include "Database/Inc/db_schema.h"
+
+namespace sqlModels {
+
+    struct PickedSubstrate
+    {
+        schema::Substrate::Row substrate;
+        double amount;          //fresh mass fed to plant
+        double ts;              //total solids [% of fresh mass]
+    };
+
+    class PickedSubstratesTable final: public QAbstractTableModel
+    {
+        Q_OBJECT
+
+    public:
+        // Columns of schema::Substrate followed by amount and TS
+        enum Column {Amount = schema::Substrate::ColumnCount, Ts, ColumnCount};
+
+        PickedSubstratesTable(QObject *parent_ptr = nullptr);
+
+        void appendRows(const std::vector<PickedSubstrate> &rows);
+        bool contains(qlonglong substrate_id) const;
+        void clear();
+
+        yield::Result totals() const;
+        yield::YieldBuffers buffers() const;
+
+        int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+        int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+
+        QVariant data(const QModelIndex &item, int role = Qt::DisplayRole) const override;
+        QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+        bool removeRows(int row, int count, const QModelIndex &parent = QModelIndex()) override;
+
+    private:
+        // One contiguous array per column, row is index in each of them
+        QVector<qlonglong> m_ids;
+        QVector<QString> m_names;
+        QVector<double> m_ots;
+        QVector<double> m_biogas;
+        QVector<double> m_methane;
+        QVector<double> m_amounts;
+        QVector<double> m_ts;
+
+        QHash<qlonglong, int> m_rows_by_id;
+        yield::MixTotals m_totals;      //parts are indexed like rows
+
+        void mReindex(int first_row);
+    };
+
+} //namespace sqlModels
+
+#endif // PICKED_SUBSTRATES_TABLE_H
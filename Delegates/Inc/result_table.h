@@ -0,0 +1,49 @@
+#ifndef RESULT_TABLE_H
+#define RESULT_TABLE_H
+
+#include <QAbstractTableModel>
+#include <QHash>
+#include <QSet>
+
+#include "Database/Inc/db_async.h"
+
+namespace sqlModels {
+
+    class ResultTable: public QAbstractTableModel
+    {
+        Q_OBJECT
+
+    public:
+        ResultTable(QObject *parent_ptr = nullptr);
+
+        void setResult(const database::QueryResult &result);
+        void appendRows(const database::QueryResult &chunk);
+        const database::QueryResult &result() const;
+        void clear();
+
+        void setEditableColumn(int column, bool editable = true);
+
+        int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+        int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+
+        QVariant data(const QModelIndex &item, int role = Qt::DisplayRole) const override;
+        bool setData(const QModelIndex &item, const QVariant &value, int role = Qt::EditRole) override;
+        Qt::ItemFlags flags(const QModelIndex &item) const override;
+
+        QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+        bool setHeaderData(int section, Qt::Orientation orientation, const QVariant &value, int role = Qt::EditRole) override;
+
+    signals:
+        void cellEdited(int row, int column, const QVariant &value);
+
+    protected:
+        database::QueryResult m_result;
+
+    private:
+        QHash<int, QVariant> m_headers;
+        QSet<int> m_editable_columns;
+    };
+
+} //namespace sqlModels
+
+#endif // RESULT_TABLE_H
@@ -1,14 +1,15 @@
 #ifndef SERVICE_DELEGATE_H
 #define SERVICE_DELEGATE_H
 
-#include <QSqlQueryModel>
-#include <memory>
+#include "Delegates/Inc/paged_table.h"
 
-namespace sqlModels {
+#include <QBitArray>
+#include <QDate>
+#include <QTimer>
 
-    class ServiceTableAttorney;
+namespace sqlModels {
 
-    class ServiceTable final: public QSqlQueryModel
+    class ServiceTable final: public PagedTable
     {
         Q_OBJECT
 
@@ -18,16 +19,24 @@ namespace sqlModels {
         QVariant data(const QModelIndex &item, int role) const override;
 
     private:
-        std::shared_ptr<ServiceTableAttorney> attorney_ptr;
-    };
+        // Computed once per loaded row, so painting doesn't parse or compare anything
+        QBitArray m_done;
+        QBitArray m_overdue;    //not done and date has passed
+        QDate m_today;          //date that m_overdue was computed for
 
-    class ServiceTableAttorney final
-    {
-        std::vector<int> selected_rows;
-        friend class ServiceTable;
+        const QVariant m_yes;
+        const QVariant m_no;
+        const QVariant m_overdue_color;
+
+        QTimer m_midnight_timer;
+
+        void mComputeRows(int first, int last);
+        void mComputeOverdue(int first, int last);
+        void mOnMidnight();
+        void mScheduleMidnight();
     };
 
 } //namespace sqlModels
 
 
-#endif // ServiceSQLModel
+#endif // SERVICE_DELEGATE_H
@@ -0,0 +1,109 @@
+#include "Delegates/Inc/paged_table.h"
+
+namespace sqlModels {
+
+PagedTable::PagedTable(QObject *parent_ptr):
+    ResultTable(parent_ptr),
+    m_loading(false)
+{
+}
+
+PagedTable::~PagedTable()
+{
+    m_page_qry.cancel();
+}
+
+/**
+  * @brief Replaces content of table with first page of query
+  *     Next pages are loaded by views on scrolling to end of table (fetchMore)
+  * @param db_ptr - database that pages are read from (local replica if attached)
+  * @param pager - cursor of query (it's reset to first row)
+  */
+void PagedTable::setQuery(DbSQL db_ptr, const database::KeysetPager &pager)
+{
+    cancel();
+    clear();
+
+    m_db_ptr = db_ptr;
+    m_pager = pager;
+    m_pager.reset();
+
+    fetchMore(QModelIndex());
+}
+
+/**
+  * @brief Replaces content of table with rows that are not paged (e.g. matches of search)
+  *     Paging of previous query is stopped
+  * @param result - complete result of query
+  */
+void PagedTable::setResult(const database::QueryResult &result)
+{
+    cancel();
+    m_pager = database::KeysetPager();
+
+    ResultTable::setResult(result);
+}
+
+/**
+  * @brief Stops loading of page (rows already loaded are kept)
+  */
+void PagedTable::cancel()
+{
+    m_page_qry.cancel();
+    m_loading = false;
+}
+
+/**
+  * @brief Loading State Getter
+  * @retval True if page is being loaded
+  */
+bool PagedTable::isLoading() const
+{
+    return m_loading;
+}
+
+/**
+  * @brief Tells views if there are more rows to load
+  *     Only one page is loaded at time
+  */
+bool PagedTable::canFetchMore(const QModelIndex &parent) const
+{
+    return !parent.isValid() && m_db_ptr && !m_pager.atEnd() && !isLoading();
+}
+
+/**
+  * @brief Loads next page in database worker thread and appends it to table
+  *     Emits pageLoaded, or pageFailed if query failed (no more pages are loaded then)
+  */
+void PagedTable::fetchMore(const QModelIndex &parent)
+{
+    if(!canFetchMore(parent))
+    {
+        return;
+    }
+
+    m_loading = true;
+
+    m_page_qry = database::execReadAsync(m_db_ptr,
+                                         m_pager.pageSql(),
+                                         m_pager.pageBinds(),
+                                         this,
+                                         [this](const database::QueryResult &page)
+    {
+        m_loading = false;
+        m_pager.advance(page);
+
+        if(!page.ok)
+        {
+            emit pageFailed(page.error);
+            return;
+        }
+
+        // Columns are known even if page has no rows
+        appendRows(page);
+
+        emit pageLoaded(page.rows.size());
+    });
+}
+
+} //namespace sqlModels
@@ -0,0 +1,265 @@
+#include "Delegates/Inc/picked_substrates_table.h"
+
+#include <QSet>
+
+namespace sqlModels {
+
+PickedSubstratesTable::PickedSubstratesTable(QObject *parent_ptr):
+    QAbstractTableModel(parent_ptr)
+{
+}
+
+/**
+  * @brief Appends picked substrates to table (one insertion for whole batch)
+  *     Substrates already in table are skipped
+  * @param rows - substrates with their amounts and TS
+  */
+void PickedSubstratesTable::appendRows(const std::vector<PickedSubstrate> &rows)
+{
+    std::vector<const PickedSubstrate*> added;
+    added.reserve(rows.size());
+
+    QSet<qlonglong> batch_ids;
+
+    for(const auto &row: rows)
+    {
+        if(!contains(row.substrate.id) && !batch_ids.contains(row.substrate.id))
+        {
+            batch_ids.insert(row.substrate.id);
+            added.push_back(&row);
+        }
+    }
+
+    if(added.empty())
+    {
+        return;
+    }
+
+    const int first(m_ids.size());
+    const int count(int(added.size()));
+
+    beginInsertRows(QModelIndex(), first, first + count - 1);
+
+    m_ids.reserve(first + count);
+    m_names.reserve(first + count);
+    m_ots.reserve(first + count);
+    m_biogas.reserve(first + count);
+    m_methane.reserve(first + count);
+    m_amounts.reserve(first + count);
+    m_ts.reserve(first + count);
+
+    for(auto row_ptr: added)
+    {
+        const schema::Substrate::Row &substrate(row_ptr->substrate);
+
+        m_rows_by_id.insert(substrate.id, m_ids.size());
+
+        m_ids.append(substrate.id);
+        m_names.append(substrate.name);
+        m_ots.append(substrate.ots);
+        m_biogas.append(substrate.biogas);
+        m_methane.append(substrate.methane);
+        m_amounts.append(row_ptr->amount);
+        m_ts.append(row_ptr->ts);
+
+        m_totals.add(yield::feedYield(yield::Substrate{substrate.id, substrate.ots, substrate.biogas, substrate.methane},
+                                      row_ptr->amount,
+                                      row_ptr->ts));
+    }
+
+    endInsertRows();
+}
+
+/**
+  * @brief Checks if substrate is already in table - O(1)
+  * @param substrate_id - ID of substrate
+  * @retval True if substrate has been picked
+  */
+bool PickedSubstratesTable::contains(qlonglong substrate_id) const
+{
+    return m_rows_by_id.contains(substrate_id);
+}
+
+/**
+  * @brief Removes all substrates from table
+  */
+void PickedSubstratesTable::clear()
+{
+    beginResetModel();
+
+    m_ids.clear();
+    m_names.clear();
+    m_ots.clear();
+    m_biogas.clear();
+    m_methane.clear();
+    m_amounts.clear();
+    m_ts.clear();
+
+    m_rows_by_id.clear();
+    m_totals.clear();
+
+    endResetModel();
+}
+
+/**
+  * @brief Totals Getter - O(1)
+  * @retval Expected methane, biogas and fresh mass of all picked substrates
+  */
+yield::Result PickedSubstratesTable::totals() const
+{
+    return m_totals.totals();
+}
+
+/**
+  * @brief Buffers Getter - columns of picked substrates (rowCount values each)
+  * @retval Pointers valid until table is changed
+  */
+yield::YieldBuffers PickedSubstratesTable::buffers() const
+{
+    return yield::YieldBuffers{m_ots.constData(),
+                               m_biogas.constData(),
+                               m_methane.constData(),
+                               m_amounts.constData(),
+                               m_ts.constData()};
+}
+
+int PickedSubstratesTable::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : m_ids.size();
+}
+
+int PickedSubstratesTable::columnCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : ColumnCount;
+}
+
+/**
+  * @brief Gives value of cell for Display and Edit roles (typed, as stored in column)
+  * @param item - specifies cell of table
+  * @param role - role of data requested by view (Qt::ItemDataRole)
+  * @retval Value of cell or invalid QVariant for other roles
+  */
+QVariant PickedSubstratesTable::data(const QModelIndex &item, int role) const
+{
+    if(!item.isValid() || item.row() >= m_ids.size()
+            || (role != Qt::DisplayRole && role != Qt::EditRole))
+    {
+        return QVariant();
+    }
+
+    const int row(item.row());
+
+    switch(item.column())
+    {
+        case schema::Substrate::Id:
+            return m_ids.at(row);
+
+        case schema::Substrate::Name:
+            return m_names.at(row);
+
+        case schema::Substrate::Ots:
+            return m_ots.at(row);
+
+        case schema::Substrate::Biogas:
+            return m_biogas.at(row);
+
+        case schema::Substrate::Methane:
+            return m_methane.at(row);
+
+        case Amount:
+            return m_amounts.at(row);
+
+        case Ts:
+            return m_ts.at(row);
+
+        default:
+            return QVariant();
+    }
+}
+
+/**
+  * @brief Gives header of column
+  */
+QVariant PickedSubstratesTable::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if(orientation == Qt::Horizontal && role == Qt::DisplayRole)
+    {
+        switch(section)
+        {
+            case schema::Substrate::Id:
+                return "ID";
+
+            case schema::Substrate::Name:
+                return QObject::tr("Name");
+
+            case schema::Substrate::Ots:
+                return "oTS (%)";
+
+            case schema::Substrate::Biogas:
+                return QObject::tr("Biogas");
+
+            case schema::Substrate::Methane:
+                return QObject::tr("Methane") + " (%)";
+
+            case Amount:
+                return QObject::tr("Amount");
+
+            case Ts:
+                return "TS (%)";
+
+            default:
+                break;
+        }
+    }
+
+    return QAbstractTableModel::headerData(section, orientation, role);
+}
+
+/**
+  * @brief Removes rows with their parts of totals
+  *     Index of rows following removed ones is rebuilt
+  */
+bool PickedSubstratesTable::removeRows(int row, int count, const QModelIndex &parent)
+{
+    if(parent.isValid() || row < 0 || count <= 0 || row + count > m_ids.size())
+    {
+        return false;
+    }
+
+    beginRemoveRows(parent, row, row + count - 1);
+
+    for(int removed = row; removed < row + count; removed++)
+    {
+        m_rows_by_id.remove(m_ids.at(removed));
+    }
+
+    m_ids.remove(row, count);
+    m_names.remove(row, count);
+    m_ots.remove(row, count);
+    m_biogas.remove(row, count);
+    m_methane.remove(row, count);
+    m_amounts.remove(row, count);
+    m_ts.remove(row, count);
+
+    m_totals.removeRange(row, count);
+
+    mReindex(row);
+
+    endRemoveRows();
+
+    return true;
+}
+
+/**
+  * @brief Updates index of substrate IDs for rows that moved
+  * @param first_row - first row that changed its position
+  */
+void PickedSubstratesTable::mReindex(int first_row)
+{
+    for(int row = first_row; row < m_ids.size(); row++)
+    {
+        m_rows_by_id[m_ids.at(row)] = row;
+    }
+}
+
+} //namespace sqlModels
@@ -0,0 +1,186 @@
+#include "Delegates/Inc/result_table.h"
+
+namespace sqlModels {
+
+ResultTable::ResultTable(QObject *parent_ptr):
+    QAbstractTableModel(parent_ptr)
+{
+}
+
+/**
+  * @brief Replaces content of table with rows of query result
+  * @param result - result of query executed with database::execAsync
+  */
+void ResultTable::setResult(const database::QueryResult &result)
+{
+    beginResetModel();
+    m_result = result;
+    endResetModel();
+}
+
+/**
+  * @brief Appends rows of streamed chunk to table (see database::execStreamAsync)
+  *     Columns are taken from first chunk if table has none yet
+  * @param chunk - part of query result
+  */
+void ResultTable::appendRows(const database::QueryResult &chunk)
+{
+    if(m_result.columns.isEmpty() && !chunk.columns.isEmpty())
+    {
+        beginResetModel();
+        m_result.columns = chunk.columns;
+        endResetModel();
+    }
+
+    if(chunk.rows.isEmpty())
+    {
+        return;
+    }
+
+    beginInsertRows(QModelIndex(),
+                    m_result.rows.size(),
+                    m_result.rows.size() + chunk.rows.size() - 1);
+    m_result.rows.append(chunk.rows);
+    endInsertRows();
+}
+
+/**
+  * @brief Result Getter
+  * @retval Result of query currently displayed in table
+  */
+const database::QueryResult &ResultTable::result() const
+{
+    return m_result;
+}
+
+/**
+  * @brief Removes all rows and columns from table (headers are kept)
+  */
+void ResultTable::clear()
+{
+    setResult(database::QueryResult());
+}
+
+/**
+  * @brief Allows editing of column by views
+  *     Each edit emits cellEdited - saving it in database is up to owner of table
+  * @param column - index of column
+  * @param editable - true if column can be edited
+  */
+void ResultTable::setEditableColumn(int column, bool editable)
+{
+    if(editable)
+    {
+        m_editable_columns.insert(column);
+    }
+    else
+    {
+        m_editable_columns.remove(column);
+    }
+}
+
+int ResultTable::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : m_result.rows.size();
+}
+
+int ResultTable::columnCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : m_result.columns.size();
+}
+
+/**
+  * @brief Gives value of cell for Display and Edit roles
+  * @param item - specifies cell of table
+  * @param role - role of data requested by view (Qt::ItemDataRole)
+  * @retval Value of cell or invalid QVariant for other roles
+  */
+QVariant ResultTable::data(const QModelIndex &item, int role) const
+{
+    if(!item.isValid() || item.row() >= m_result.rows.size()
+            || item.column() >= m_result.columns.size())
+    {
+        return QVariant();
+    }
+
+    if(role == Qt::DisplayRole || role == Qt::EditRole)
+    {
+        return m_result.rows.at(item.row()).at(item.column());
+    }
+
+    return QVariant();
+}
+
+/**
+  * @brief Changes value of cell in editable column and emits cellEdited
+  * @retval True if value has been changed
+  */
+bool ResultTable::setData(const QModelIndex &item, const QVariant &value, int role)
+{
+    if(!item.isValid() || role != Qt::EditRole || !m_editable_columns.contains(item.column())
+            || item.row() >= m_result.rows.size())
+    {
+        return false;
+    }
+
+    m_result.rows[item.row()][item.column()] = value;
+
+    emit dataChanged(item, item, {Qt::DisplayRole, Qt::EditRole});
+    emit cellEdited(item.row(), item.column(), value);
+
+    return true;
+}
+
+Qt::ItemFlags ResultTable::flags(const QModelIndex &item) const
+{
+    Qt::ItemFlags result(QAbstractTableModel::flags(item));
+
+    if(item.isValid() && m_editable_columns.contains(item.column()))
+    {
+        result |= Qt::ItemIsEditable;
+    }
+
+    return result;
+}
+
+/**
+  * @brief Gives header of column
+  *     Header set with setHeaderData has priority over name of column in query
+  */
+QVariant ResultTable::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if(orientation == Qt::Horizontal && role == Qt::DisplayRole)
+    {
+        if(m_headers.contains(section))
+        {
+            return m_headers.value(section);
+        }
+
+        if(section < m_result.columns.size())
+        {
+            return m_result.columns.at(section);
+        }
+    }
+
+    return QAbstractTableModel::headerData(section, orientation, role);
+}
+
+/**
+  * @brief Sets header of column
+  *     Headers are kept between results, so they can be set before first load
+  */
+bool ResultTable::setHeaderData(int section, Qt::Orientation orientation, const QVariant &value, int role)
+{
+    if(orientation != Qt::Horizontal || (role != Qt::EditRole && role != Qt::DisplayRole))
+    {
+        return false;
+    }
+
+    m_headers.insert(section, value);
+
+    emit headerDataChanged(orientation, section, section);
+
+    return true;
+}
+
+} //namespace sqlModels
@@ -1,22 +1,54 @@
 #include "Delegates/Inc/service_delegate.h"
-#include <QDate>
-#include <QtDebug>
+#include "Database/Inc/db_schema.h"
+#include <algorithm>
+#include <QDateTime>
 #include <QColor>
 
 namespace sqlModels {
 
 ServiceTable::ServiceTable(QObject *parent_ptr):
-    QSqlQueryModel(parent_ptr),
-    attorney_ptr(new ServiceTableAttorney)
+    PagedTable(parent_ptr),
+    m_today(QDate::currentDate()),
+    m_yes(QObject::tr("Yes")),
+    m_no(QObject::tr("No")),
+    m_overdue_color(QVariant::fromValue(QColor(180, 0, 0, 255)))
 {
+    connect(this, &QAbstractItemModel::modelReset, this, [this]()
+    {
+        m_done.clear();
+        m_overdue.clear();
+        mComputeRows(0, rowCount() - 1);
+    });
+
+    connect(this, &QAbstractItemModel::rowsInserted, this, [this](const QModelIndex &, int first, int last)
+    {
+        mComputeRows(first, last);
+    });
+
+    connect(this, &QAbstractItemModel::dataChanged, this, [this](const QModelIndex &top_left,
+                                                                 const QModelIndex &bottom_right,
+                                                                 const QVector<int> &roles)
+    {
+        // Repaint of backgrounds (see mOnMidnight) doesn't change values
+        if (roles.isEmpty() || roles.contains(Qt::EditRole) || roles.contains(Qt::DisplayRole))
+        {
+            mComputeRows(top_left.row(), bottom_right.row());
+        }
+    });
+
+    m_midnight_timer.setSingleShot(true);
+    connect(&m_midnight_timer, &QTimer::timeout, this, &ServiceTable::mOnMidnight);
+    mScheduleMidnight();
 }
 
 /**
   * @brief Override of data function
   *     Changes Display of Table column
-  *     For column 3 (Done) - changes 1/0 data into Yes/No
-  *     For column 0 (Date) - If date has expired and in column 3 the value is "No"
+  *     For column Done - changes 1/0 data into Yes/No
+  *     For column Date - If date has expired and service is not done
   *         Changes Color Background to Red
+  *     State of rows is computed when they are loaded (and at midnight),
+  *     so this function only reads it
   * @param item - Table models in QT stores data in Model Indexes
   *     This specifies which cell from table will be modified
   * @param role - Each item in the model has a set of data elements associated with it, each with its own role.
@@ -26,41 +58,91 @@ ServiceTable::ServiceTable(QObject *parent_ptr):
   */
 QVariant ServiceTable::data(const QModelIndex &item, int role) const
 {
-    QVariant val(QSqlQueryModel::data(item, role));
+    if (!item.isValid() || item.row() >= m_done.size())
+    {
+        return PagedTable::data(item, role);
+    }
 
-    if (val.isValid() && role == Qt::DisplayRole)
+    if (role == Qt::DisplayRole && item.column() == schema::Service::Done)
     {
-        if (item.column() == 3) //Done
-        {
-            if((val.toInt() == 1))
-            {
-                val = QObject::tr("Yes");
-            }
-            else
-            {
-                val = QObject::tr("No");
-                attorney_ptr->selected_rows.push_back(item.row());
-            }
-        }
+        return m_done.testBit(item.row()) ? m_yes : m_no;
     }
 
-    if (role == Qt::BackgroundRole && item.column() == 0) //Date
+    if (role == Qt::BackgroundRole && item.column() == schema::Service::Date)
     {
-        if (val.toDate() < QDate::currentDate())
-        {
-            for(auto row = attorney_ptr->selected_rows.begin(); row !=attorney_ptr->selected_rows.end(); ++row)
-            {
-                if(*row == item.row())
-                {
-                    return QVariant::fromValue(QColor(180, 0, 0, 255));
-                }
-            }
-        }
+        return m_overdue.testBit(item.row()) ? m_overdue_color : QVariant();
+    }
+
+    return PagedTable::data(item, role);
+}
+
+/**
+  * @brief Computes state of rows (done flag and overdue flag)
+  * @param first - first row to compute
+  * @param last - last row to compute (inclusive)
+  */
+void ServiceTable::mComputeRows(int first, int last)
+{
+    const int rows(rowCount());
+
+    if (m_done.size() != rows)
+    {
+        m_done.resize(rows);
+        m_overdue.resize(rows);
+    }
+
+    for (int row = std::max(0, first); row <= last && row < rows; row++)
+    {
+        m_done.setBit(row, m_result.rows.at(row).value(schema::Service::Done).toInt() == 1);
+    }
+
+    mComputeOverdue(first, last);
+}
+
+/**
+  * @brief Computes overdue flag of rows for current date
+  *     (rows have to have done flag computed)
+  */
+void ServiceTable::mComputeOverdue(int first, int last)
+{
+    const int rows(m_done.size());
+
+    for (int row = std::max(0, first); row <= last && row < rows; row++)
+    {
+        m_overdue.setBit(row, !m_done.testBit(row)
+                         && m_result.rows.at(row).value(schema::Service::Date).toDate() < m_today);
+    }
+}
+
+/**
+  * @brief Recomputes overdue flags when date changes
+  *     and repaints backgrounds of Date column
+  */
+void ServiceTable::mOnMidnight()
+{
+    m_today = QDate::currentDate();
+
+    mComputeOverdue(0, m_done.size() - 1);
+
+    if (m_done.size() > 0)
+    {
+        emit dataChanged(index(0, schema::Service::Date),
+                         index(m_done.size() - 1, schema::Service::Date),
+                         {Qt::BackgroundRole});
     }
 
-    return val;
+    mScheduleMidnight();
 }
 
+/**
+  * @brief Starts timer that fires right after next midnight
+  */
+void ServiceTable::mScheduleMidnight()
+{
+    const QDateTime now(QDateTime::currentDateTime());
+    const QDateTime midnight(now.date().addDays(1), QTime(0, 0));
 
+    m_midnight_timer.start(int(std::min<qint64>(now.msecsTo(midnight) + 1000, 24 * 60 * 60 * 1000)));
+}
 
 }//namespace sqlModels
@@ -2,9 +2,14 @@
 #define BIOGAS_CALCULATOR_H
 
 #include <QDialog>
-#include <QSqlQueryModel>
-#include <QStandardItemModel>
+#include <QFutureWatcher>
+#include <QTimer>
 #include "Database/Inc/database.h"
+#include "Database/Inc/db_schema.h"
+#include "Database/Inc/db_search.h"
+#include "Calculation/Inc/yield_uncertainty.h"
+#include "Delegates/Inc/paged_table.h"
+#include "Delegates/Inc/picked_substrates_table.h"
 #include <QTableView>
 
 namespace Ui {
@@ -31,9 +36,26 @@ private slots:
 
     void on_pushButton_clear_all_clicked();
 
+    void on_pushButton_optimize_mix_clicked();
+
     void on_pushButton_menu_clicked();
 
+    void on_lineEdit_search_substrate_textEdited(const QString &text);
+
+    void on_checkBox_monte_carlo_toggled(bool checked);
+
 private:
+    /*
+     * Result of Monte Carlo run (see mUpdateYieldBands)
+     */
+    struct YieldBandsRun
+    {
+        unsigned int run;       //number of run, results of older runs are dropped
+        bool simulated;
+        yield::YieldBands bands;
+        QString error;
+    };
+
     Ui::BiogasCalculator *ui;
     DbSQL m_db_ptr;
 
@@ -45,26 +67,43 @@ private:
 
     std::vector<unsigned int> m_plants;
 
-    std::unique_ptr<QSqlQueryModel> m_model_substrates_available_ptr;
-    std::unique_ptr<QStandardItemModel> m_model_substrates_picked_ptr;
+    yield::Uncertainty m_uncertainty;   //spread of lab values in Monte Carlo mode
+    unsigned int m_bands_run;           //increased on every change of picked substrates
+    QFutureWatcher<YieldBandsRun> m_bands_watcher;
+
+    std::unique_ptr<sqlModels::PagedTable> m_model_substrates_available_ptr;
+    std::unique_ptr<sqlModels::PickedSubstratesTable> m_model_substrates_picked_ptr;
+
+    std::unique_ptr<database::SubstrateSearch> m_search_ptr;
+    QTimer m_search_timer;      //debounces typing in search box
+
+    database::QueryHandle m_volume_qry;
+    database::QueryHandle m_search_qry;
+    database::QueryHandle m_catalog_qry;
 
     void mInitWindow();
     void mClearTable(QTableView *table_ptr);
     void mConfigureTable(QTableView *table_ptr);
     void mLoadTableAppearance(QTableView *table_ptr);
 
-    bool mLoadPlantVolume();
+    void mLoadPlantVolume();
     bool mLoadAvailablePlants();
-    bool mLoadAvailableSubstrates();
+    void mLoadAvailableSubstrates();
+    void mSearchSubstrates();
     void mLoadAvailableVolume();
     void mLoadExpectedResults(const double &methane, const double &biogas);
 
     void mUpdateAvailableVolume();
     void mUpdateExpectedResults();
+    void mUpdateYieldBands();
+    void mStartYieldBands();
+    void mOnYieldBandsFinished();
     void mUpdateTable(QTableView *table, bool show = false);
-    bool mUpdateTableAvailableSubstrates(QSqlQuery &qry);
+    void mUpdateLoadingState();
 
     bool mIsAdditionPossible(const QString &substrate_name);
+    bool mIsOptimizationPossible();
+    void mOptimizeMix(const database::QueryResult &catalog, double stock, double ts);
     bool mIsAvailableSubstrateRecorded(const qlonglong id);
 
     void reject() override;
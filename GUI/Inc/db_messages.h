@@ -4,6 +4,8 @@
 #include <QString>
 #include <QMessageBox>
 
+#include "Database/Inc/db_manager.h"
+
 
 namespace db_msg{
     void showDbCriticalError(const QString &error_msg,
@@ -21,6 +23,8 @@ namespace db_msg{
                             int step = 1,
                             QWidget *parent = nullptr);
 
+    void installDialogs(DbManager &db, QWidget *parent = nullptr);
+
 }//namespace db_msg
 
 #endif // DB_MESSAGES_H
@@ -3,9 +3,11 @@
 
 #include <QMainWindow>
 #include "Database/Inc/database.h"
+#include "Database/Inc/db_session.h"
 #include "GUI/Inc/phone_table.h"
 #include "GUI/Inc/biogas_calculator.h"
 #include "GUI/Inc/services.h"
+#include "GUI/Inc/query_diagnostics.h"
 
 QT_BEGIN_NAMESPACE
 namespace Ui { class Menu; }
@@ -16,7 +18,7 @@ class Menu : public QMainWindow
     Q_OBJECT
 
 public:
-    Menu(const unsigned int &user_id, DbSQL db_ptr, QWidget *parent = nullptr);
+    Menu(const database::SessionData &session, DbSQL db_ptr, QWidget *parent = nullptr);
     ~Menu();
 
 
@@ -33,6 +35,8 @@ private slots:
 
     void on_pushButton_services_clicked();
 
+    void on_action_query_diagnostics_triggered();
+
 private:
     Ui::Menu *ui;
     unsigned int m_user_id;
@@ -41,11 +45,17 @@ private:
     std::shared_ptr<BiogasCalculator> m_biogas_calc_ptr;
     std::shared_ptr<Services> m_svcs_ptr;
 
+    database::QueryHandle m_personal_data_qry;
+    database::QueryHandle m_address_qry;
+    database::QueryResult m_prefetched_phones;
+
 
-    void logInUser(const unsigned int &user_id);
+    void logInUser(const database::SessionData &session);
 
     bool loadCorespondanceAddress();
     bool loadPersonalData();
+    void mShowPersonalData(const database::QueryResult &result);
+    void mShowCorespondanceAddress(const database::QueryResult &result);
 
 };
 #endif // MENU_H
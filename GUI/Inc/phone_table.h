@@ -3,7 +3,7 @@
 
 #include <QDialog>
 #include "Database/Inc/database.h"
-#include <QSqlTableModel>
+#include "Delegates/Inc/result_table.h"
 
 namespace Ui {
 class PhoneTable;
@@ -14,7 +14,10 @@ class PhoneTable : public QDialog
     Q_OBJECT
 
 public:
-    explicit PhoneTable(const unsigned int &user_id, DbSQL db_ptr,QWidget *parent = nullptr);
+    explicit PhoneTable(const unsigned int &user_id,
+                        DbSQL db_ptr,
+                        const database::QueryResult &prefetched_phones = database::QueryResult(),
+                        QWidget *parent = nullptr);
     ~PhoneTable();
 signals:
     void exitSignal();
@@ -30,10 +33,13 @@ private:
     Ui::PhoneTable *ui;
     unsigned int m_user_id;
     DbSQL m_db_ptr;
-    std::unique_ptr<QSqlTableModel> m_table_model_ptr;
+    std::unique_ptr<sqlModels::ResultTable> m_table_model_ptr;
+    database::QueryHandle m_phones_qry;
 
-    bool mLoadPhoneNumbers();
-    bool mFindRecordPhoneID(QSqlQuery &qry, const QString &phone_number);
+    void mConfigureTable();
+    void mLoadPhoneNumbers();
+    void mShowPhoneNumbers(const database::QueryResult &result);
+    void mSavePhoneNumber(int row, int column, const QVariant &value);
     void reject() override;
 };
 
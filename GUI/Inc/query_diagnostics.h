@@ -0,0 +1,35 @@
+#ifndef QUERY_DIAGNOSTICS_H
+#define QUERY_DIAGNOSTICS_H
+
+#include <QDialog>
+#include "Database/Inc/database.h"
+
+namespace Ui {
+class QueryDiagnostics;
+}
+
+class QueryDiagnostics final: public QDialog
+{
+    Q_OBJECT
+
+public:
+    explicit QueryDiagnostics(DbSQL db_ptr, QWidget *parent = nullptr);
+    ~QueryDiagnostics();
+
+private slots:
+    void on_pushButton_refresh_clicked();
+
+    void on_pushButton_reset_clicked();
+
+    void on_pushButton_close_clicked();
+
+private:
+    Ui::QueryDiagnostics *ui;
+    DbSQL m_db_ptr;
+
+    void mConfigTable();
+    void mLoadSummary();
+    void mLoadStatements();
+};
+
+#endif // QUERY_DIAGNOSTICS_H
@@ -36,8 +36,9 @@ private:
     std::vector<unsigned long long> m_plants_available;
 
     bool mLoadPlants() noexcept;
-    bool mLoadSvcs() noexcept;
+    void mLoadSvcs() noexcept;
     void mConfigSvcsTable();
+    void mSetLoadingState(bool loading);
 
     void mBlockWindow();
     void reject() override;
@@ -1,9 +1,12 @@
 #include "GUI\Inc\biogas_calculator.h"
 #include "ui_biogas_calculator.h"
 #include "Misc/Inc/validators.h"
+#include "Calculation/Inc/biogas_yield.h"
+#include "Calculation/Inc/feed_optimizer.h"
 #include <memory>
 #include <QMessageBox>
 #include <QSqlError>
+#include <QtConcurrent/QtConcurrentRun>
 #include <stack>
 
 #include <QDebug>
@@ -16,7 +19,9 @@ BiogasCalculator::BiogasCalculator(unsigned int user_id, DbSQL db_ptr, QWidget *
     m_user_id(user_id),
     m_plant_picked(0),
     m_max_volume(0),
-    m_available_volume(0)
+    m_available_volume(0),
+    m_uncertainty(yield::defaultUncertainty()),
+    m_bands_run(0)
 {
     ui->setupUi(this);
     mInitWindow();
@@ -24,6 +29,15 @@ BiogasCalculator::BiogasCalculator(unsigned int user_id, DbSQL db_ptr, QWidget *
 
 BiogasCalculator::~BiogasCalculator()
 {
+    m_volume_qry.cancel();
+    m_search_qry.cancel();
+    m_catalog_qry.cancel();
+
+    if(m_model_substrates_available_ptr)
+    {
+        m_model_substrates_available_ptr->cancel();
+    }
+
     delete ui;
 }
 
@@ -38,8 +52,7 @@ void BiogasCalculator::on_comboBox_pick_plant_currentIndexChanged(int index)
     if(index >= 0 && m_plants.size() != 0)
     {
         m_plant_picked = m_plants[unsigned(index)];
-        mLoadPlantVolume();
-        mLoadAvailableSubstrates();
+        mLoadPlantVolume();     // substrates don't depend on plant - they stay loaded
 
         mClearTable(ui->tableView_chosen_substrates);
         mUpdateAvailableVolume();
@@ -62,35 +75,29 @@ void BiogasCalculator::on_pushButton_select_substrate_clicked()
 
     if(select && select->hasSelection())
     {
-        int columns_count(select->model()->columnCount());
-        int index(0);
+        const database::QueryResult &available(m_model_substrates_available_ptr->result());
+        std::vector<sqlModels::PickedSubstrate> picked;
 
         for(auto &it: select->selectedRows())
         {
-            if(!mIsAdditionPossible(select->selectedRows(1).value(index).data().toString()) ||
-                    mIsAvailableSubstrateRecorded(it.data().toLongLong()))
+            const schema::Substrate::Row substrate(schema::Substrate::decode(available.rows.at(it.row())));
+
+            if(!mIsAdditionPossible(substrate.name) ||
+                    mIsAvailableSubstrateRecorded(substrate.id))
             {
-                ++index;
                 continue;
             }
 
-            int row(m_model_substrates_picked_ptr->rowCount());
+            picked.push_back(sqlModels::PickedSubstrate{substrate, amount, ts});
 
-            m_model_substrates_picked_ptr->insertRow(row);
-
-            for (int column = 0; column < columns_count; column++)
-            {
-                QVariant var = select->selectedRows(column).value(index).data();
-                m_model_substrates_picked_ptr->setData(m_model_substrates_picked_ptr->index(row,column), var.toString());
-            }
-            m_model_substrates_picked_ptr->setData(m_model_substrates_picked_ptr->index(row, 5), amount);
-            m_model_substrates_picked_ptr->setData(m_model_substrates_picked_ptr->index(row, 6), ts);
+            // Next substrate is checked against volume left by this one
+            m_available_volume -= amount;
+        }
 
-            mUpdateAvailableVolume();
-            mUpdateExpectedResults();
+        m_model_substrates_picked_ptr->appendRows(picked);
 
-            ++index;
-        }
+        mUpdateAvailableVolume();
+        mUpdateExpectedResults();
 
         mUpdateTable(ui->tableView_chosen_substrates);
     }
@@ -125,10 +132,10 @@ void BiogasCalculator::on_pushButton_remove_substrate_clicked()
         {
             m_model_substrates_picked_ptr->removeRow(rows.top());
             rows.pop();
-
-            mUpdateAvailableVolume();
-            mUpdateExpectedResults();
         }
+
+        mUpdateAvailableVolume();
+        mUpdateExpectedResults();
     }
 
     else
@@ -146,14 +153,51 @@ void BiogasCalculator::on_pushButton_clear_all_clicked()
 {
     if(m_model_substrates_picked_ptr)
     {
-        int row_count(m_model_substrates_picked_ptr->rowCount());
-        m_model_substrates_picked_ptr->removeRows(0, row_count);
+        m_model_substrates_picked_ptr->clear();
     }
 
     mUpdateAvailableVolume();
     mUpdateExpectedResults();
 }
 
+/**
+ * Replaces picked substrates with mix giving the most methane from volume of plant
+ * (see yield::optimizeMix) - every substrate of catalog available to user is candidate,
+ * Amount is stock of each of them and TS is used for all of them
+ * Note: Catalog is read from cache shared by windows, not from paged table - on miss
+ * it's loaded in database worker thread and button is disabled until it arrives
+ */
+void BiogasCalculator::on_pushButton_optimize_mix_clicked()
+{
+    if(!mIsOptimizationPossible())
+    {
+        return;
+    }
+
+    const double stock(ui->lineEdit_substrate_amount->text().toDouble());
+    const double ts(ui->lineEdit_TS->text().toDouble());
+
+    ui->pushButton_optimize_mix->setDisabled(true);
+
+    m_catalog_qry = m_db_ptr->referenceCache()->fetch(database::ReferenceData::Substrates,
+                                                      m_user_id,
+                                                      this,
+                                                      [this, stock, ts](const database::QueryResult &catalog)
+    {
+        ui->pushButton_optimize_mix->setDisabled(false);
+
+        if(!catalog.ok)
+        {
+            QMessageBox::warning(this,
+                                 "Failed to Load Substrates",
+                                 catalog.error);
+            return;
+        }
+
+        mOptimizeMix(catalog, stock, ts);
+    });
+}
+
 /**
  * Goes Back to menu by emiting exitSignal
  */
@@ -163,6 +207,33 @@ void BiogasCalculator::on_pushButton_menu_clicked()
     QDialog::reject();
 }
 
+/**
+ * Restarts search of substrates after user stops typing for a while,
+ * so query isn't issued for every key
+ *
+ * @param text - text of search box (read when search starts)
+ */
+void BiogasCalculator::on_lineEdit_search_substrate_textEdited(const QString &text)
+{
+    Q_UNUSED(text);
+
+    m_search_qry.cancel();
+    m_search_timer.start();
+}
+
+/**
+ * Turns Monte Carlo mode on and off - while it is on, range of expected
+ * results is calculated with every change of picked substrates
+ *
+ * @param checked - state of CheckBox
+ */
+void BiogasCalculator::on_checkBox_monte_carlo_toggled(bool checked)
+{
+    Q_UNUSED(checked);
+
+    mUpdateYieldBands();
+}
+
 /**
  * Initialize window
  * -Configures Tables
@@ -171,16 +242,23 @@ void BiogasCalculator::on_pushButton_menu_clicked()
  */
 void BiogasCalculator::mInitWindow()
 {
-    m_model_substrates_picked_ptr = std::unique_ptr<QStandardItemModel>(new QStandardItemModel(0,7));
+    m_model_substrates_picked_ptr = std::unique_ptr<sqlModels::PickedSubstratesTable>(new sqlModels::PickedSubstratesTable());
 
     mConfigureTable(ui->tableView_available_substrates);
     mConfigureTable(ui->tableView_chosen_substrates);
 
+    m_search_ptr = std::unique_ptr<database::SubstrateSearch>(new database::SubstrateSearch(m_db_ptr, m_user_id));
+
+    m_search_timer.setSingleShot(true);
+    m_search_timer.setInterval(150);
+    connect(&m_search_timer, &QTimer::timeout, this, &BiogasCalculator::mSearchSubstrates);
+    connect(&m_bands_watcher, &QFutureWatcher<YieldBandsRun>::finished, this, &BiogasCalculator::mOnYieldBandsFinished);
+
     if(mLoadAvailablePlants())
     {
         mLoadAvailableSubstrates();
+        mLoadPlantVolume();
     }
-    mLoadPlantVolume();     //bool
     mUpdateAvailableVolume();
 
 }
@@ -209,40 +287,46 @@ void BiogasCalculator::mClearTable(QTableView *table_ptr)
 /**
  * Sums volume from all containers asigned to plant
  * and loads it to lineEdit
+ * Note: Query runs in database worker thread - until it ends lineEdit shows loading state
  */
-bool BiogasCalculator::mLoadPlantVolume()
+void BiogasCalculator::mLoadPlantVolume()
 {
-    m_max_volume = 0;
-
-    QSqlQuery qry(m_db_ptr->getDatabase());
-
-    qry.prepare("SELECT SUM(volume) "
-                "FROM biogas_server_container "
-                "WHERE fromPlant_id = :plant");
-    qry.bindValue(":plant", m_plant_picked);
+    m_volume_qry.cancel();
 
-
-    if (!qry.exec())
+    m_max_volume = 0;
+    ui->lineEdit_max_volume->setText(QObject::tr("Loading..."));
+
+    m_volume_qry = database::execReadAsync(m_db_ptr,
+                                           "SELECT SUM(volume) "
+                                           "FROM biogas_server_container "
+                                           "WHERE fromPlant_id = :plant",
+                                           {{":plant", m_plant_picked}},
+                                           this,
+                                           [this](const database::QueryResult &result)
     {
-        QMessageBox::warning(this,
-                             "Failed to Load Volume",
-                             qry.lastError().text());
-    }
+        if (!result.ok)
+        {
+            QMessageBox::warning(this,
+                                 "Failed to Load Volume",
+                                 result.error);
+        }
+        else if (!result.isEmpty())
+        {
+            m_max_volume = result.value<int>(0, 0);
+        }
 
-    else
-    {
-        qry.next();
-        m_max_volume = qry.value(0).toInt();
-    }
+        ui->lineEdit_max_volume
+                ->setText(QString::number(m_max_volume));
 
-    ui->lineEdit_max_volume
-            ->setText(QString::number(m_max_volume));
+        mUpdateAvailableVolume();
+        mUpdateLoadingState();
+    });
 
-    return qry.isActive();
+    mUpdateLoadingState();
 }
 
 /**
- * Loads Plants assigned to user to ComboBox
+ * Loads Plants assigned to user to ComboBox (from cache shared by windows)
  * Note: If error occur - noPlantsHandler is activated
  */
 bool BiogasCalculator::mLoadAvailablePlants()
@@ -250,21 +334,17 @@ bool BiogasCalculator::mLoadAvailablePlants()
     ui->comboBox_pick_plant->clear();
     m_plants.clear();
 
-    QSqlQuery qry(m_db_ptr->getDatabase());
-
-    qry.prepare("SELECT PlantID, location "
-                "FROM biogas_server_plant "
-                "WHERE owner_id = :user");
-    qry.bindValue(":user", m_user_id);
+    database::QueryResult result(m_db_ptr->referenceCache()
+                                 ->fetchNow(database::ReferenceData::Plants, m_user_id));
 
-    if(qry.exec())
+    if(result.ok)
     {
-        while(qry.next())
+        for(int row = 0; row < result.rows.size(); row++)
         {
-            QString temp = qry.value(0).toString() + " - " + qry.value(1).toString();
-            ui->comboBox_pick_plant->addItem(temp);
+            const schema::Plant::Row plant(schema::Plant::decode(result.rows.at(row)));
 
-            m_plants.push_back(qry.value(0).toInt());
+            ui->comboBox_pick_plant->addItem(QString::number(plant.id) + " - " + plant.location);
+            m_plants.push_back(static_cast<unsigned int>(plant.id));
         }
         if(!m_plants.empty())
         {
@@ -276,7 +356,7 @@ bool BiogasCalculator::mLoadAvailablePlants()
     {
         QMessageBox::warning(this,
                              "Failed to Load Plants",
-                             qry.lastError().text());
+                             result.error);
     }
 
     noPlantsHandler();
@@ -286,35 +366,60 @@ bool BiogasCalculator::mLoadAvailablePlants()
 }
 
 /**
- * Loads Plants assigned to user to ComboBox
- * Note: If error occur - noPlantsHandler is activated
+ * Loads Substrates available to user (public and owned by user) to table
+ * Note: Catalog is read in pages ordered by substrateID - first page is loaded
+ * in database worker thread (until it ends table is disabled), next ones
+ * when table is scrolled to its end
  */
-bool BiogasCalculator::mLoadAvailableSubstrates()
+void BiogasCalculator::mLoadAvailableSubstrates()
 {
-    QSqlQuery qry(m_db_ptr->getDatabase());
+    static const int page_rows(200);
 
-    qry.prepare("SELECT * FROM biogas_server_substrate AS substrates "
-                "WHERE NOT EXISTS (SELECT * FROM biogas_server_substrate_owner AS owners "
-                "WHERE substrates.substrateID = owners.substrate_id)"
-                "UNION "
-                "SELECT * FROM biogas_server_substrate AS substrates WHERE substrateID IN"
-                " (SELECT substrate_id FROM biogas_server_substrate_owner AS owners"
-                " WHERE owners.user_id = :user)");
+    m_model_substrates_available_ptr->setQuery(m_db_ptr,
+                                               database::referencePager(database::ReferenceData::Substrates,
+                                                                        m_user_id,
+                                                                        page_rows));
+    mUpdateLoadingState();
+}
 
-    qry.bindValue(":user", m_user_id);
+/**
+ * Shows substrates matching text of search box (best matches first)
+ * in table of available substrates - empty text brings back whole catalog
+ * Note: Previous search is cancelled, so only matches of last text are shown
+ */
+void BiogasCalculator::mSearchSubstrates()
+{
+    const QString text(ui->lineEdit_search_substrate->text().trimmed());
+
+    m_search_qry.cancel();
 
-    if (!qry.exec())
+    if(text.isEmpty())
     {
-        QMessageBox::warning(this,
-                             "Failed to Load Substrates",
-                             qry.lastError().text());
-        qDebug()<<qry.lastQuery();
-        return false;
+        mLoadAvailableSubstrates();
+        return;
     }
 
-    qry.next();
+    m_search_qry = m_search_ptr->search(text,
+                                        this,
+                                        [this](const database::QueryResult &result)
+    {
+        if (!result.ok)
+        {
+            QMessageBox::warning(this,
+                                 "Failed to Search Substrates",
+                                 result.error);
+            return;
+        }
+
+        m_model_substrates_available_ptr->setResult(result);
 
-    return mUpdateTableAvailableSubstrates(qry);
+        if(ui->tableView_available_substrates->model() != m_model_substrates_available_ptr.get())
+        {
+            mUpdateTable(ui->tableView_available_substrates, true);
+        }
+
+        mUpdateLoadingState();
+    });
 }
 
 /**
@@ -342,70 +447,123 @@ void BiogasCalculator::mLoadExpectedResults(const double &methane, const double
  * Calculates Available Volume
  * Available Volume means volume that left from substracting picked substrates
  * from Maximum Volume (Sum of volume of all containers assigned to plant)
+ * Note: Amount of picked substrates is kept by table of picked substrates - O(1)
  */
 void BiogasCalculator::mUpdateAvailableVolume()
 {
-    int row_count(0);
+    m_available_volume = m_max_volume - m_model_substrates_picked_ptr->totals().amount;
 
-    if (m_model_substrates_picked_ptr.get())
-    {
-       row_count = m_model_substrates_picked_ptr->rowCount();
-    }
+    mLoadAvailableVolume();
+}
 
-    m_available_volume = m_max_volume;
 
+/**
+ * Calculates Expected Result of picked substrates (see yield::feedYield)
+ * Note: Totals are updated on adding and removing substrate (see sqlModels::PickedSubstratesTable) - O(1)
+ */
+void BiogasCalculator::mUpdateExpectedResults()
+{
+    const yield::Result totals(m_model_substrates_picked_ptr->totals());
+
+    mLoadExpectedResults(totals.methane, totals.biogas);
+    mUpdateYieldBands();
+}
 
-    if (row_count != 0)
+/**
+ * Calculates P10 / P50 / P90 of expected results in Monte Carlo mode (see yield::simulateMix)
+ * Note: Draws are evaluated in background (on all cores) - while one run is in progress,
+ * changes only mark it outdated and next run is started with the latest mix when it ends
+ */
+void BiogasCalculator::mUpdateYieldBands()
+{
+    ++m_bands_run;
+
+    ui->lineEdit_methane_bands->clear();
+    ui->lineEdit_biogas_bands->clear();
+
+    if(!ui->checkBox_monte_carlo->isChecked()
+            || m_model_substrates_picked_ptr->rowCount() == 0
+            || m_bands_watcher.isRunning())
     {
-        for (int row = 0; row < row_count; row++)
-        {
-            m_available_volume -= m_model_substrates_picked_ptr
-                    ->data(m_model_substrates_picked_ptr->index(row,5))
-                    .toDouble();
-        }
+        return;
     }
 
-    mLoadAvailableVolume();
+    mStartYieldBands();
 }
 
-
 /**
- * Calculates Expected Result (Simplified for now)
- *
+ * Starts Monte Carlo run on copy of picked substrates
+ * (table can change while draws are evaluated)
  */
-void BiogasCalculator::mUpdateExpectedResults()
+void BiogasCalculator::mStartYieldBands()
 {
-    double temp_methane(0),
-           temp_biogas(0),
-           ts(0),
-           ots(0),
-           total_methane(0),
-           amount(0),
-           total_biogas(0);
+    static const int draws(1000000);
+
+    const yield::YieldBuffers buffers(m_model_substrates_picked_ptr->buffers());
+    const int count(m_model_substrates_picked_ptr->rowCount());
+    const size_t size(static_cast<size_t>(count));
+    const unsigned int run(m_bands_run);
+    const yield::Uncertainty uncertainty(m_uncertainty);
 
-    int row_count(m_model_substrates_picked_ptr->rowCount());
+    std::vector<double> mix;
+    mix.reserve(5 * size);
 
-    if (row_count != 0)
+    for(const double *column: {buffers.ots, buffers.biogas, buffers.methane, buffers.amount, buffers.ts})
     {
-        for (int row = 0; row < row_count; row++)
-        {
+        mix.insert(mix.end(), column, column + size);
+    }
 
-            ots = m_model_substrates_picked_ptr->index(row, 2).data().toDouble();
+    m_bands_watcher.setFuture(QtConcurrent::run([mix, count, size, run, uncertainty]()
+    {
+        const double *data(mix.data());
+        const yield::YieldBuffers snapshot{data, data + size, data + 2 * size, data + 3 * size, data + 4 * size};
 
-            temp_biogas = m_model_substrates_picked_ptr->index(row, 3).data().toDouble();
+        YieldBandsRun result{run, false, yield::YieldBands(), QString("")};
+        result.simulated = yield::simulateMix(snapshot, count, uncertainty, draws, result.bands, result.error);
 
-            temp_methane = m_model_substrates_picked_ptr->index(row, 4).data().toDouble();
+        return result;
+    }));
 
-            amount = m_model_substrates_picked_ptr->index(row, 5).data().toDouble();
+    mUpdateLoadingState();     // busy cursor until run ends
+}
 
-            ts = m_model_substrates_picked_ptr->index(row, 6).data().toDouble();
+/**
+ * Shows bands of finished Monte Carlo run
+ * Run outdated by changes of picked substrates is dropped and started again
+ */
+void BiogasCalculator::mOnYieldBandsFinished()
+{
+    const YieldBandsRun result(m_bands_watcher.result());
 
-            total_methane += ots/100. * ts/100. * amount * temp_methane;
-            total_biogas += ots/100. * ts/100. * amount * temp_biogas;
+    mUpdateLoadingState();
+
+    if(result.run != m_bands_run)
+    {
+        if(ui->checkBox_monte_carlo->isChecked() && m_model_substrates_picked_ptr->rowCount() > 0)
+        {
+            mStartYieldBands();
         }
+
+        return;
+    }
+
+    if(!result.simulated)
+    {
+        QMessageBox::warning(this,
+                             "Operation cannot be executed",
+                             result.error);
+        return;
     }
 
-    mLoadExpectedResults(total_methane, total_biogas);
+    auto format = [](const yield::Percentiles &percentiles)
+    {
+        return QString::number(percentiles.p10, 'f', 0) + " / "
+                + QString::number(percentiles.p50, 'f', 0) + " / "
+                + QString::number(percentiles.p90, 'f', 0);
+    };
+
+    ui->lineEdit_methane_bands->setText(format(result.bands.methane));
+    ui->lineEdit_biogas_bands->setText(format(result.bands.biogas));
 }
 
 /**
@@ -447,26 +605,27 @@ void BiogasCalculator::mUpdateTable(QTableView *table_ptr, bool show)
 }
 
 /**
- * Updates Tables by reloading paired pointers and appearance
- * Operation will be aborted if querry is not SELECT type or invalid
- * @param qry - SQL querry to be executed (reference)
+ * Shows loading state of window while volume or first page of substrates are being loaded
+ * (busy cursor, table of available substrates and selecting are disabled)
+ * Busy cursor is shown also while Monte Carlo run is in progress
  */
-bool BiogasCalculator::mUpdateTableAvailableSubstrates(QSqlQuery &qry)
+void BiogasCalculator::mUpdateLoadingState()
 {
-    if(!(qry.isSelect() && qry.isValid()))
-    {
-        QMessageBox::warning(this,
-                             "Failed to Load Substrates",
-                             qry.lastError().text());
-        return false;
-    }
+    bool loading(m_volume_qry.isPending()
+                 || (m_model_substrates_available_ptr->isLoading()
+                     && m_model_substrates_available_ptr->rowCount() == 0));
 
-    m_model_substrates_available_ptr->setQuery(qry);
+    ui->tableView_available_substrates->setDisabled(loading);
+    ui->pushButton_select_substrate->setDisabled(loading);
 
-
-
-    mUpdateTable(ui->tableView_available_substrates, true);
-    return true;
+    if (loading || m_bands_watcher.isRunning())
+    {
+        setCursor(Qt::BusyCursor);
+    }
+    else
+    {
+        unsetCursor();
+    }
 }
 
 
@@ -511,28 +670,109 @@ bool BiogasCalculator::mIsAdditionPossible(const QString &substrate_name)
 }
 
 /**
- *  Checks if selected substrate is already in table with picked substrates
- * @param id - substrate ID
+ * Picks mix of substrates of catalog giving the most methane (see on_pushButton_optimize_mix_clicked)
  *
+ * @param catalog - substrates available to user (rows of schema::Substrate)
+ * @param stock - available amount of each substrate
+ * @param ts - TS used for all substrates
  */
-bool BiogasCalculator::mIsAvailableSubstrateRecorded(const qlonglong id)
+void BiogasCalculator::mOptimizeMix(const database::QueryResult &catalog, double stock, double ts)
 {
-    qlonglong row_count(0);
-    if(m_model_substrates_picked_ptr)
+    std::vector<yield::Candidate> candidates;
+    QHash<qlonglong, schema::Substrate::Row> substrates;
+
+    candidates.reserve(size_t(catalog.rows.size()));
+    substrates.reserve(catalog.rows.size());
+
+    for(const auto &row: catalog.rows)
     {
-        row_count = m_model_substrates_picked_ptr->rowCount();
+        const schema::Substrate::Row substrate(schema::Substrate::decode(row));
+
+        candidates.push_back(yield::Candidate{yield::Substrate{substrate.id, substrate.ots, substrate.biogas, substrate.methane},
+                                              ts,
+                                              stock});
+        substrates.insert(substrate.id, substrate);
     }
 
-    for (auto row = 0; row < row_count; row++)
+    std::vector<yield::FeedItem> feed;
+    yield::Result result;
+    QString error("");
+
+    if(!yield::optimizeMix(candidates, m_max_volume, feed, result, error))
     {
-        if(m_model_substrates_picked_ptr->data(m_model_substrates_picked_ptr->index(row, 0)).toLongLong() == id)
-        {
-            QMessageBox::information(this,
-                                     "Record Already exists",
-                                     "That substrate already exists in table");
+        QMessageBox::warning(this,
+                             "Operation cannot be executed",
+                             error);
+        return;
+    }
 
-            return true;
-        }
+    std::vector<sqlModels::PickedSubstrate> picked;
+    picked.reserve(feed.size());
+
+    for(const auto &item: feed)
+    {
+        picked.push_back(sqlModels::PickedSubstrate{substrates.value(item.substrate_id), item.amount, item.ts});
+    }
+
+    m_model_substrates_picked_ptr->clear();
+    m_model_substrates_picked_ptr->appendRows(picked);
+
+    mUpdateAvailableVolume();
+    mUpdateExpectedResults();
+
+    mUpdateTable(ui->tableView_chosen_substrates);
+}
+
+/**
+ * Validates if set Amount (stock of each substrate), TS and volume of plant
+ * allow to optimize mix:
+ * -Amount have to be positive Double Value
+ * -Ts have to be positive Percentage value
+ * -Volume of plant have to be loaded and positive
+ */
+bool BiogasCalculator::mIsOptimizationPossible()
+{
+    if(!validator::isPositiveDouble(ui->lineEdit_substrate_amount->text().toDouble()))
+    {
+        QMessageBox::warning(this,
+                             "Operation cannot be executed",
+                             "Amount (stock of each substrate) has to be positive value");
+        return false;
+    }
+
+    if(!validator::isPositivePercentage(ui->lineEdit_TS->text()))
+    {
+        QMessageBox::warning(this,
+                             "Operation cannot be executed",
+                             "TS has to be positive, percentage value");
+        return false;
+    }
+
+    if(m_volume_qry.isPending() || m_max_volume <= 0)
+    {
+        QMessageBox::warning(this,
+                             "Operation cannot be executed",
+                             "Plant has no volume available");
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ *  Checks if selected substrate is already in table with picked substrates
+ * @param id - substrate ID
+ *
+ */
+bool BiogasCalculator::mIsAvailableSubstrateRecorded(const qlonglong id)
+{
+    if(m_model_substrates_picked_ptr && m_model_substrates_picked_ptr->contains(id))
+    {
+        QMessageBox::information(this,
+                                 "Record Already exists",
+                                 "That substrate already exists in table");
+
+        return true;
     }
 
     return false;
@@ -559,7 +799,29 @@ void BiogasCalculator::mConfigureTable(QTableView *table_ptr)
     {
         table_ptr->setSelectionBehavior(QTableView::SelectRows);
 
-        m_model_substrates_available_ptr = std::unique_ptr<QSqlQueryModel>(new QSqlQueryModel());
+        m_model_substrates_available_ptr = std::unique_ptr<sqlModels::PagedTable>(new sqlModels::PagedTable());
+
+        connect(m_model_substrates_available_ptr.get(), &sqlModels::PagedTable::pageLoaded,
+                this, [this](int)
+        {
+            // Model is attached to table with first page, next pages are appended
+            if(ui->tableView_available_substrates->model() != m_model_substrates_available_ptr.get())
+            {
+                mUpdateTable(ui->tableView_available_substrates, true);
+            }
+
+            mUpdateLoadingState();
+        });
+
+        connect(m_model_substrates_available_ptr.get(), &sqlModels::PagedTable::pageFailed,
+                this, [this](const QString &error)
+        {
+            QMessageBox::warning(this,
+                                 "Failed to Load Substrates",
+                                 error);
+
+            mUpdateLoadingState();
+        });
 
     }
     else if(table_ptr == ui->tableView_chosen_substrates)
@@ -581,17 +843,17 @@ void BiogasCalculator::mLoadTableAppearance(QTableView *table_ptr)
     {
         assert(m_model_substrates_available_ptr);
 
-        m_model_substrates_available_ptr->setHeaderData(0, Qt::Horizontal, "ID");
-        m_model_substrates_available_ptr->setHeaderData(1, Qt::Horizontal, QObject::tr("Name"));
-        m_model_substrates_available_ptr->setHeaderData(2, Qt::Horizontal, "oTS (%)");
-        m_model_substrates_available_ptr->setHeaderData(3, Qt::Horizontal, QObject::tr("Biogas"));
-        m_model_substrates_available_ptr->setHeaderData(4, Qt::Horizontal, QObject::tr("Methane") + " (%)");
+        m_model_substrates_available_ptr->setHeaderData(schema::Substrate::Id, Qt::Horizontal, "ID");
+        m_model_substrates_available_ptr->setHeaderData(schema::Substrate::Name, Qt::Horizontal, QObject::tr("Name"));
+        m_model_substrates_available_ptr->setHeaderData(schema::Substrate::Ots, Qt::Horizontal, "oTS (%)");
+        m_model_substrates_available_ptr->setHeaderData(schema::Substrate::Biogas, Qt::Horizontal, QObject::tr("Biogas"));
+        m_model_substrates_available_ptr->setHeaderData(schema::Substrate::Methane, Qt::Horizontal, QObject::tr("Methane") + " (%)");
 
 
-        table_ptr->setColumnWidth(0,20);     //ID
-        table_ptr->setColumnWidth(2,60);     //oTS
-        table_ptr->setColumnWidth(3,100);    //biogas
-        table_ptr->setColumnWidth(4,100);    //methane
+        table_ptr->setColumnWidth(schema::Substrate::Id, 20);
+        table_ptr->setColumnWidth(schema::Substrate::Ots, 60);
+        table_ptr->setColumnWidth(schema::Substrate::Biogas, 100);
+        table_ptr->setColumnWidth(schema::Substrate::Methane, 100);
 
     }
 
@@ -599,20 +861,12 @@ void BiogasCalculator::mLoadTableAppearance(QTableView *table_ptr)
     {
         assert(m_model_substrates_picked_ptr);
 
-        m_model_substrates_picked_ptr->setHeaderData(0, Qt::Horizontal, "ID");
-        m_model_substrates_picked_ptr->setHeaderData(1, Qt::Horizontal, QObject::tr("Name"));
-        m_model_substrates_picked_ptr->setHeaderData(2, Qt::Horizontal, "oTS (%)");
-        m_model_substrates_picked_ptr->setHeaderData(3, Qt::Horizontal, QObject::tr("Biogas"));
-        m_model_substrates_picked_ptr->setHeaderData(4, Qt::Horizontal, QObject::tr("Methane") + " (%)");
-        m_model_substrates_picked_ptr->setHeaderData(5, Qt::Horizontal, QObject::tr("Amount"));
-        m_model_substrates_picked_ptr->setHeaderData(6, Qt::Horizontal, "TS (%)");
-
-        table_ptr->setColumnWidth(0,20);     //ID
-        table_ptr->setColumnWidth(2,60);     //oTS
-        table_ptr->setColumnWidth(3,100);    //biogas
-        table_ptr->setColumnWidth(4,100);    //methane
-        table_ptr->setColumnWidth(5,80);     //amount
-        table_ptr->setColumnWidth(6,60);     //Ts
+        table_ptr->setColumnWidth(schema::Substrate::Id, 20);
+        table_ptr->setColumnWidth(schema::Substrate::Ots, 60);
+        table_ptr->setColumnWidth(schema::Substrate::Biogas, 100);
+        table_ptr->setColumnWidth(schema::Substrate::Methane, 100);
+        table_ptr->setColumnWidth(sqlModels::PickedSubstratesTable::Amount, 80);
+        table_ptr->setColumnWidth(sqlModels::PickedSubstratesTable::Ts, 60);
     }
 }
 
@@ -630,6 +884,8 @@ void BiogasCalculator::mBlockWindow()
     ui->pushButton_clear_all->setDisabled(true);
     ui->pushButton_remove_substrate->setDisabled(true);
     ui->pushButton_select_substrate->setDisabled(true);
+    ui->pushButton_optimize_mix->setDisabled(true);
+    ui->checkBox_monte_carlo->setDisabled(true);
 }
 
 
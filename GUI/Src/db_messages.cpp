@@ -1,4 +1,4 @@
-#include "Database/Inc/db_messages.h"
+#include "GUI/Inc/db_messages.h"
 
 #include <QInputDialog>
 
@@ -85,4 +85,39 @@ bool showInputDialogInt(const QString &var_name,
     return result;
 }
 
+/**
+ * Installs dialogs of this namespace as error handler and configuration prompt of database
+ * (database reports errors only through them - see DbManager::setErrorHandler)
+ *
+ * @param db - database that will show dialogs
+ * @param *parent - Pointer to parent QWidget, leave nullptr if there's no parent
+ */
+void installDialogs(DbManager &db, QWidget *parent)
+{
+    db.setErrorHandler([parent](const QString &error)
+    {
+        showDbCriticalError(error, parent);
+    });
+
+    db.setConfigPrompt([parent](const QString &var_name, QVariant &var)
+    {
+        bool result(false);
+
+        if(var.type() == QVariant::Int)
+        {
+            int number(var.toInt());
+            result = showInputDialogInt(var_name, number, 0, 65535, 1, parent);
+            var = number;
+        }
+        else
+        {
+            QString text(var.toString());
+            result = showInputDialogText(var_name, text, parent);
+            var = text;
+        }
+
+        return result;
+    });
+}
+
 }//namespace db_msg
@@ -1,6 +1,7 @@
 #include "GUI/Inc/login.h"
 #include "ui_login.h"
 #include "Database/Inc/database.h"
+#include "Database/Inc/db_session.h"
 #include "Misc/Inc/utils.h"
 #include "GUI/Inc/menu.h"
 
@@ -37,6 +38,9 @@ Login::~Login()
  * Note: In this prototype password is being sent still directly
  *  which is not safe - for final form of project will be changed
  *
+ * After authentication data of session is loaded (see database::bootstrapSession)
+ *  and Menu is opened with it
+ *
  */
 void Login::on_pushButton_sign_in_clicked()
 {
@@ -45,14 +49,12 @@ void Login::on_pushButton_sign_in_clicked()
         return;
     }
 
-    QSqlQuery qry(m_db_ptr->getDatabase());
-
-    qry.prepare("SELECT userID FROM biogas_server_user "
-                "WHERE userID = :username AND (password = :password OR password = :hashed_password)");
+    QSqlQuery qry(m_db_ptr->preparedQuery("SELECT userID FROM biogas_server_user "
+                                          "WHERE userID = :username AND (password = :password OR password = :hashed_password)"));
     qry.bindValue(":username",ui->lineEdit_user->text());
     qry.bindValue(":password",ui->lineEdit_password->text());
     qry.bindValue(":hashed_password", encoding::MD5(ui->lineEdit_password->text()));
-    qry.exec();
+    qry_helper::exec(qry);
 
     int result_count(0);
     while(qry.next())
@@ -60,11 +62,23 @@ void Login::on_pushButton_sign_in_clicked()
 
     if(result_count == 1)
     {
-        this->hide();
-
-        main_menu = std::unique_ptr<Menu>(new Menu(ui->lineEdit_user->text().toUInt(),
-                                                   m_db_ptr) );
-        main_menu->show();
+        ui->pushButton_sign_in->setDisabled(true);
+        setCursor(Qt::BusyCursor);
+
+        // Menu is shown with data of whole session loaded at once
+        database::bootstrapSession(m_db_ptr,
+                                   ui->lineEdit_user->text().toUInt(),
+                                   this,
+                                   [this](const database::SessionData &session)
+        {
+            ui->pushButton_sign_in->setDisabled(false);
+            unsetCursor();
+
+            this->hide();
+
+            main_menu = std::unique_ptr<Menu>(new Menu(session, m_db_ptr) );
+            main_menu->show();
+        });
     }
     else
     {
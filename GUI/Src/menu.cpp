@@ -2,11 +2,12 @@
 #include "ui_menu.h"
 #include "Misc/Inc/validators.h"
 #include "Misc/Inc/utils.h"
+#include "Database/Inc/db_schema.h"
 #include <QMessageBox>
 #include <QDebug>
 #include <QSqlError>
 
-Menu::Menu(const unsigned int &user_id, DbSQL db_ptr, QWidget *parent):
+Menu::Menu(const database::SessionData &session, DbSQL db_ptr, QWidget *parent):
     QMainWindow(parent),
     ui(new Ui::Menu),
     m_db_ptr(db_ptr)
@@ -16,26 +17,47 @@ Menu::Menu(const unsigned int &user_id, DbSQL db_ptr, QWidget *parent):
     ui->tab_personal_data->setAutoFillBackground(true);
     ui->tab_contact_data->setAutoFillBackground(true);
 
-    logInUser(user_id);
+    logInUser(session);
 }
 
 Menu::~Menu()
 {
+    m_personal_data_qry.cancel();
+    m_address_qry.cancel();
+
     delete ui;
 }
 
 /**
  *  Perform LogIn action - Loads User Data to form
+ *  Data loaded with session is shown at once, parts that failed to load are queried again
  */
-void Menu::logInUser(const unsigned int &user_id)
+void Menu::logInUser(const database::SessionData &session)
 {
-    assert(user_id > 0);
+    assert(session.user_id > 0);
 
-    m_user_id = user_id;
+    m_user_id = session.user_id;
     ui->label_username->setText(QString::number(m_user_id));
 
-    loadPersonalData();
-    loadCorespondanceAddress();
+    if(session.profile.ok)
+    {
+        mShowPersonalData(session.profile);
+    }
+    else
+    {
+        loadPersonalData();
+    }
+
+    if(session.address.ok)
+    {
+        mShowCorespondanceAddress(session.address);
+    }
+    else
+    {
+        loadCorespondanceAddress();
+    }
+
+    m_prefetched_phones = session.phones;
 }
 
 /**
@@ -92,7 +114,7 @@ void Menu::on_pushButton_update_data_clicked()
     qry_helper::bindValueOrNull(qry, ":email", ui->lineEdit_email->text());
     qry.bindValue(":user", m_user_id);
 
-    if (!qry.exec() )
+    if (!qry_helper::exec(qry) )
     {
         QMessageBox::critical(this,
                               "Unable to change Data",
@@ -140,7 +162,7 @@ void Menu::on_pushButton_change_password_clicked()
     qry.bindValue(":password", ui->lineEdit_old_password->text());
     qry.bindValue(":hashed_password", encoding::MD5(ui->lineEdit_old_password->text()));
 
-    if(qry.exec())
+    if(qry_helper::exec(qry))
     {
         int result_count(0);
 
@@ -188,6 +210,7 @@ void Menu::on_pushButton_change_password_clicked()
  * - Street or City is Empty or Whitespace
  *
  * If there's no record associated with user - creates new one
+ * (update and insert are executed in worker thread as one transaction)
  *
  */
 void Menu::on_pushButton_edit_address_clicked()
@@ -230,62 +253,53 @@ void Menu::on_pushButton_edit_address_clicked()
         return;
     }
 
-    QSqlQuery qry(m_db_ptr->getDatabase());
-
-    qry.prepare("SELECT userID_id "
-                "FROM biogas_server_corespondanceaddres "
-                "WHERE userID_id = :user");
-
-    qry.bindValue(":user", m_user_id);
-
-    if(!qry.exec())
-    {
-        QMessageBox::critical(this,
-                              "Unable to load Data",
-                              qry.lastError().text());
-        return;
-    }
-    else
+    const QVariantMap address{{":user", m_user_id},
+                              {":city", qry_helper::valueOrNull(city)},
+                              {":street", qry_helper::valueOrNull(street)},
+                              {":number", qry_helper::valueOrNull(number)},
+                              {":code", qry_helper::valueOrNull(postal_code)},
+                              {":country", qry_helper::valueOrNull(country)}};
+
+    // Update and insert of missing record are sent together as one transaction
+    qry_helper::BatchWriter batch;
+
+    batch.add("UPDATE biogas_server_corespondanceaddres "
+              "SET city= :city, street = :street, number = :number, postalCode = :code, country = :country "
+              "WHERE userID_id = :user",
+              address);
+
+    QVariantMap new_address(address);
+    new_address.insert(":owner", m_user_id);
+
+    batch.add("INSERT INTO biogas_server_corespondanceaddres "
+              "(userID_id, city, street, number, postalCode, country) "
+              "SELECT userID, :city, :street, :number, :code, :country "
+              "FROM biogas_server_user "
+              "WHERE userID = :user AND NOT EXISTS "
+              "(SELECT 1 FROM biogas_server_corespondanceaddres WHERE userID_id = :owner)",
+              new_address);
+
+    ui->pushButton_edit_address->setDisabled(true);
+
+    database::execBatchAsync(m_db_ptr,
+                             batch,
+                             this,
+                             [this](const database::QueryResult &result)
     {
-        int result_count(0);
-        while(qry.next())
-            result_count++;
-
-        qry.clear();
-
-        if (result_count == 1)
-        {
-            qry.prepare("UPDATE biogas_server_corespondanceaddres "
-                        "SET city= :city, street = :street, number = :number, postalCode = :code, country = :country "
-                        "WHERE userID_id = :user");
-        }
-        else
-        {
-            qry.prepare("INSERT INTO biogas_server_corespondanceaddres "
-                        "(userID_id, city, street, number, postalCode, country) "
-                        "VALUES (:user, :city, :street, :number, :code, :country)");
-        }
-
-        qry.bindValue(":user", m_user_id);
-        qry_helper::bindValueOrNull(qry, ":city", city);
-        qry_helper::bindValueOrNull(qry, ":street", street);
-        qry_helper::bindValueOrNull(qry, ":number", number);
-        qry_helper::bindValueOrNull(qry, ":code", postal_code);
-        qry_helper::bindValueOrNull(qry, ":country", country);
+        ui->pushButton_edit_address->setDisabled(false);
 
-        if(!qry.exec())
+        if(!result.ok)
         {
             QMessageBox::critical(this,
                                   "Unable to update Corespondance Address",
-                                  qry.lastError().text());
+                                  result.error);
             return;
         }
 
         QMessageBox::information(this,
                                  "Data Changed",
                                  "New Address has been set");
-
-    }
+    });
 }
 
 /*
@@ -294,7 +308,9 @@ void Menu::on_pushButton_edit_address_clicked()
 */
 void Menu::on_pushButton_phone_numbers_clicked()
 {
-    m_phone_window_ptr = std::make_shared<PhoneTable>(m_user_id,m_db_ptr);
+    // Numbers loaded with session are valid only until first edit in PhoneTable
+    m_phone_window_ptr = std::make_shared<PhoneTable>(m_user_id, m_db_ptr, m_prefetched_phones);
+    m_prefetched_phones = database::QueryResult();
 
     m_phone_window_ptr.get()->setModal(true);
     this->setDisabled(true);
@@ -310,8 +326,9 @@ void Menu::on_pushButton_phone_numbers_clicked()
 /**
  * Retrieves and loads to form Corespondance Address of user
  * that is saved in database
+ * Note: Query runs in database worker thread
  *
- * @return true if operation went succesfully
+ * @return true if loading has been started
  */
 bool Menu::loadCorespondanceAddress()
 {
@@ -320,55 +337,56 @@ bool Menu::loadCorespondanceAddress()
         return false;
     }
 
-    QString street(""),
-            city(""),
-            number(""),
-            postal_code(""),
-            country("");
-
-    QSqlQuery qry(m_db_ptr->getDatabase());
-
-    qry.prepare("SELECT city, street, number, postalCode AS post, country "
-                "FROM biogas_server_corespondanceaddres "
-                "WHERE userID_id = :user");
-    qry.bindValue(":user", m_user_id);
-
-    if (qry.exec())
+    m_address_qry.cancel();
+    m_address_qry = database::execAsync(m_db_ptr,
+                                        schema::selectFrom<schema::Address>() + " WHERE userID_id = :user",
+                                        {{":user", m_user_id}},
+                                        this,
+                                        [this](const database::QueryResult &result)
     {
-        int result_count(0);
-
-        while(qry.next())
-            result_count++;
-
-        if(result_count == 1)
+        if(!result.ok)
         {
-            qry.previous();
-            city = qry.value(0).toString();
-            street = qry.value(1).toString();
-            number = qry.value(2).toString();
-            postal_code = qry.value(3).toString();
-            country = qry.value(4).toString();
+            QMessageBox::warning(this,
+                                 "Unable to load Address",
+                                 result.error);
+            return;
         }
 
-        ui->lineEdit_city->setText(city);
-        ui->lineEdit_street->setText(street);
-        ui->lineEdit_adress_number->setText(number);
-        ui->lineEdit_postal_code->setText(postal_code);
-        ui->lineEdit_country->setText(country);
-    }
-    else
+        mShowCorespondanceAddress(result);
+    });
+
+    return true;
+}
+
+/**
+ * Shows Corespondance Address in form
+ * Fields are cleared if user has no address (or has more than one)
+ *
+ * @param result - result of address query (city, street, number, post, country)
+ */
+void Menu::mShowCorespondanceAddress(const database::QueryResult &result)
+{
+    schema::Address::Row address;
+
+    if(result.rows.size() == 1)
     {
-        return false;
+        address = schema::Address::decode(result.rows.at(0));
     }
 
-    return true;
+    ui->lineEdit_city->setText(address.city);
+    ui->lineEdit_street->setText(address.street);
+    ui->lineEdit_adress_number->setText(address.number);
+    ui->lineEdit_postal_code->setText(address.postal_code);
+    ui->lineEdit_country->setText(address.country);
 }
 
 /**
  * Retrieves and loads to form Personal Data of user
  * that is saved in database
+ * Note: Query runs in database worker thread - until it ends
+ * personal data form is disabled
  *
- * @return true if operation went succesfully
+ * @return true if loading has been started
  */
 bool Menu::loadPersonalData()
 {
@@ -377,24 +395,46 @@ bool Menu::loadPersonalData()
         return false;
     }
 
-    QSqlQuery qry(m_db_ptr->getDatabase());
-
-    qry.prepare("SELECT name, surname, email FROM biogas_server_user "
-                "where userID = :username");
-    qry.bindValue(":username", m_user_id);
+    ui->groupBox_personal_data->setDisabled(true);
 
-    if(qry.exec() )
+    m_personal_data_qry.cancel();
+    m_personal_data_qry = database::execAsync(m_db_ptr,
+                                              schema::selectFrom<schema::Profile>() + " WHERE userID = :username",
+                                              {{":username", m_user_id}},
+                                              this,
+                                              [this](const database::QueryResult &result)
     {
-        qry.next();
+        ui->groupBox_personal_data->setDisabled(false);
 
-        ui->lineEdit_name->setText(qry.value(0).toString() );
-        ui->lineEdit_surname->setText(qry.value(1).toString() );
-        ui->lineEdit_email->setText(qry.value(2).toString() );
+        if(!result.ok)
+        {
+            QMessageBox::warning(this,
+                                 "Unable to load Data",
+                                 result.error);
+            return;
+        }
 
-        return true;
-    }
+        mShowPersonalData(result);
+    });
 
-    return false;
+    return true;
+}
+
+/**
+ * Shows Personal Data in form
+ *
+ * @param result - result of personal data query (name, surname, email)
+ */
+void Menu::mShowPersonalData(const database::QueryResult &result)
+{
+    if(!result.isEmpty())
+    {
+        const schema::Profile::Row profile(schema::Profile::decode(result.rows.at(0)));
+
+        ui->lineEdit_name->setText(profile.name);
+        ui->lineEdit_surname->setText(profile.surname);
+        ui->lineEdit_email->setText(profile.email);
+    }
 }
 
 
@@ -414,3 +454,13 @@ void Menu::on_pushButton_services_clicked()
 
     m_svcs_ptr->show();
 }
+
+/**
+ *  Opens statistics of executed queries (timings, statement cache, connections)
+ */
+void Menu::on_action_query_diagnostics_triggered()
+{
+    QueryDiagnostics diagnostics(m_db_ptr, this);
+
+    diagnostics.exec();
+}
@@ -2,32 +2,49 @@
 #include "ui_phone_table.h"
 #include "Delegates/Inc/phone_table_delegate.h"
 #include "Misc/Inc/validators.h"
+#include "Database/Inc/db_schema.h"
 #include <QMessageBox>
 #include <QSqlError>
 
 
-PhoneTable::PhoneTable(const unsigned int &user_id, DbSQL db_ptr, QWidget *parent):
+/**
+ * Creates window with phone numbers of user
+ *
+ * @param prefetched_phones - numbers loaded with session (see database::bootstrapSession),
+ * if result is not ok - numbers are loaded from database
+ */
+PhoneTable::PhoneTable(const unsigned int &user_id,
+                       DbSQL db_ptr,
+                       const database::QueryResult &prefetched_phones,
+                       QWidget *parent):
     QDialog(parent),
     ui(new Ui::PhoneTable),
     m_user_id(user_id),
     m_db_ptr(db_ptr),
-    m_table_model_ptr(new QSqlTableModel(parent, m_db_ptr->getDatabase()))
+    m_table_model_ptr(new sqlModels::ResultTable())
 {
     assert(db_ptr);
     assert(user_id > 0);
     assert(m_table_model_ptr);
 
     ui->setupUi(this);
-    if(!mLoadPhoneNumbers())
+
+    mConfigureTable();
+
+    if(prefetched_phones.ok)
     {
-        QMessageBox::warning(this,
-                             "Database Error",
-                             "Unable To Fetch Data from Database");
+        mShowPhoneNumbers(prefetched_phones);
+    }
+    else
+    {
+        mLoadPhoneNumbers();
     }
 }
 
 PhoneTable::~PhoneTable()
 {
+    m_phones_qry.cancel();
+
     delete ui;
 }
 
@@ -45,6 +62,7 @@ void PhoneTable::on_pushButton_menu_clicked()
  * Performs assigning new phone number to user
  * If given number match E.164 Standard and is not recorded already
  * - Assigning to user is done via adding record in SQL Database
+ * (check and insert are one statement executed in worker thread)
  */
 void PhoneTable::on_pushButton_add_number_clicked()
 {
@@ -58,103 +76,148 @@ void PhoneTable::on_pushButton_add_number_clicked()
         return;
     }
 
-    QSqlQuery qry(m_db_ptr->getDatabase());
+    qry_helper::BatchWriter batch;
+
+    // Number is inserted only if user doesn't have it already
+    batch.add("INSERT INTO biogas_server_phonenumber "
+              "(phoneNumber, owner_id) "
+              "SELECT :number, userID FROM biogas_server_user "
+              "WHERE userID = :user AND NOT EXISTS "
+              "(SELECT 1 FROM biogas_server_phonenumber "
+              "WHERE owner_id = :owner AND phoneNumber = :existing)",
+              {{":number", number},
+               {":user", m_user_id},
+               {":owner", m_user_id},
+               {":existing", number}});
 
+    ui->pushButton_add_number->setDisabled(true);
 
-    if(mFindRecordPhoneID(qry, number))
+    database::execBatchAsync(m_db_ptr,
+                             batch,
+                             this,
+                             [this](const database::QueryResult &result)
     {
-        int resultCount(0);
-        while(qry.next())
-            resultCount++;
+        ui->pushButton_add_number->setDisabled(false);
 
-        if (resultCount > 0)
+        if(!result.ok)
+        {
+            QMessageBox::critical(this,
+                                  "Unable to add Phone Number",
+                                  result.error);
+            return;
+        }
+
+        if(result.rows_affected == 0)
         {
             QMessageBox::warning(this,
                                  "Failed to Add Phone",
                                  "Phone Number already exists");
             return;
         }
-        else
-        {
-            qry.clear();
 
-            qry.prepare("INSERT INTO biogas_server_phonenumber "
-                        "(phoneNumber, owner_id) "
-                        "VALUES (:number, :user)");
-            qry.bindValue(":number", number);
-            qry.bindValue(":user", m_user_id);
+        QMessageBox::information(this,
+                                 "Data Changed",
+                                 "New Phone Number was added");
+        mLoadPhoneNumbers();
+    });
+}
 
-            if(!qry.exec())
-            {
-                QMessageBox::critical(this,
-                                      "Unable to add Phone Number",
-                                      qry.lastError().text());
-                return;
-            }
-            else
-                QMessageBox::information(this,
-                                         "Data Changed",
-                                         "New Phone Number was added");
-        }
-    }
-    else
-    {
-        QMessageBox::warning(this,
-                             "Unable to execute querry",
-                             "Please contact with support");
-        return;
-    }
+/**
+ * Configures table with phone numbers
+ * Only number column is visible and editable (edits are saved with mSavePhoneNumber)
+ */
+void PhoneTable::mConfigureTable()
+{
+    m_table_model_ptr->setHeaderData(schema::Phone::Number, Qt::Horizontal, tr("Phone Number"));
+    m_table_model_ptr->setEditableColumn(schema::Phone::Number);
 
-    if(!mLoadPhoneNumbers())
-    {
-        QMessageBox::warning(this,
-                             "Database Error",
-                             "Unable To Refresh Data in Table");
-    }
+    QObject::connect(m_table_model_ptr.get(),
+                     &sqlModels::ResultTable::cellEdited,
+                     this,
+                     &PhoneTable::mSavePhoneNumber);
+
+    ui->tableView->setModel(m_table_model_ptr.get());
+
+    auto *delegate_ptr = new delegate::PhoneTableDelegate(ui->tableView);
+    ui->tableView->setItemDelegateForColumn(schema::Phone::Number, delegate_ptr);
+    ui->tableView->setSelectionBehavior(QTableView::SelectRows);
 }
 
 /**
  * Loads User's list of phone numbers to table
+ * Note: Query runs in database worker thread - until it ends table is disabled
  */
-bool PhoneTable::mLoadPhoneNumbers()
+void PhoneTable::mLoadPhoneNumbers()
 {
-    m_table_model_ptr->setTable("biogas_server_phonenumber");
-    m_table_model_ptr->setFilter("owner_id = " + QString::number(m_user_id));
-    m_table_model_ptr->setEditStrategy(QSqlTableModel::OnFieldChange);
+    ui->tableView->setDisabled(true);
 
-    m_table_model_ptr->setHeaderData(1, Qt::Horizontal, tr("Phone Number"));
+    m_phones_qry.cancel();
+    m_phones_qry = database::execAsync(m_db_ptr,
+                                       schema::selectFrom<schema::Phone>() + " WHERE owner_id = :user",
+                                       {{":user", m_user_id}},
+                                       this,
+                                       [this](const database::QueryResult &result)
+    {
+        ui->tableView->setDisabled(false);
 
-    if(!m_table_model_ptr->select())
-        return false;
+        if(!result.ok)
+        {
+            QMessageBox::warning(this,
+                                 "Database Error",
+                                 "Unable To Fetch Data from Database");
+            return;
+        }
 
-    ui->tableView->setModel(m_table_model_ptr.get());
-    ui->tableView->setColumnWidth(1, 188);
+        mShowPhoneNumbers(result);
+    });
+}
 
-    ui->tableView->hideColumn(0);
-    ui->tableView->hideColumn(2);
+/**
+ * Shows phone numbers in table (only number column is visible)
+ *
+ * @param result - result of phone numbers query (phoneID, phoneNumber, owner_id)
+ */
+void PhoneTable::mShowPhoneNumbers(const database::QueryResult &result)
+{
+    m_table_model_ptr->setResult(result);
 
-    auto *delegate_ptr = new delegate::PhoneTableDelegate();
-    ui->tableView->setItemDelegateForColumn(1, delegate_ptr);
-    ui->tableView->setSelectionBehavior(QTableView::SelectRows);
+    ui->tableView->setColumnWidth(schema::Phone::Number, 188);
+    ui->tableView->hideColumn(schema::Phone::Id);
+    ui->tableView->hideColumn(schema::Phone::Owner);
 
     ui->tableView->show();
-    return true;
 }
 
 /**
- * Preperares querry to check if phone number is not already assigned to user
+ * Saves phone number edited in table
+ * If saving fails - table is reloaded to show numbers stored in database
+ *
+ * @param row - row of edited number
+ * @param column - edited column (only phone number column is editable)
+ * @param value - new phone number
  */
-bool PhoneTable::mFindRecordPhoneID(QSqlQuery &qry, const QString &phone_number)
+void PhoneTable::mSavePhoneNumber(int row, int column, const QVariant &value)
 {
-    qry.clear();
-    qry.prepare("SELECT phoneID "
-                "FROM biogas_server_phonenumber "
-                "WHERE owner_id = :user "
-                "AND phoneNumber = :number ");
-    qry.bindValue(":user", m_user_id);
-    qry.bindValue(":number", phone_number);
-
-    return qry.exec();
+    Q_UNUSED(column)
+
+    database::execAsync(m_db_ptr,
+                        "UPDATE biogas_server_phonenumber "
+                        "SET phoneNumber = :number "
+                        "WHERE phoneID = :phone AND owner_id = :user",
+                        {{":number", value},
+                         {":phone", m_table_model_ptr->index(row, schema::Phone::Id).data()},
+                         {":user", m_user_id}},
+                        this,
+                        [this](const database::QueryResult &result)
+    {
+        if(!result.ok)
+        {
+            QMessageBox::critical(this,
+                                  "Unable to change Phone Number",
+                                  result.error);
+            mLoadPhoneNumbers();
+        }
+    });
 }
 
 /**
@@ -176,10 +239,31 @@ void PhoneTable::on_pushButton_remove_clicked()
 
     if(selection && selection->hasSelection())
     {
+        qry_helper::BatchWriter batch;
+
         for (auto picked : selection->selectedRows())
         {
-            m_table_model_ptr->removeRow(picked.row());
+            batch.add("DELETE FROM biogas_server_phonenumber "
+                      "WHERE phoneID = :phone AND owner_id = :user",
+                      {{":phone", m_table_model_ptr->index(picked.row(), schema::Phone::Id).data()},
+                       {":user", m_user_id}});
         }
+
+        // All selected numbers are removed in one transaction - or none of them
+        database::execBatchAsync(m_db_ptr,
+                                 batch,
+                                 this,
+                                 [this](const database::QueryResult &result)
+        {
+            if(!result.ok)
+            {
+                QMessageBox::critical(this,
+                                      "Unable to remove Phone Number",
+                                      result.error);
+            }
+
+            mLoadPhoneNumbers();
+        });
     }
     else
     {
@@ -187,6 +271,4 @@ void PhoneTable::on_pushButton_remove_clicked()
                                  "Provide information first",
                                  "Please select first record you want to remove");
     }
-
-    mLoadPhoneNumbers();
 }
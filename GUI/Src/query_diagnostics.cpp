@@ -0,0 +1,142 @@
+#include "GUI/Inc/query_diagnostics.h"
+#include "ui_query_diagnostics.h"
+#include "Database/Inc/db_profiler.h"
+
+#include <QHeaderView>
+#include <QTableWidgetItem>
+
+
+QueryDiagnostics::QueryDiagnostics(DbSQL db_ptr, QWidget *parent) :
+    QDialog(parent),
+    ui(new Ui::QueryDiagnostics),
+    m_db_ptr(db_ptr)
+{
+    ui->setupUi(this);
+
+    mConfigTable();
+    on_pushButton_refresh_clicked();
+}
+
+QueryDiagnostics::~QueryDiagnostics()
+{
+    delete ui;
+}
+
+/**
+  * @brief Reloads statistics collected by QueryProfiler
+  */
+void QueryDiagnostics::on_pushButton_refresh_clicked()
+{
+    mLoadSummary();
+    mLoadStatements();
+}
+
+/**
+  * @brief Clears collected statistics of statements
+  */
+void QueryDiagnostics::on_pushButton_reset_clicked()
+{
+    QueryProfiler::instance().reset();
+    on_pushButton_refresh_clicked();
+}
+
+void QueryDiagnostics::on_pushButton_close_clicked()
+{
+    accept();
+}
+
+/**
+  * @brief Configures Display of Table with Statements
+  *     - Sets name for each column
+  *     - Sets width of each column
+  */
+void QueryDiagnostics::mConfigTable()
+{
+    ui->tableWidget_statements->setColumnCount(7);
+    ui->tableWidget_statements->setHorizontalHeaderLabels({QObject::tr("Statement"),
+                                                           QObject::tr("Calls"),
+                                                           QObject::tr("Total [ms]"),
+                                                           QObject::tr("Mean [ms]"),
+                                                           "p99 [ms]",
+                                                           QObject::tr("Max [ms]"),
+                                                           QObject::tr("Rows")});
+
+    ui->tableWidget_statements->setColumnWidth(0, 420); //Statement
+    for(int column = 1; column < 7; column++)
+    {
+        ui->tableWidget_statements->setColumnWidth(column, 70);
+    }
+
+    ui->tableWidget_statements->verticalHeader()->hide();
+}
+
+/**
+  * @brief Loads summary of connections: statement cache, pool, reference data cache
+  * and slow query log
+  */
+void QueryDiagnostics::mLoadSummary()
+{
+    QString summary;
+
+    if(m_db_ptr)
+    {
+        StatementCacheStats cache(m_db_ptr->statementCacheStats());
+        PoolMetrics pool(m_db_ptr->poolMetrics());
+
+        summary += QObject::tr("Statement cache - hits: %1, misses: %2, evictions: %3\n")
+                .arg(cache.hits).arg(cache.misses).arg(cache.evictions);
+        summary += QObject::tr("Worker connections - open: %1/%2, leased: %3, waits: %4, failures: %5\n")
+                .arg(pool.open_connections).arg(pool.max_connections)
+                .arg(pool.leased_connections).arg(pool.waits_total).arg(pool.lease_failures);
+
+        database::ReferenceCacheStats reference(m_db_ptr->referenceCache()->stats());
+
+        summary += QObject::tr("Reference data cache - hits: %1, misses: %2, expired: %3, entries: %4\n")
+                .arg(reference.hits).arg(reference.misses).arg(reference.expired).arg(reference.size);
+    }
+
+    SlowLogConfig slow_log(QueryProfiler::instance().slowLog());
+
+    summary += QObject::tr("Slow query log (over %1 ms): %2")
+            .arg(slow_log.threshold_ms).arg(slow_log.file_path);
+
+    ui->label_summary->setText(summary);
+}
+
+/**
+  * @brief Loads statements sorted by total time of execution
+  */
+void QueryDiagnostics::mLoadStatements()
+{
+    auto statements(QueryProfiler::instance().topByTotalTime(50));
+
+    ui->tableWidget_statements->setRowCount(int(statements.size()));
+
+    for(int row = 0; row < int(statements.size()); row++)
+    {
+        const StatementStats &stats(statements[size_t(row)]);
+
+        const QStringList values{QString(stats.sql).simplified(),
+                                 QString::number(stats.count),
+                                 QString::number(stats.total_ns / 1e6, 'f', 2),
+                                 QString::number(stats.total_ns / 1e6 / stats.count, 'f', 2),
+                                 QString::number(stats.percentileMs(0.99), 'f', 2),
+                                 QString::number(stats.max_ns / 1e6, 'f', 2),
+                                 stats.rows_unknown == 0 ? QString::number(stats.rows)
+                                                         : stats.rows_unknown == stats.count
+                                                           ? QObject::tr("unknown")
+                                                           : QObject::tr("%1 (%2 unknown)").arg(stats.rows).arg(stats.rows_unknown)};
+
+        for(int column = 0; column < values.size(); column++)
+        {
+            auto *item_ptr = new QTableWidgetItem(values[column]);
+
+            if(column == 0)
+            {
+                item_ptr->setToolTip(values[column]);
+            }
+
+            ui->tableWidget_statements->setItem(row, column, item_ptr);
+        }
+    }
+}
@@ -7,6 +7,7 @@
 #include <exception>
 
 #include "Exceptions/Common/Inc/qruntimeerror.h"
+#include "Database/Inc/db_schema.h"
 
 Services::Services(const unsigned int &user_id, DbSQL db_ptr, QWidget *parent) :
     QDialog(parent),
@@ -20,15 +21,37 @@ Services::Services(const unsigned int &user_id, DbSQL db_ptr, QWidget *parent) :
     {
         m_svcs_mdl_ptr.reset(new sqlModels::ServiceTable);
 
-        if(mLoadSvcs())
+        ui->tableView_services->setModel(m_svcs_mdl_ptr.get());
+        mConfigSvcsTable();
+
+        connect(m_svcs_mdl_ptr.get(), &sqlModels::PagedTable::pageLoaded,
+                this, [this](int)
         {
-            mConfigSvcsTable();
-        }
+            mSetLoadingState(false);
+        });
+
+        connect(m_svcs_mdl_ptr.get(), &sqlModels::PagedTable::pageFailed,
+                this, [this](const QString &error)
+        {
+            mSetLoadingState(false);
+
+            QError::QRuntimeError(error)
+                    .showWarningWindow(this, QObject::tr("Failed to Load Services"));
+
+            mBlockWindow();
+        });
+
+        mLoadSvcs();
     }
 }
 
 Services::~Services()
 {
+    if(m_svcs_mdl_ptr)
+    {
+        m_svcs_mdl_ptr->cancel();
+    }
+
     delete ui;
 }
 
@@ -55,7 +78,7 @@ void Services::on_pushButton_menu_clicked()
 }
 
 /**
-  * @brief Load Plants that are available to logged in user (With using SQL statement)
+  * @brief Load Plants that are available to logged in user (from cache shared by windows)
   * Note: If operation will end with failure - Service Window will be blocked
   * @retval True - if operartion will complete without any failures
   */
@@ -65,23 +88,19 @@ bool Services::mLoadPlants() noexcept
     {
         ui->comboBox_plants->clear();
 
-        QSqlQuery qry(m_db_ptr.get()->getDatabase());
-
-        qry.prepare("SELECT PlantID, location "
-                    "FROM biogas_server_plant "
-                    "WHERE owner_id = :user");
-        qry.bindValue(":user", m_user_id);
+        database::QueryResult result(m_db_ptr->referenceCache()
+                                     ->fetchNow(database::ReferenceData::Plants, m_user_id));
 
-        if(qry.exec())
+        if(result.ok)
         {
             m_plants_available.clear();
 
-            while(qry.next())
+            for(int row = 0; row < result.rows.size(); row++)
             {
-                QString temp = qry.value(0).toString() + " - " + qry.value(1).toString();
-                ui->comboBox_plants->addItem(temp);
+                const schema::Plant::Row plant(schema::Plant::decode(result.rows.at(row)));
 
-                m_plants_available.push_back(qry.value(0).toULongLong());
+                ui->comboBox_plants->addItem(QString::number(plant.id) + " - " + plant.location);
+                m_plants_available.push_back(static_cast<unsigned long long>(plant.id));
             }
 
             if(!m_plants_available.empty())
@@ -117,51 +136,25 @@ bool Services::mLoadPlants() noexcept
 
 /**
   * @brief Load Services that are saved for picked plant (With using SQL statement)
+  *     Services are read in pages ordered by (date, serviceID) - first page is loaded
+  *     here, next ones when table is scrolled to its end, so each page takes the same
+  *     time no matter how long service history of plant is
   * Note: If operation will end with failure - Service Window will be blocked
-  * @retval True - if operartion will complete without any failures
   */
-bool Services::mLoadSvcs() noexcept
+void Services::mLoadSvcs() noexcept
 {
-    try
-    {
-        QSqlQuery qry(m_db_ptr.get()->getDatabase());
-
-        qry.prepare("SELECT date, title, description, done, notice "
-                    "FROM biogas_server_service "
-                    "WHERE forPlant_id = :plant "
-                    "GROUP BY date");
-        qry.bindValue(":plant", m_plant_picked);
-
-        if(qry.exec())
-        {
-            m_svcs_mdl_ptr->setQuery(qry);
-            ui->tableView_services->setModel(m_svcs_mdl_ptr.get());
-        }
-
-        else
-        {
-            throw QError::QRuntimeError(qry.lastError().text());
-        }
-    }
-    catch (const QError::QRuntimeError &e)
-    {
-        e.showWarningWindow(this, QObject::tr("Failed to Load Services"));
-
-        mBlockWindow();
-
-        return false;
-    }
-    catch (std::exception &e)
-    {
-        QMessageBox::warning(this,
-                             "Failed to Load Services",
-                             e.what());
-        mBlockWindow();
-
-        return false;
-    }
-
-    return true;
+    static const int page_rows(200);
+    static const QString select(schema::selectFrom<schema::Service>());
+
+    mSetLoadingState(true);
+
+    m_svcs_mdl_ptr->setQuery(m_db_ptr,
+                             database::KeysetPager(select,
+                                                   "forPlant_id = :plant",
+                                                   {{":plant", m_plant_picked}},
+                                                   {{"date", schema::Service::Date},
+                                                    {"serviceID", schema::Service::Id}},
+                                                   page_rows));
 }
 
 /**
@@ -174,22 +167,42 @@ void Services::mConfigSvcsTable()
 {
     assert(m_svcs_mdl_ptr);
 
-    m_svcs_mdl_ptr->setHeaderData(0, Qt::Horizontal, QObject::tr("Date"));
-    m_svcs_mdl_ptr->setHeaderData(1, Qt::Horizontal, QObject::tr("Title"));
-    m_svcs_mdl_ptr->setHeaderData(2, Qt::Horizontal, QObject::tr("Description"));
-    m_svcs_mdl_ptr->setHeaderData(3, Qt::Horizontal, QObject::tr("Done"));
-    m_svcs_mdl_ptr->setHeaderData(4, Qt::Horizontal, QObject::tr("Notice"));
+    m_svcs_mdl_ptr->setHeaderData(schema::Service::Date, Qt::Horizontal, QObject::tr("Date"));
+    m_svcs_mdl_ptr->setHeaderData(schema::Service::Title, Qt::Horizontal, QObject::tr("Title"));
+    m_svcs_mdl_ptr->setHeaderData(schema::Service::Description, Qt::Horizontal, QObject::tr("Description"));
+    m_svcs_mdl_ptr->setHeaderData(schema::Service::Done, Qt::Horizontal, QObject::tr("Done"));
+    m_svcs_mdl_ptr->setHeaderData(schema::Service::Notice, Qt::Horizontal, QObject::tr("Notice"));
 
-    ui->tableView_services->setColumnWidth(0, 90); //Date
-    ui->tableView_services->setColumnWidth(1, 200); //Title
-    ui->tableView_services->setColumnWidth(2, 400); //Description
-    ui->tableView_services->setColumnWidth(3, 20); //Done
-    ui->tableView_services->setColumnWidth(4, 200); //Notice
+    ui->tableView_services->setColumnWidth(schema::Service::Date, 90);
+    ui->tableView_services->setColumnWidth(schema::Service::Title, 200);
+    ui->tableView_services->setColumnWidth(schema::Service::Description, 400);
+    ui->tableView_services->setColumnWidth(schema::Service::Done, 20);
+    ui->tableView_services->setColumnWidth(schema::Service::Notice, 200);
+    ui->tableView_services->setColumnHidden(schema::Service::Id, true);
 
     ui->tableView_services->verticalHeader()->setDefaultSectionSize(50);
     ui->tableView_services->show();
 }
 
+/**
+  * @brief Shows loading state while services are being loaded
+  *     (busy cursor, disabled plant picker - table stays scrollable while next page loads)
+  * @param loading - true if query is running
+  */
+void Services::mSetLoadingState(bool loading)
+{
+    ui->comboBox_plants->setDisabled(loading);
+
+    if(loading)
+    {
+        setCursor(Qt::BusyCursor);
+    }
+    else
+    {
+        unsetCursor();
+    }
+}
+
 /**
   * @brief Performs "Block Window" operation
   *     Disables Ui components placed in Window
@@ -0,0 +1,21 @@
+#ifndef TOOL_UTILS_H
+#define TOOL_UTILS_H
+
+#include <cstdio>
+
+#include <QFile>
+#include <QSqlDatabase>
+#include <QString>
+
+#include "Calculation/Inc/biogas_yield.h"
+
+
+namespace tools{
+
+    bool loadCatalog(QSqlDatabase &db, yield::Catalog &catalog, QString &error);
+
+    bool openStream(QFile &file, const char *path, QIODevice::OpenMode mode, FILE *standard);
+
+}//namespace tools
+
+#endif // TOOL_UTILS_H
@@ -0,0 +1,274 @@
+/**
+ * Headless batch calculator of feeding scenarios
+ *
+ * Reads scenarios as JSON Lines, one per line:
+ *   {"id": "s1", "plant": 3, "feed": [{"substrate": 12, "amount": 10.5, "ts": 20}, ...]}
+ * and writes one result line per scenario, in order of input:
+ *   {"id": "s1", "plant": 3, "methane": ..., "biogas": ..., "amount": ..., "max_volume": ..., "fits": true}
+ * Scenario that can't be evaluated gives {"id": ..., "line": ..., "error": "..."}
+ *
+ * Substrate catalog and volumes of plants are loaded once from database file,
+ * then scenarios are read in blocks and each block is evaluated on all cores
+ * (memory depends on size of block, not on size of input).
+ *
+ * Usage: batch_calculator <path to database file> [input.jsonl|-] [output.jsonl|-]
+ */
+#include "Calculation/Inc/biogas_yield.h"
+#include "Tools/Inc/tool_utils.h"
+
+#include <algorithm>
+#include <vector>
+
+#include <QCoreApplication>
+#include <QFile>
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonParseError>
+#include <QSqlDatabase>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QTextStream>
+#include <QThread>
+#include <QVariant>
+#include <QtConcurrent/QtConcurrentMap>
+
+namespace {
+
+    struct Scenario
+    {
+        qint64 line;
+        QByteArray input;
+        QByteArray output;
+    };
+
+    typedef QHash<qlonglong, double> PlantVolumes;
+
+}
+
+/* ************************
+ * Local Functions Prototypes - Begin
+ *************************/
+
+static bool loadPlantVolumes(QSqlDatabase &db, PlantVolumes &volumes, QString &error);
+
+static void evaluate(Scenario &scenario,
+                     const yield::Catalog &catalog,
+                     const PlantVolumes &volumes);
+
+static QByteArray errorLine(const QJsonValue &id, qint64 line, const QString &error);
+
+/* ************************
+ * Local Functions Prototypes - End
+ *************************/
+
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QTextStream err(stderr);
+
+    if(argc < 2)
+    {
+        err << "Usage: batch_calculator <path to database file> [input.jsonl|-] [output.jsonl|-]\n";
+        return 1;
+    }
+
+    yield::Catalog catalog;
+    PlantVolumes volumes;
+    QString error("");
+
+    {
+        auto db = QSqlDatabase::addDatabase("QSQLITE", "batch_calculator");
+        db.setDatabaseName(QString::fromLocal8Bit(argv[1]));
+        db.setConnectOptions("QSQLITE_OPEN_READONLY");
+
+        if(!db.open())
+        {
+            error = db.lastError().text();
+        }
+        else if(tools::loadCatalog(db, catalog, error))
+        {
+            loadPlantVolumes(db, volumes, error);
+        }
+
+        db.close();
+    }
+    QSqlDatabase::removeDatabase("batch_calculator");
+
+    if(!error.isEmpty())
+    {
+        err << "Unable to load catalog: " << error << '\n';
+        return 1;
+    }
+
+    QFile input, output;
+
+    if(!tools::openStream(input, argc > 2 ? argv[2] : "-", QIODevice::ReadOnly, stdin)
+            || !tools::openStream(output, argc > 3 ? argv[3] : "-", QIODevice::WriteOnly | QIODevice::Truncate, stdout))
+    {
+        err << "Unable to open input or output\n";
+        return 1;
+    }
+
+    // Block is big enough to keep all cores busy, small enough to keep memory flat
+    const int block_size(1024 * std::max(1, QThread::idealThreadCount()));
+
+    std::vector<Scenario> block;
+    block.reserve(size_t(block_size));
+
+    qint64 line(0),
+           evaluated(0);
+
+    while(!input.atEnd())
+    {
+        block.clear();
+
+        while(int(block.size()) < block_size && !input.atEnd())
+        {
+            QByteArray text(input.readLine().trimmed());
+            ++line;
+
+            if(!text.isEmpty())
+            {
+                block.push_back(Scenario{line, text, QByteArray()});
+            }
+        }
+
+        QtConcurrent::blockingMap(block, [&catalog, &volumes](Scenario &scenario)
+                                  {evaluate(scenario, catalog, volumes); });
+
+        for(const auto &scenario: block)
+        {
+            output.write(scenario.output);
+            output.write("\n", 1);
+        }
+
+        evaluated += qint64(block.size());
+    }
+
+    output.flush();
+
+    err << "Evaluated " << evaluated << " scenarios against "
+        << catalog.size() << " substrates\n";
+
+    return 0;
+}
+
+
+/* ************************
+ * Local Functions - Begin
+ *************************/
+
+/**
+ * Loads volume of each plant (sum of volume of its containers)
+ *
+ * @return false if query failed (error is set)
+ */
+static bool loadPlantVolumes(QSqlDatabase &db, PlantVolumes &volumes, QString &error)
+{
+    QSqlQuery qry(db);
+    qry.setForwardOnly(true);
+
+    if(!qry.exec("SELECT fromPlant_id, SUM(volume) "
+                 "FROM biogas_server_container "
+                 "GROUP BY fromPlant_id"))
+    {
+        error = qry.lastError().text();
+        return false;
+    }
+
+    while(qry.next())
+    {
+        volumes.insert(qry.value(0).toLongLong(), qry.value(1).toDouble());
+    }
+
+    return true;
+}
+
+/**
+ * Evaluates one scenario (called in worker threads - touches only given scenario)
+ * Result line is stored in scenario.output
+ *
+ * @param scenario - line of input
+ * @param catalog - substrates available to scenarios
+ * @param volumes - volume of each plant
+ */
+static void evaluate(Scenario &scenario,
+                     const yield::Catalog &catalog,
+                     const PlantVolumes &volumes)
+{
+    QJsonParseError parse_error;
+    const QJsonDocument document(QJsonDocument::fromJson(scenario.input, &parse_error));
+
+    if(!document.isObject())
+    {
+        scenario.output = errorLine(QJsonValue(), scenario.line,
+                                    parse_error.error != QJsonParseError::NoError
+                                    ? parse_error.errorString()
+                                    : QObject::tr("Scenario has to be JSON object"));
+        return;
+    }
+
+    const QJsonObject object(document.object());
+    const QJsonValue id(object.value("id"));
+    const QJsonArray feed_array(object.value("feed").toArray());
+
+    std::vector<yield::FeedItem> feed;
+    feed.reserve(size_t(feed_array.size()));
+
+    for(const auto &value: feed_array)
+    {
+        const QJsonObject item(value.toObject());
+        const double amount(item.value("amount").toDouble(-1));
+        const double ts(item.value("ts").toDouble(-1));
+
+        if(amount <= 0 || ts <= 0 || ts > 100)
+        {
+            scenario.output = errorLine(id, scenario.line,
+                                        QObject::tr("Amount has to be positive and TS has to be positive percentage"));
+            return;
+        }
+
+        feed.push_back(yield::FeedItem{qlonglong(item.value("substrate").toDouble()), amount, ts});
+    }
+
+    yield::Result result;
+    QString error("");
+
+    if(!yield::mixYield(catalog, feed, result, error))
+    {
+        scenario.output = errorLine(id, scenario.line, error);
+        return;
+    }
+
+    const qlonglong plant(qlonglong(object.value("plant").toDouble()));
+    const double max_volume(volumes.value(plant, 0));
+
+    QJsonObject output{{"id", id},
+                       {"plant", plant},
+                       {"methane", result.methane},
+                       {"biogas", result.biogas},
+                       {"amount", result.amount},
+                       {"max_volume", max_volume},
+                       {"fits", result.amount <= max_volume}};
+
+    scenario.output = QJsonDocument(output).toJson(QJsonDocument::Compact);
+}
+
+/**
+ * @return result line of scenario that couldn't be evaluated
+ */
+static QByteArray errorLine(const QJsonValue &id, qint64 line, const QString &error)
+{
+    QJsonObject output{{"id", id},
+                       {"line", line},
+                       {"error", error}};
+
+    return QJsonDocument(output).toJson(QJsonDocument::Compact);
+}
+
+/* ************************
+ * Local Functions - End
+ *************************/
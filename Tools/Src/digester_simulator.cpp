@@ -0,0 +1,328 @@
+/**
+ * Headless simulator of daily gas production of plants (see yield::simulateDigesters)
+ *
+ * Reads feeding schedule of plants as JSON Lines, one plant per line - schedule
+ * is list of days, each day is feed in format of batch_calculator, and it is
+ * repeated until end of horizon:
+ *   {"plant": 3, "schedule": [[{"substrate": 12, "amount": 10.5, "ts": 20}, ...], [...], ...]}
+ * and writes daily curves of each plant, in order of input:
+ *   {"plant": 3, "methane": [...], "biogas": [...]}
+ * Plant that can't be simulated gives {"plant": ..., "line": ..., "error": "..."}
+ *
+ * Substrate catalog and containers of plants are loaded once from database file,
+ * then all plants are simulated at once on all cores. Time of simulation is
+ * reported to stderr.
+ *
+ * Usage: digester_simulator <path to database file> [input.jsonl|-] [output.jsonl|-] [days]
+ */
+#include "Calculation/Inc/biogas_yield.h"
+#include "Calculation/Inc/digester_model.h"
+#include "Tools/Inc/tool_utils.h"
+
+#include <algorithm>
+#include <vector>
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonParseError>
+#include <QSqlDatabase>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QTextStream>
+#include <QVariant>
+
+namespace {
+
+    struct PlantLine
+    {
+        qint64 line;
+        QJsonValue plant;
+        QString error;          //empty if plant is simulated
+        int index;              //index of plant in simulation
+    };
+
+    typedef QHash<qlonglong, std::vector<double>> PlantContainers;
+
+}
+
+/* ************************
+ * Local Functions Prototypes - Begin
+ *************************/
+
+static bool loadContainers(QSqlDatabase &db, PlantContainers &containers, QString &error);
+
+static bool parsePlant(const QByteArray &input,
+                       const yield::Catalog &catalog,
+                       const PlantContainers &containers,
+                       QJsonValue &plant_id,
+                       yield::PlantFeeding &plant,
+                       QString &error);
+
+static QJsonArray curveArray(const std::vector<double> &curve, int plant, int days);
+
+/* ************************
+ * Local Functions Prototypes - End
+ *************************/
+
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QTextStream err(stderr);
+
+    if(argc < 2)
+    {
+        err << "Usage: digester_simulator <path to database file> [input.jsonl|-] [output.jsonl|-] [days]\n";
+        return 1;
+    }
+
+    yield::Catalog catalog;
+    PlantContainers containers;
+    QString error("");
+
+    {
+        auto db = QSqlDatabase::addDatabase("QSQLITE", "digester_simulator");
+        db.setDatabaseName(QString::fromLocal8Bit(argv[1]));
+        db.setConnectOptions("QSQLITE_OPEN_READONLY");
+
+        if(!db.open())
+        {
+            error = db.lastError().text();
+        }
+        else if(tools::loadCatalog(db, catalog, error))
+        {
+            loadContainers(db, containers, error);
+        }
+
+        db.close();
+    }
+    QSqlDatabase::removeDatabase("digester_simulator");
+
+    if(!error.isEmpty())
+    {
+        err << "Unable to load catalog: " << error << '\n';
+        return 1;
+    }
+
+    QFile input, output;
+
+    if(!tools::openStream(input, argc > 2 ? argv[2] : "-", QIODevice::ReadOnly, stdin)
+            || !tools::openStream(output, argc > 3 ? argv[3] : "-", QIODevice::WriteOnly | QIODevice::Truncate, stdout))
+    {
+        err << "Unable to open input or output\n";
+        return 1;
+    }
+
+    yield::DigesterOptions options(yield::defaultDigesterOptions());
+
+    if(argc > 4)
+    {
+        options.days = std::max(1, QString(argv[4]).toInt());
+    }
+
+    std::vector<PlantLine> lines;
+    std::vector<yield::PlantFeeding> plants;
+    qint64 line(0);
+
+    while(!input.atEnd())
+    {
+        const QByteArray text(input.readLine().trimmed());
+        ++line;
+
+        if(text.isEmpty())
+        {
+            continue;
+        }
+
+        PlantLine plant_line{line, QJsonValue(), QString(), -1};
+        yield::PlantFeeding plant;
+
+        if(parsePlant(text, catalog, containers, plant_line.plant, plant, plant_line.error))
+        {
+            plant_line.index = int(plants.size());
+            plants.push_back(plant);
+        }
+
+        lines.push_back(plant_line);
+    }
+
+    yield::GasCurves curves;
+    QElapsedTimer timer;
+    timer.start();
+
+    if(!yield::simulateDigesters(plants, options, curves, error))
+    {
+        err << "Unable to simulate plants: " << error << '\n';
+        return 1;
+    }
+
+    const qint64 elapsed_ns(timer.nsecsElapsed());
+
+    for(const auto &plant_line: lines)
+    {
+        QJsonObject object;
+
+        if(plant_line.index < 0)
+        {
+            object = QJsonObject{{"plant", plant_line.plant},
+                                 {"line", plant_line.line},
+                                 {"error", plant_line.error}};
+        }
+        else
+        {
+            object = QJsonObject{{"plant", plant_line.plant},
+                                 {"methane", curveArray(curves.methane, plant_line.index, curves.days)},
+                                 {"biogas", curveArray(curves.biogas, plant_line.index, curves.days)}};
+        }
+
+        output.write(QJsonDocument(object).toJson(QJsonDocument::Compact));
+        output.write("\n", 1);
+    }
+
+    output.flush();
+
+    err << "Simulated " << plants.size() << " plants over " << options.days << " days in "
+        << QString::number(elapsed_ns / 1e6, 'f', 1) << " ms\n";
+
+    return 0;
+}
+
+
+/* ************************
+ * Local Functions - Begin
+ *************************/
+
+/**
+ * Loads volume of each container of each plant
+ *
+ * @return false if query failed (error is set)
+ */
+static bool loadContainers(QSqlDatabase &db, PlantContainers &containers, QString &error)
+{
+    QSqlQuery qry(db);
+    qry.setForwardOnly(true);
+
+    if(!qry.exec("SELECT fromPlant_id, volume "
+                 "FROM biogas_server_container "
+                 "ORDER BY fromPlant_id"))
+    {
+        error = qry.lastError().text();
+        return false;
+    }
+
+    while(qry.next())
+    {
+        containers[qry.value(0).toLongLong()].push_back(qry.value(1).toDouble());
+    }
+
+    return true;
+}
+
+/**
+ * Reads containers and feeding schedule of plant from line of input
+ * (feed of each day is reduced to its expected production, see yield::mixYield)
+ *
+ * @param input - line of input
+ * @param plant_id - set to id of plant as given in input
+ * @param plant - set to plant ready for simulation
+ * @return false if line isn't valid (error is set)
+ */
+static bool parsePlant(const QByteArray &input,
+                       const yield::Catalog &catalog,
+                       const PlantContainers &containers,
+                       QJsonValue &plant_id,
+                       yield::PlantFeeding &plant,
+                       QString &error)
+{
+    QJsonParseError parse_error;
+    const QJsonDocument document(QJsonDocument::fromJson(input, &parse_error));
+
+    if(!document.isObject())
+    {
+        error = parse_error.error != QJsonParseError::NoError
+                ? parse_error.errorString()
+                : QObject::tr("Plant has to be JSON object");
+        return false;
+    }
+
+    const QJsonObject object(document.object());
+    const QJsonArray schedule(object.value("schedule").toArray());
+
+    plant_id = object.value("plant");
+    plant.plant_id = qlonglong(plant_id.toDouble());
+    plant.volumes = containers.value(plant.plant_id);
+
+    if(plant.volumes.empty())
+    {
+        error = QObject::tr("Plant %1 has no containers").arg(plant.plant_id);
+        return false;
+    }
+
+    if(schedule.isEmpty())
+    {
+        error = QObject::tr("Feeding schedule has to have at least one day");
+        return false;
+    }
+
+    plant.schedule.reserve(size_t(schedule.size()));
+
+    for(const auto &day: schedule)
+    {
+        const QJsonArray feed_array(day.toArray());
+        std::vector<yield::FeedItem> feed;
+        feed.reserve(size_t(feed_array.size()));
+
+        for(const auto &value: feed_array)
+        {
+            const QJsonObject item(value.toObject());
+            const double amount(item.value("amount").toDouble(-1));
+            const double ts(item.value("ts").toDouble(-1));
+
+            if(amount <= 0 || ts <= 0 || ts > 100)
+            {
+                error = QObject::tr("Amount has to be positive and TS has to be positive percentage");
+                return false;
+            }
+
+            feed.push_back(yield::FeedItem{qlonglong(item.value("substrate").toDouble()), amount, ts});
+        }
+
+        yield::Result result;
+
+        if(!yield::mixYield(catalog, feed, result, error))
+        {
+            return false;
+        }
+
+        plant.schedule.push_back(result);
+    }
+
+    return true;
+}
+
+/**
+ * @param curve - daily values of all plants (see yield::GasCurves)
+ * @param plant - index of plant in simulation
+ * @return daily values of plant
+ */
+static QJsonArray curveArray(const std::vector<double> &curve, int plant, int days)
+{
+    QJsonArray array;
+    const size_t offset(size_t(plant) * size_t(days));
+
+    for(int day = 0; day < days; day++)
+    {
+        array.append(curve[offset + size_t(day)]);
+    }
+
+    return array;
+}
+
+/* ************************
+ * Local Functions - End
+ *************************/
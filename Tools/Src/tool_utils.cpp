@@ -0,0 +1,62 @@
+#include "Tools/Inc/tool_utils.h"
+#include "Database/Inc/db_schema.h"
+
+#include <QSqlError>
+#include <QSqlQuery>
+
+namespace tools{
+
+    /**
+     * Loads whole substrate catalog (see schema::Substrate)
+     *
+     * @param db - open connection
+     * @param catalog - filled with substrates by id
+     * @param error - set if query failed
+     * @return false if query failed (error is set)
+     */
+    bool loadCatalog(QSqlDatabase &db, yield::Catalog &catalog, QString &error)
+    {
+        QSqlQuery qry(db);
+        qry.setForwardOnly(true);
+
+        if(!qry.exec(schema::selectFrom<schema::Substrate>()))
+        {
+            error = qry.lastError().text();
+            return false;
+        }
+
+        while(qry.next())
+        {
+            const schema::Substrate::Row substrate(schema::Substrate::decode(qry));
+
+            catalog.insert(substrate.id, yield::Substrate{substrate.id,
+                                                          substrate.ots,
+                                                          substrate.biogas,
+                                                          substrate.methane});
+        }
+
+        return true;
+    }
+
+    /**
+     * Opens file, or standard stream if path is "-"
+     *
+     * @param file - file to be opened
+     * @param path - path given on command line
+     * @param mode - mode of opening
+     * @param standard - stream used for "-" (stdin or stdout)
+     * @return true if file is open
+     */
+    bool openStream(QFile &file, const char *path, QIODevice::OpenMode mode, FILE *standard)
+    {
+        if(qstrcmp(path, "-") == 0)
+        {
+            return file.open(standard, mode);
+        }
+
+        file.setFileName(QString::fromLocal8Bit(path));
+
+        return file.open(mode);
+    }
+
+}//namespace tools
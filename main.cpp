@@ -1,10 +1,13 @@
 #include "GUI/Inc/menu.h"
 #include "Database/Inc/database.h"
+#include "GUI/Inc/db_messages.h"
+#include "Database/Inc/db_health.h"
 #include "Misc/Inc/layouts.h"
 #include "GUI/Inc/login.h"
 
 #include <QSqlDatabase>
 #include <QApplication>
+#include <cstdlib>
 #include <memory>
 
 
@@ -18,11 +21,32 @@ int main(int argc, char *argv[])
     auto dbp = database::createSQLiteDatabase("H:\\Databases",
                                               "db.sqlite3");
 
+    // Database reports errors through handlers - here they are shown as dialogs
+    db_msg::installDialogs(*dbp);
+
     layout::darkTheme();
 
     Login w(dbp);
 
-    assert(dbp->initDb());
+    if(!dbp->initDb())
+    {
+        db_msg::showDbCriticalError(QObject::tr("Database could not be opened"),
+                                    nullptr,
+                                    dbp->lastError());
+        return EXIT_FAILURE;
+    }
+
+    // Outdated schema means missing indexes - every query would scan whole tables
+    if(!dbp->migrateSchema())
+    {
+        db_msg::showDbCriticalError(QObject::tr("Database schema is outdated and could not be migrated"),
+                                    nullptr,
+                                    dbp->lastError());
+        return EXIT_FAILURE;
+    }
+
+    // Keepalive pings and reconnecting in background - windows don't wait for handshakes
+    dbp->healthMonitor()->start();
 
     w.show();
 